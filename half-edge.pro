@@ -17,28 +17,79 @@ CONFIG += c++17
  # Input
  HEADERS += src/ArcBall.h \
             src/ArcBallWidget.h \
+            src/BinaryMeshFormat.h \
+            src/BoundingVolumeHierarchy.h \
             src/Cartesian3.h \
             src/TriangleMesh.h \
+            src/ConnectedComponents.h \
+            src/DisjointSets.h \
+            src/FrameRecorder.h \
+            src/FrameStatistics.h \
+            src/HeadlessPipeline.h \
+            src/HeatGeodesics.h \
             src/Homogeneous4.h \
+            src/KdTree.h \
+            src/LaplacianSmoothing.h \
+            src/LoopSubdivision.h \
+            src/MappedFile.h \
             src/Matrix4.h \
+            src/MeshCompression.h \
+            src/MeshCurvature.h \
+            src/MeshDecimation.h \
+            src/MeshFile.h \
+            src/Meshlets.h \
+            src/MeshRenderer.h \
+            src/MortonOrder.h \
+            src/Parallel.h \
+            src/PerfCounter.h \
             src/Quaternion.h \
+            src/RenderBenchmark.h \
             src/RenderController.h \
             src/RenderParameters.h \
             src/RenderWidget.h \
             src/RenderWindow.h \
-            src/SphereVertices.h
+            src/SceneRenderer.h \
+            src/SoftwareRasterizer.h \
+            src/SparseCholesky.h \
+            src/SphereVertices.h \
+            src/StreamingSubdivision.h \
+            src/VertexMarkerRenderer.h
 
  SOURCES += src/ArcBall.cpp \
             src/ArcBallWidget.cpp \
+            src/BoundingVolumeHierarchy.cpp \
             src/Cartesian3.cpp \
             src/TriangleMesh.cpp \
+            src/ConnectedComponents.cpp \
+            src/FrameRecorder.cpp \
+            src/FrameStatistics.cpp \
+            src/HeadlessPipeline.cpp \
+            src/HeatGeodesics.cpp \
             src/Homogeneous4.cpp \
+            src/KdTree.cpp \
+            src/LaplacianSmoothing.cpp \
+            src/LoopSubdivision.cpp \
             src/main.cpp \
+            src/MappedFile.cpp \
             src/Matrix4.cpp \
+            src/MeshCompression.cpp \
+            src/MeshCurvature.cpp \
+            src/MeshDecimation.cpp \
+            src/MeshFile.cpp \
+            src/Meshlets.cpp \
+            src/MeshRenderer.cpp \
+            src/MortonOrder.cpp \
+            src/PerfCounter.cpp \
             src/Quaternion.cpp \
+            src/RenderBenchmark.cpp \
             src/RenderController.cpp \
             src/RenderWidget.cpp \
             src/RenderWindow.cpp \
-            src/SphereVertices.cpp
+            src/SceneRenderer.cpp \
+            src/SoftwareRasterizer.cpp \
+            src/SparseCholesky.cpp \
+            src/SphereVertices.cpp \
+            src/StreamingSubdivision.cpp \
+            src/VertexMarkerRenderer.cpp
 
 
@@ -0,0 +1,69 @@
+#ifndef BINARY_MESH_FORMAT_H
+#define BINARY_MESH_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "TriangleMesh.h"
+
+/*
+ * .hebin files store the TriangleMesh arrays verbatim, in native byte order:
+ *
+ *      | header | vertices | normals | faceVertices | otherHalf | firstDirectedEdge |
+ *
+ * so that they can be memory-mapped and addressed in place.
+ */
+
+constexpr char BINARY_MESH_MAGIC[8] = {'H', 'A', 'L', 'F', 'E', 'D', 'G', 'E'};
+constexpr uint32_t BINARY_MESH_VERSION = 1;
+
+struct BinaryMeshHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t halfEdgeCount;
+    uint32_t reserved;
+
+    BinaryMeshHeader()
+        : version(BINARY_MESH_VERSION), vertexCount(0), halfEdgeCount(0), reserved(0) {
+        std::memcpy(magic, BINARY_MESH_MAGIC, sizeof(magic));
+    }
+
+    BinaryMeshHeader(const uint32_t vertexCount, const uint32_t halfEdgeCount)
+        : BinaryMeshHeader() {
+        this->vertexCount = vertexCount;
+        this->halfEdgeCount = halfEdgeCount;
+    }
+
+    bool isValid() const {
+        return std::memcmp(magic, BINARY_MESH_MAGIC, sizeof(magic)) == 0 &&
+               version == BINARY_MESH_VERSION &&
+               halfEdgeCount % 3 == 0 &&
+               // NO_VALUE is no id
+               vertexCount < NO_VALUE && halfEdgeCount < NO_VALUE;
+    }
+};
+
+// byte offsets of each array within a .hebin file
+struct BinaryMeshLayout {
+    uint64_t vertices;
+    uint64_t normals;
+    uint64_t faceVertices;
+    uint64_t otherHalf;
+    uint64_t firstDirectedEdge;
+    uint64_t fileSize;
+
+    explicit BinaryMeshLayout(const BinaryMeshHeader& header)
+        : vertices(sizeof(BinaryMeshHeader)),
+          normals(vertices + uint64_t{header.vertexCount} * sizeof(Cartesian3)),
+          faceVertices(normals + uint64_t{header.vertexCount} * sizeof(Cartesian3)),
+          otherHalf(faceVertices + uint64_t{header.halfEdgeCount} * sizeof(VertexId)),
+          firstDirectedEdge(otherHalf + uint64_t{header.halfEdgeCount} * sizeof(EdgeId)),
+          fileSize(firstDirectedEdge + uint64_t{header.vertexCount} * sizeof(EdgeId)) {
+    }
+};
+
+static_assert(sizeof(BinaryMeshHeader) == 24, "BinaryMeshHeader must be tightly packed");
+static_assert(sizeof(Cartesian3) == 3 * sizeof(float), "Cartesian3 must be stored as 3 floats");
+
+#endif
@@ -0,0 +1,479 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+#include "Parallel.h"
+
+// nodes with this many faces or fewer are always leaves
+constexpr unsigned int LEAF_FACE_COUNT = 4;
+// above this many faces a node is always split, even when the heuristic prefers a leaf
+constexpr unsigned int MAXIMUM_LEAF_FACE_COUNT = 16;
+
+// centroid bins along the split axis, more bins find better splits at a higher build cost
+constexpr unsigned int BIN_COUNT = 16;
+// cost of visiting a node, relative to intersecting a face
+constexpr float TRAVERSAL_COST = 1.0f;
+
+// subtrees with fewer faces are built by the thread that reached them
+constexpr unsigned int PARALLEL_SUBTREE_FACE_COUNT = 1u << 14;
+
+// box grown face by face, on plain arrays as the build indexes axes in its inner loops
+struct Bounds {
+    std::array<float, 3> lower;
+    std::array<float, 3> upper;
+
+    Bounds() {
+        lower.fill(std::numeric_limits<float>::max());
+        upper.fill(std::numeric_limits<float>::lowest());
+    }
+
+    void grow(const std::array<float, 3>& point) {
+        for (int axis = 0; axis < 3; axis++) {
+            lower[axis] = std::min(lower[axis], point[axis]);
+            upper[axis] = std::max(upper[axis], point[axis]);
+        }
+    }
+
+    void grow(const Cartesian3& point) {
+        grow(std::array<float, 3>{point.x, point.y, point.z});
+    }
+
+    void grow(const Bounds& other) {
+        for (int axis = 0; axis < 3; axis++) {
+            lower[axis] = std::min(lower[axis], other.lower[axis]);
+            upper[axis] = std::max(upper[axis], other.upper[axis]);
+        }
+    }
+
+    std::array<float, 3> centre() const {
+        return {(lower[0] + upper[0]) * 0.5f, (lower[1] + upper[1]) * 0.5f, (lower[2] + upper[2]) * 0.5f};
+    }
+
+    // half the surface area, proportional to the chance of a random ray hitting the box
+    float halfArea() const {
+        if (lower[0] > upper[0]) {
+            return 0.0f;
+        }
+        const float x = upper[0] - lower[0], y = upper[1] - lower[1], z = upper[2] - lower[2];
+        return x * y + y * z + z * x;
+    }
+};
+
+static Bounds faceBounds(const TriangleMesh& mesh, const FaceIndex face) {
+    Bounds bounds;
+    for (unsigned int slot = 0; slot < 3; slot++) {
+        bounds.grow(mesh.vertices[mesh.faceVertices[3 * face + slot]]);
+    }
+    return bounds;
+}
+
+/**
+ * @brief Distance along origin + t * direction to the box, NaN-free for axis-parallel rays
+ *        as long as the origin is not on a slab plane
+ *
+ * @return the distance at which the ray enters the box, or infinity if it misses it before maximumDistance
+ */
+// Möller & Trumbore's test, on both sides of face, for t in [0, maximumDistance]
+static std::optional<RayHit> intersectFace(const TriangleMesh& mesh, const FaceIndex face, const Cartesian3& origin,
+                                           const Cartesian3& direction, const float maximumDistance) {
+    const Cartesian3& p0 = mesh.vertices[mesh.faceVertices[3 * face]];
+    const Cartesian3 edge1 = mesh.vertices[mesh.faceVertices[3 * face + 1]] - p0;
+    const Cartesian3 edge2 = mesh.vertices[mesh.faceVertices[3 * face + 2]] - p0;
+
+    const Cartesian3 p = direction.cross(edge2);
+    const float determinant = edge1.dot(p);
+    // the ray runs parallel to the face
+    if (determinant == 0.0f) {
+        return std::nullopt;
+    }
+    const float inverseDeterminant = 1.0f / determinant;
+
+    const Cartesian3 t = origin - p0;
+    const float u = t.dot(p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) {
+        return std::nullopt;
+    }
+
+    const Cartesian3 q = t.cross(edge1);
+    const float v = direction.dot(q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) {
+        return std::nullopt;
+    }
+
+    if (const float distance = edge2.dot(q) * inverseDeterminant; distance >= 0.0f && distance <= maximumDistance) {
+        return RayHit{face, distance, {1.0f - u - v, u, v}};
+    }
+    return std::nullopt;
+}
+
+static float entryDistance(const std::array<float, 3>& lower, const std::array<float, 3>& upper,
+                           const std::array<float, 3>& origin, const std::array<float, 3>& inverseDirection,
+                           const float maximumDistance) {
+    float entry = 0.0f;
+    float exit = maximumDistance;
+    for (int axis = 0; axis < 3; axis++) {
+        float near = (lower[axis] - origin[axis]) * inverseDirection[axis];
+        float far = (upper[axis] - origin[axis]) * inverseDirection[axis];
+        if (near > far) {
+            std::swap(near, far);
+        }
+        entry = std::max(entry, near);
+        exit = std::min(exit, far);
+    }
+
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
+
+class BoundingVolumeHierarchy::Builder {
+    BoundingVolumeHierarchy& hierarchy;
+
+    // by face of the mesh
+    std::vector<Bounds> faceBounds;
+    std::vector<std::array<float, 3>> centroids;
+
+    // nodes were allocated up front, so that threads only hand out their indices
+    std::atomic<unsigned int> nextNode;
+
+    // splits at depths below this are built concurrently, enough to keep every thread busy
+    unsigned int parallelDepth;
+
+public:
+    Builder(BoundingVolumeHierarchy& hierarchy, const TriangleMesh& mesh, const unsigned int firstFreeNode)
+        : hierarchy(hierarchy),
+          faceBounds(mesh.faceVertices.size() / 3),
+          centroids(mesh.faceVertices.size() / 3),
+          nextNode(firstFreeNode),
+          parallelDepth(1) {
+        while ((1u << parallelDepth) < 2 * std::max(std::thread::hardware_concurrency(), 1u)) {
+            parallelDepth++;
+        }
+
+        parallelFor(0, faceBounds.size(), [&](const FaceIndex begin, const FaceIndex end) {
+            for (FaceIndex face = begin; face < end; face++) {
+                faceBounds[face] = ::faceBounds(mesh, face);
+                centroids[face] = faceBounds[face].centre();
+            }
+        });
+    }
+
+    unsigned int usedNodeCount() const {
+        return nextNode;
+    }
+
+    /**
+     * @brief Turns node into the root of a subtree over faceOrder[first, first + count), reordering
+     *        that range so that every leaf covers consecutive faces
+     *
+     * Splits along the axis of largest centroid spread, between the bins that minimise
+     * the surface area heuristic, until splitting costs more than intersecting every face
+     */
+    void build(const unsigned int nodeIndex, const unsigned int first, const unsigned int count,
+               const unsigned int depth) {
+        Node& node = hierarchy.nodes[nodeIndex];
+        FaceIndex* faces = hierarchy.faceOrder.data() + first;
+
+        Bounds bounds;
+        Bounds centroidBounds;
+        for (unsigned int i = 0; i < count; i++) {
+            bounds.grow(faceBounds[faces[i]]);
+            centroidBounds.grow(centroids[faces[i]]);
+        }
+        node.lower = bounds.lower;
+        node.upper = bounds.upper;
+        node.first = first;
+        node.count = count;
+
+        if (count <= LEAF_FACE_COUNT) {
+            return;
+        }
+
+        int axis = 0;
+        for (int other = 1; other < 3; other++) {
+            if (centroidBounds.upper[other] - centroidBounds.lower[other] >
+                centroidBounds.upper[axis] - centroidBounds.lower[axis]) {
+                axis = other;
+            }
+        }
+        // faces with the same centroid cannot be told apart, keep them together
+        const float spread = centroidBounds.upper[axis] - centroidBounds.lower[axis];
+        if (spread <= 0.0f) {
+            return;
+        }
+
+        const float binScale = BIN_COUNT / spread;
+        const float binOrigin = centroidBounds.lower[axis];
+        const auto binOf = [&](const FaceIndex face) {
+            return std::min(BIN_COUNT - 1, static_cast<unsigned int>((centroids[face][axis] - binOrigin) * binScale));
+        };
+
+        std::array<Bounds, BIN_COUNT> binBounds;
+        std::array<unsigned int, BIN_COUNT> binCounts{};
+        for (unsigned int i = 0; i < count; i++) {
+            const unsigned int bin = binOf(faces[i]);
+            binBounds[bin].grow(faceBounds[faces[i]]);
+            binCounts[bin]++;
+        }
+
+        // costs of the faces left of each split, split s separating bins [0, s) & [s, BIN_COUNT)
+        std::array<float, BIN_COUNT> leftCosts{};
+        Bounds leftBounds;
+        unsigned int leftCount = 0;
+        for (unsigned int split = 1; split < BIN_COUNT; split++) {
+            leftBounds.grow(binBounds[split - 1]);
+            leftCount += binCounts[split - 1];
+            leftCosts[split] = leftCount * leftBounds.halfArea();
+        }
+
+        unsigned int bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        Bounds rightBounds;
+        unsigned int rightCount = 0;
+        for (unsigned int split = BIN_COUNT - 1; split > 0; split--) {
+            rightBounds.grow(binBounds[split]);
+            rightCount += binCounts[split];
+            if (const float cost = leftCosts[split] + rightCount * rightBounds.halfArea();
+                rightCount < count && rightCount > 0 && cost < bestCost) {
+                bestCost = cost;
+                bestSplit = split;
+            }
+        }
+
+        const float area = bounds.halfArea();
+        if (bestSplit == 0 ||
+            (count <= MAXIMUM_LEAF_FACE_COUNT && TRAVERSAL_COST * area + bestCost >= count * area)) {
+            return;
+        }
+
+        const unsigned int leftFaceCount = std::partition(faces, faces + count, [&](const FaceIndex face) {
+            return binOf(face) < bestSplit;
+        }) - faces;
+
+        const unsigned int children = nextNode.fetch_add(2);
+        node.first = children;
+        node.count = 0;
+
+        if (count >= PARALLEL_SUBTREE_FACE_COUNT && depth < parallelDepth) {
+            auto left = std::async(std::launch::async, [&]() {
+                build(children, first, leftFaceCount, depth + 1);
+            });
+            build(children + 1, first + leftFaceCount, count - leftFaceCount, depth + 1);
+            left.get();
+        } else {
+            build(children, first, leftFaceCount, depth + 1);
+            build(children + 1, first + leftFaceCount, count - leftFaceCount, depth + 1);
+        }
+    }
+
+    // builds on the calling thread only
+    void buildSerially(const unsigned int nodeIndex, const unsigned int first, const unsigned int count) {
+        build(nodeIndex, first, count, parallelDepth);
+    }
+};
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(const TriangleMesh& mesh)
+    : faceOrder(mesh.faceVertices.size() / 3) {
+    const unsigned int faceCount = faceOrder.size();
+    if (faceCount == 0) {
+        return;
+    }
+
+    std::iota(faceOrder.begin(), faceOrder.end(), 0);
+
+    // a binary tree over faceCount faces has at most 2 * faceCount - 1 nodes
+    nodes.resize(2 * faceCount - 1);
+    Builder builder(*this, mesh, 1);
+    builder.build(0, 0, faceCount, 0);
+    nodes.resize(builder.usedNodeCount());
+}
+
+/**
+ * @brief Each parent face turns into its central & 3 adjacent child faces, see LoopSubdivision.h,
+ *        which keep to roughly the same region. Leaves grown by 4x are split anew & every bound
+ *        is refitted, which is linear in the faces instead of a full build
+ */
+BoundingVolumeHierarchy BoundingVolumeHierarchy::subdivided(const TriangleMesh& child) const {
+    const unsigned int faceCount = faceOrder.size();
+    if (child.faceVertices.size() != 12 * static_cast<size_t>(faceCount)) {
+        std::cerr << "Not a subdivision of the mesh of this hierarchy, building anew" << std::endl;
+        return BoundingVolumeHierarchy(child);
+    }
+
+    BoundingVolumeHierarchy hierarchy;
+    hierarchy.nodes = nodes;
+    for (Node& node : hierarchy.nodes) {
+        if (node.count > 0) {
+            node.first *= 4;
+            node.count *= 4;
+        }
+    }
+
+    hierarchy.faceOrder.resize(4 * faceCount);
+    parallelFor(0, faceCount, [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int position = begin; position < end; position++) {
+            const FaceIndex face = faceOrder[position];
+            hierarchy.faceOrder[4 * position] = face;
+            for (unsigned int i = 0; i < 3; i++) {
+                hierarchy.faceOrder[4 * position + 1 + i] = faceCount + 3 * face + i;
+            }
+        }
+    });
+
+    hierarchy.splitLeaves(child);
+    hierarchy.refit(child);
+
+    return hierarchy;
+}
+
+void BoundingVolumeHierarchy::splitLeaves(const TriangleMesh& mesh) {
+    std::vector<unsigned int> largeLeaves;
+    size_t largeLeafFaceCount = 0;
+    for (unsigned int nodeIndex = 0; nodeIndex < nodes.size(); nodeIndex++) {
+        if (nodes[nodeIndex].count > LEAF_FACE_COUNT) {
+            largeLeaves.push_back(nodeIndex);
+            largeLeafFaceCount += nodes[nodeIndex].count;
+        }
+    }
+
+    const unsigned int firstFreeNode = nodes.size();
+    nodes.resize(firstFreeNode + 2 * largeLeafFaceCount);
+
+    Builder builder(*this, mesh, firstFreeNode);
+    parallelFor(0, largeLeaves.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int leaf = begin; leaf < end; leaf++) {
+            const Node& node = nodes[largeLeaves[leaf]];
+            builder.buildSerially(largeLeaves[leaf], node.first, node.count);
+        }
+    }, 1u << 10);
+    nodes.resize(builder.usedNodeCount());
+}
+
+/**
+ * @brief Bounds the faces of every leaf in parallel, then every interior node from its children,
+ *        children coming after their parents
+ */
+void BoundingVolumeHierarchy::refit(const TriangleMesh& mesh) {
+    parallelFor(0, nodes.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int nodeIndex = begin; nodeIndex < end; nodeIndex++) {
+            Node& node = nodes[nodeIndex];
+            if (node.count == 0) {
+                continue;
+            }
+
+            Bounds bounds;
+            for (unsigned int i = node.first; i < node.first + node.count; i++) {
+                bounds.grow(faceBounds(mesh, faceOrder[i]));
+            }
+            node.lower = bounds.lower;
+            node.upper = bounds.upper;
+        }
+    });
+
+    for (unsigned int nodeIndex = nodes.size(); nodeIndex-- > 0;) {
+        Node& node = nodes[nodeIndex];
+        if (node.count > 0) {
+            continue;
+        }
+
+        Bounds bounds;
+        for (const Node& childNode : {nodes[node.first], nodes[node.first + 1]}) {
+            bounds.grow(childNode.lower);
+            bounds.grow(childNode.upper);
+        }
+        node.lower = bounds.lower;
+        node.upper = bounds.upper;
+    }
+}
+
+/**
+ * @brief Visits the nodes nearest first, skipping those entered beyond the closest hit so far.
+ *        Faces are intersected on both sides, with Möller & Trumbore's test
+ */
+std::optional<RayHit> BoundingVolumeHierarchy::intersect(const TriangleMesh& mesh,
+                                                         const Cartesian3& origin,
+                                                         const Cartesian3& direction,
+                                                         const float maximumDistance) const {
+    if (nodes.empty()) {
+        return std::nullopt;
+    }
+
+    const std::array<float, 3> rayOrigin = {origin.x, origin.y, origin.z};
+    const std::array<float, 3> inverseDirection = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+
+    std::optional<RayHit> closest;
+    float closestDistance = maximumDistance;
+
+    // <node, distance at which the ray enters it>
+    std::vector<std::pair<unsigned int, float>> stack;
+    stack.reserve(64);
+    const float rootEntry = entryDistance(nodes[0].lower, nodes[0].upper, rayOrigin, inverseDirection,
+                                          closestDistance);
+    if (rootEntry <= closestDistance) {
+        stack.emplace_back(0, rootEntry);
+    }
+
+    while (!stack.empty()) {
+        const auto [nodeIndex, entry] = stack.back();
+        stack.pop_back();
+        if (entry > closestDistance) {
+            continue;
+        }
+
+        const Node& node = nodes[nodeIndex];
+        if (node.count == 0) {
+            const Node& left = nodes[node.first];
+            const Node& right = nodes[node.first + 1];
+            const float leftEntry =
+                entryDistance(left.lower, left.upper, rayOrigin, inverseDirection, closestDistance);
+            const float rightEntry =
+                entryDistance(right.lower, right.upper, rayOrigin, inverseDirection, closestDistance);
+
+            // the nearer child is popped first
+            const bool leftFirst = leftEntry <= rightEntry;
+            for (const auto& [childIndex, childEntry] : {
+                     leftFirst ? std::make_pair(node.first + 1, rightEntry) : std::make_pair(node.first, leftEntry),
+                     leftFirst ? std::make_pair(node.first, leftEntry) : std::make_pair(node.first + 1, rightEntry)
+                 }) {
+                if (childEntry <= closestDistance) {
+                    stack.emplace_back(childIndex, childEntry);
+                }
+            }
+            continue;
+        }
+
+        for (unsigned int i = node.first; i < node.first + node.count; i++) {
+            if (const auto hit = intersectFace(mesh, faceOrder[i], origin, direction, closestDistance);
+                hit.has_value()) {
+                closestDistance = hit->distance;
+                closest = hit;
+            }
+        }
+    }
+
+    return closest;
+}
+
+std::optional<RayHit> BoundingVolumeHierarchy::intersectByScan(const TriangleMesh& mesh,
+                                                               const Cartesian3& origin,
+                                                               const Cartesian3& direction,
+                                                               const float maximumDistance) {
+    std::optional<RayHit> closest;
+    float closestDistance = maximumDistance;
+    for (FaceIndex face = 0; face < mesh.faceVertices.size() / 3; face++) {
+        if (const auto hit = intersectFace(mesh, face, origin, direction, closestDistance); hit.has_value()) {
+            closestDistance = hit->distance;
+            closest = hit;
+        }
+    }
+    return closest;
+}
+
+unsigned int BoundingVolumeHierarchy::nodeCount() const {
+    return nodes.size();
+}
@@ -0,0 +1,75 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "TriangleMesh.h"
+
+// closest face along a ray
+struct RayHit {
+    FaceIndex face;
+    // along the ray direction, in its lengths
+    float distance;
+    // barycentric weights of the 3 corners of face at the hit
+    float weights[3];
+};
+
+/**
+ * Axis-aligned bounding box tree over the faces of a TriangleMesh, for ray queries.
+ *
+ * Built top-down with the surface area heuristic over binned centroids, subtrees being built
+ * concurrently. Nodes are stored parents before children, so that a single backwards pass
+ * refits the bounds after the vertices moved. The tree of a Loop subdivision is derived from
+ * the tree of its parent, each parent face standing for its 4 child faces.
+ *
+ * The tree does not keep the mesh, which every call takes instead.
+ */
+class BoundingVolumeHierarchy {
+    struct Node {
+        std::array<float, 3> lower;
+        std::array<float, 3> upper;
+        // leaves: the faces [first, first + count) of faceOrder. Interior nodes: count is 0,
+        // the children being nodes first & first + 1
+        unsigned int first;
+        unsigned int count;
+    };
+
+    // scratch of a top-down build, shared by the threads building its subtrees
+    class Builder;
+
+    std::vector<Node> nodes;
+    std::vector<FaceIndex> faceOrder;
+
+public:
+    BoundingVolumeHierarchy() = default;
+
+    explicit BoundingVolumeHierarchy(const TriangleMesh& mesh);
+
+    // the tree of child, a subdivision of the mesh of this tree by TriangleMesh::subdivide()
+    BoundingVolumeHierarchy subdivided(const TriangleMesh& child) const;
+
+    // recomputes every bound from the vertices of mesh, keeping the tree
+    void refit(const TriangleMesh& mesh);
+
+    // closest hit along origin + t * direction for t in [0, maximumDistance]
+    std::optional<RayHit> intersect(const TriangleMesh& mesh,
+                                    const Cartesian3& origin,
+                                    const Cartesian3& direction,
+                                    float maximumDistance) const;
+
+    // the same query by intersecting every face, which intersect must agree with, to the bit in distance
+    static std::optional<RayHit> intersectByScan(const TriangleMesh& mesh,
+                                                 const Cartesian3& origin,
+                                                 const Cartesian3& direction,
+                                                 float maximumDistance);
+
+    unsigned int nodeCount() const;
+
+private:
+    // splits the leaves holding more faces than a freshly built tree would, e.g. after subdivided
+    void splitLeaves(const TriangleMesh& mesh);
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "ConnectedComponents.h"
+
+#include <algorithm>
+
+#include "DisjointSets.h"
+#include "Parallel.h"
+
+// components are extracted one per thread at a time, even a single one being worth its own thread
+constexpr unsigned int COMPONENTS_PER_THREAD = 1;
+
+/**
+ * @brief Labels the faces, then tallies every vertex, half-edge & face into its component in single passes.
+ *        Boundary loops are walked once each, from the first of their half-edges
+ */
+ConnectedComponents::ConnectedComponents(const TriangleMesh& mesh)
+    : faceComponents(mesh.faceVertices.size() / 3) {
+    const FaceIndex faceCount = faceComponents.size();
+
+    DisjointSets faceSets(faceCount);
+    for (EdgeId edgeId = 0; edgeId < mesh.otherHalf.size(); edgeId++) {
+        if (const EdgeId otherEdge = mesh.otherHalf[edgeId]; edgeId < otherEdge && otherEdge != NO_VALUE) {
+            faceSets.unite(edgeId / 3, otherEdge / 3);
+        }
+    }
+
+    // the root of each set is labelled when its lowest face is reached
+    std::vector<unsigned int> rootComponents(faceCount, NO_VALUE);
+    for (FaceIndex face = 0; face < faceCount; face++) {
+        unsigned int& component = rootComponents[faceSets.find(face)];
+        if (component == NO_VALUE) {
+            component = components.size();
+            components.push_back({0, 0, 0, 0, 0, 0, mesh.vertices[mesh.faceVertices[3 * face]],
+                                  mesh.vertices[mesh.faceVertices[3 * face]]});
+        }
+        faceComponents[face] = component;
+        components[component].faceCount++;
+    }
+
+    for (VertexId vertexId = 0; vertexId < mesh.vertices.size(); vertexId++) {
+        if (mesh.firstDirectedEdge[vertexId] == NO_VALUE) {
+            continue;
+        }
+
+        MeshComponent& component = components[faceComponents[mesh.firstDirectedEdge[vertexId] / 3]];
+        const Cartesian3& vertex = mesh.vertices[vertexId];
+        component.vertexCount++;
+        component.min = Cartesian3(std::min(component.min.x, vertex.x),
+                                   std::min(component.min.y, vertex.y),
+                                   std::min(component.min.z, vertex.z));
+        component.max = Cartesian3(std::max(component.max.x, vertex.x),
+                                   std::max(component.max.y, vertex.y),
+                                   std::max(component.max.z, vertex.z));
+    }
+
+    std::vector<bool> isWalked(mesh.otherHalf.size(), false);
+    for (EdgeId edgeId = 0; edgeId < mesh.otherHalf.size(); edgeId++) {
+        MeshComponent& component = components[faceComponents[edgeId / 3]];
+        if (edgeId < mesh.otherHalf[edgeId]) {
+            component.edgeCount++;
+        }
+        if (mesh.otherHalf[edgeId] != NO_VALUE || isWalked[edgeId]) {
+            continue;
+        }
+
+        component.boundaryCount++;
+        // the boundary goes on from the head of each half-edge, past the faces around it
+        for (EdgeId boundaryEdge = edgeId; !isWalked[boundaryEdge];) {
+            isWalked[boundaryEdge] = true;
+            boundaryEdge = TriangleMesh::nextIdInFace(boundaryEdge);
+            while (mesh.otherHalf[boundaryEdge] != NO_VALUE) {
+                boundaryEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[boundaryEdge]);
+            }
+        }
+    }
+
+    for (MeshComponent& component : components) {
+        component.eulerCharacteristic = static_cast<int>(component.vertexCount) -
+                                        static_cast<int>(component.edgeCount) +
+                                        static_cast<int>(component.faceCount);
+        component.genus = (2 - component.eulerCharacteristic - static_cast<int>(component.boundaryCount)) / 2;
+    }
+}
+
+/**
+ * @brief Groups the faces by component with a counting sort, then each thread extracts whole components,
+ *        renumbering vertices through a table of its own that it only resets where it wrote.
+ *        Normals are copied, as the 1-rings they were gathered from lie within the component
+ */
+std::vector<TriangleMesh> ConnectedComponents::extract(const TriangleMesh& mesh) const {
+    std::vector<unsigned int> firstFaces(components.size() + 1, 0);
+    for (const unsigned int component : faceComponents) {
+        firstFaces[component + 1]++;
+    }
+    std::partial_sum(firstFaces.begin(), firstFaces.end(), firstFaces.begin());
+
+    // faces by component, & the index of every face within its component
+    std::vector<FaceIndex> componentFaces(faceComponents.size());
+    std::vector<FaceIndex> localFaces(faceComponents.size());
+    std::vector<unsigned int> nextFaces(firstFaces.begin(), firstFaces.end() - 1);
+    for (FaceIndex face = 0; face < faceComponents.size(); face++) {
+        const unsigned int slot = nextFaces[faceComponents[face]]++;
+        componentFaces[slot] = face;
+        localFaces[face] = slot - firstFaces[faceComponents[face]];
+    }
+
+    const auto localEdgeId = [&localFaces](const EdgeId edgeId) -> EdgeId {
+        return edgeId == NO_VALUE ? NO_VALUE : 3 * localFaces[edgeId / 3] + edgeId % 3;
+    };
+
+    std::vector<TriangleMesh> extracted(components.size());
+    parallelFor(0, components.size(), [&](const unsigned int begin, const unsigned int end) {
+        std::vector<VertexId> localVertices(mesh.vertices.size(), NO_VALUE);
+
+        for (unsigned int component = begin; component < end; component++) {
+            TriangleMesh& part = extracted[component];
+            const FaceIndex* faces = componentFaces.data() + firstFaces[component];
+            const unsigned int faceCount = firstFaces[component + 1] - firstFaces[component];
+
+            // corners in face order, then vertices renumbered in their original order
+            std::vector<VertexId> partVertices;
+            for (unsigned int i = 0; i < faceCount; i++) {
+                for (unsigned int slot = 0; slot < 3; slot++) {
+                    if (VertexId& local = localVertices[mesh.faceVertices[3 * faces[i] + slot]]; local == NO_VALUE) {
+                        local = 0;
+                        partVertices.push_back(mesh.faceVertices[3 * faces[i] + slot]);
+                    }
+                }
+            }
+            std::sort(partVertices.begin(), partVertices.end());
+            for (VertexId local = 0; local < partVertices.size(); local++) {
+                localVertices[partVertices[local]] = local;
+            }
+
+            part.vertices.reserve(partVertices.size());
+            for (const VertexId vertexId : partVertices) {
+                part.vertices.push_back(mesh.vertices[vertexId]);
+                if (vertexId < mesh.normals.size()) {
+                    part.normals.push_back(mesh.normals[vertexId]);
+                }
+            }
+
+            part.faceVertices.resize(3 * faceCount);
+            part.otherHalf.resize(3 * faceCount);
+            part.firstDirectedEdge.assign(partVertices.size(), NO_VALUE);
+            for (unsigned int i = 0; i < faceCount; i++) {
+                for (unsigned int slot = 0; slot < 3; slot++) {
+                    const EdgeId edgeId = 3 * faces[i] + slot;
+                    part.faceVertices[3 * i + slot] = localVertices[mesh.faceVertices[edgeId]];
+                    part.otherHalf[3 * i + slot] = localEdgeId(mesh.otherHalf[edgeId]);
+                }
+                if (faces[i] < mesh.faceNormals.size()) {
+                    part.faceNormals.push_back(mesh.faceNormals[faces[i]]);
+                }
+            }
+
+            // the first directed edge of the original vertex, unless it lies in another component it pinches
+            for (VertexId local = 0; local < partVertices.size(); local++) {
+                const EdgeId firstEdge = mesh.firstDirectedEdge[partVertices[local]];
+                if (firstEdge != NO_VALUE && faceComponents[firstEdge / 3] == component) {
+                    part.firstDirectedEdge[local] = localEdgeId(firstEdge);
+                }
+            }
+            for (EdgeId edgeId = 0; edgeId < part.faceVertices.size(); edgeId++) {
+                // edgeId leaves the vertex at the end of the half-edge before it
+                if (EdgeId& tailFirstEdge = part.firstDirectedEdge[part.faceVertices[TriangleMesh::idToIndex(edgeId)]];
+                    tailFirstEdge == NO_VALUE) {
+                    tailFirstEdge = edgeId;
+                }
+            }
+
+            for (const VertexId vertexId : partVertices) {
+                localVertices[vertexId] = NO_VALUE;
+            }
+
+            part.computeCentreOfGravity();
+            part.computeFulledges();
+        }
+    }, COMPONENTS_PER_THREAD);
+
+    return extracted;
+}
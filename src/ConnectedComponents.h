@@ -0,0 +1,46 @@
+#ifndef CONNECTED_COMPONENTS_H
+#define CONNECTED_COMPONENTS_H
+
+#include <vector>
+
+#include "TriangleMesh.h"
+
+// faces of a TriangleMesh reachable from each other across otherHalf, with their topology & extent
+struct MeshComponent {
+    unsigned int vertexCount;
+    // fulledges & unpaired half-edges, each counted once
+    unsigned int edgeCount;
+    unsigned int faceCount;
+    // loops of unpaired half-edges, 0 for a closed surface
+    unsigned int boundaryCount;
+    // V - E + F
+    int eulerCharacteristic;
+    // handles of the surface, half-edge meshes being orientable: eulerCharacteristic = 2 - 2 genus - boundaryCount
+    int genus;
+    Cartesian3 min;
+    Cartesian3 max;
+};
+
+/**
+ * Connected components of a TriangleMesh, labelled by union-find over the faces joined by otherHalf,
+ * in time linear in the half-edges.
+ *
+ * Vertices count towards the component of their first directed edge, so a vertex pinching components
+ * together, which TriangleMesh::validate reports, counts once. Like BoundingVolumeHierarchy, the
+ * analysis does not keep the mesh, which extract takes instead.
+ */
+class ConnectedComponents {
+public:
+    // numbered in order of their lowest face
+    std::vector<MeshComponent> components;
+    // component of every face
+    std::vector<unsigned int> faceComponents;
+
+    explicit ConnectedComponents(const TriangleMesh& mesh);
+
+    // every component as a mesh of its own, extracted concurrently. Vertices & faces keep their relative order,
+    // pinching vertices are copied into each component they pinch
+    std::vector<TriangleMesh> extract(const TriangleMesh& mesh) const;
+};
+
+#endif
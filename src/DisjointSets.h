@@ -0,0 +1,44 @@
+#ifndef DISJOINT_SETS_H
+#define DISJOINT_SETS_H
+
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Union-find over [0, size), by size & with path halving, so that any sequence of unions & finds
+// takes near constant time per operation
+class DisjointSets {
+    std::vector<unsigned int> parents;
+    std::vector<unsigned int> sizes;
+
+public:
+    explicit DisjointSets(const unsigned int size)
+        : parents(size),
+          sizes(size, 1) {
+        std::iota(parents.begin(), parents.end(), 0);
+    }
+
+    unsigned int find(unsigned int element) {
+        while (parents[element] != element) {
+            parents[element] = parents[parents[element]];
+            element = parents[element];
+        }
+        return element;
+    }
+
+    void unite(const unsigned int a, const unsigned int b) {
+        unsigned int rootA = find(a);
+        unsigned int rootB = find(b);
+        if (rootA == rootB) {
+            return;
+        }
+
+        if (sizes[rootA] < sizes[rootB]) {
+            std::swap(rootA, rootB);
+        }
+        parents[rootB] = rootA;
+        sizes[rootA] += sizes[rootB];
+    }
+};
+
+#endif
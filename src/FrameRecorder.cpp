@@ -0,0 +1,79 @@
+#include "FrameRecorder.h"
+
+#include <iomanip>
+#include <iostream>
+
+// steps of the scripted rotation, one full turn
+constexpr unsigned int RECORDED_FRAME_COUNT = 360;
+
+FrameRecorder::FrameRecorder(
+    RenderParameters* renderParameters,
+    RenderWindow* renderWindow,
+    const std::string& csvPath
+) : QObject(nullptr),
+    renderParameters(renderParameters),
+    renderWindow(renderWindow),
+    csvPath(csvPath),
+    frame(0),
+    frames(RECORDED_FRAME_COUNT) {
+}
+
+bool FrameRecorder::start() {
+    csv.open(csvPath);
+    if (!csv.good()) {
+        std::cerr << "Failed to output: " << csvPath << std::endl;
+        return false;
+    }
+
+    csv << "frame,level,render_path,triangles,vertices,frame_ms,submission_ms,culled_percent\n";
+
+    // every row times the frame it describes, until the GPU finished it
+    renderWindow->renderWidget->setSynchronised(true);
+    renderParameters->rotationMatrix = SceneRenderer::sweepRotation(0, RECORDED_FRAME_COUNT);
+    connect(renderWindow->renderWidget, &RenderWidget::frameRendered, this, &FrameRecorder::recordFrame);
+
+    std::cout << "Recording " << RECORDED_FRAME_COUNT << " frames to " << csvPath << "..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Writes the row of the frame just drawn, then steps the rotation & requests the next frame
+ */
+void FrameRecorder::recordFrame() {
+    const RenderWidget* renderWidget = renderWindow->renderWidget;
+    const TriangleMesh& mesh = *renderWidget->triangleMesh;
+
+    csv << frame << ','
+        << renderParameters->subdivisionNumber << ','
+        << (renderWidget->isRetained() ? "retained" : "immediate") << ','
+        << mesh.faceVertices.size() / 3 << ','
+        << mesh.vertices.size() << ','
+        << std::fixed << std::setprecision(3)
+        << renderWidget->lastFrameMilliseconds() << ','
+        << renderWidget->lastSubmissionMilliseconds() << ','
+        << 100.0f * renderWidget->culledFraction() << '\n'
+        << std::defaultfloat;
+    frames.record(renderWidget->lastFrameMilliseconds());
+
+    if (++frame == RECORDED_FRAME_COUNT) {
+        finish();
+        return;
+    }
+
+    renderParameters->rotationMatrix = SceneRenderer::sweepRotation(frame, RECORDED_FRAME_COUNT);
+    renderWindow->renderWidget->update();
+}
+
+void FrameRecorder::finish() {
+    disconnect(renderWindow->renderWidget, &RenderWidget::frameRendered, this, &FrameRecorder::recordFrame);
+    renderWindow->renderWidget->setSynchronised(false);
+    csv.close();
+
+    std::cout << std::fixed << std::setprecision(2)
+            << "Recorded to " << csvPath << ": p50 " << frames.percentile(50.0)
+            << " ms, p95 " << frames.percentile(95.0)
+            << " ms, p99 " << frames.percentile(99.0) << " ms" << std::endl
+            << std::defaultfloat;
+
+    QCoreApplication::quit();
+}
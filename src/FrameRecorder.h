@@ -0,0 +1,39 @@
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include <fstream>
+#include <string>
+
+#include "FrameStatistics.h"
+#include "RenderParameters.h"
+#include "RenderWindow.h"
+
+/**
+ * Turns the model through a scripted rotation, one step per frame, and records
+ * the timings of every frame to a CSV file. The application quits once done.
+ *
+ * The sequence is the same from run to run, so that render paths & levels
+ * can be compared on a given asset. The first frame includes the buffer uploads.
+ */
+class FrameRecorder : public QObject {
+    RenderParameters* renderParameters;
+    RenderWindow* renderWindow;
+
+    std::string csvPath;
+    std::ofstream csv;
+    unsigned int frame;
+    FrameStatistics frames;
+
+public:
+    FrameRecorder(RenderParameters* renderParameters, RenderWindow* renderWindow, const std::string& csvPath);
+
+    // opens the CSV file & starts listening to frames, false if the file cannot be written
+    bool start();
+
+private:
+    void recordFrame();
+
+    void finish();
+};
+
+#endif
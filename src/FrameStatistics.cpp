@@ -0,0 +1,40 @@
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameStatistics::FrameStatistics(const unsigned int capacity)
+    : capacity(capacity),
+      next(0) {
+    milliseconds.reserve(capacity);
+}
+
+void FrameStatistics::record(const double frameMilliseconds) {
+    if (milliseconds.size() < capacity) {
+        milliseconds.push_back(frameMilliseconds);
+        return;
+    }
+
+    milliseconds[next] = frameMilliseconds;
+    next = (next + 1) % capacity;
+}
+
+bool FrameStatistics::empty() const {
+    return milliseconds.empty();
+}
+
+/**
+ * @brief Smallest duration that percent of the frames kept do not exceed
+ */
+double FrameStatistics::percentile(const double percent) const {
+    if (milliseconds.empty()) {
+        return 0.0;
+    }
+
+    const auto rank = static_cast<unsigned int>(std::ceil(percent / 100.0 * milliseconds.size()));
+    std::vector<double> sorted = milliseconds;
+    const auto nth = sorted.begin() + std::clamp(rank, 1u, static_cast<unsigned int>(sorted.size())) - 1;
+    std::nth_element(sorted.begin(), nth, sorted.end());
+
+    return *nth;
+}
@@ -0,0 +1,27 @@
+#ifndef FRAME_STATISTICS_H
+#define FRAME_STATISTICS_H
+
+#include <vector>
+
+/**
+ * Durations of the most recent frames, kept in a ring of fixed capacity
+ * so that percentiles follow what is currently being drawn.
+ */
+class FrameStatistics {
+    std::vector<double> milliseconds;
+    unsigned int capacity;
+    // slot overwritten by the next frame once the ring is full
+    unsigned int next;
+
+public:
+    explicit FrameStatistics(unsigned int capacity);
+
+    void record(double frameMilliseconds);
+
+    bool empty() const;
+
+    // nearest-rank percentile of the frames kept, percent in [0, 100], 0 when empty
+    double percentile(double percent) const;
+};
+
+#endif
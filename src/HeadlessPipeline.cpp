@@ -0,0 +1,995 @@
+#include "HeadlessPipeline.h"
+
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <random>
+
+#include "BoundingVolumeHierarchy.h"
+#include "ConnectedComponents.h"
+#include "FrameStatistics.h"
+#include "KdTree.h"
+#include "LaplacianSmoothing.h"
+#include "LoopSubdivision.h"
+#include "MeshCurvature.h"
+#include "MeshDecimation.h"
+#include "MeshFile.h"
+#include "MortonOrder.h"
+#include "Parallel.h"
+#include "PerfCounter.h"
+#include "RenderBenchmark.h"
+#include "SoftwareRasterizer.h"
+#include "StreamingSubdivision.h"
+
+// queries scanning every vertex in --benchmark-nearest, or rays every face in --benchmark-pick, which would take minutes for all of them on large levels
+constexpr unsigned int SCANNED_QUERY_COUNT = 1u << 8;
+// of --benchmark-nearest, relative to the object size: queries lie this far from a vertex at most,
+// & radius queries gather the vertices this far from them
+constexpr float QUERY_JITTER = 0.01f;
+constexpr float QUERY_RADIUS = 0.02f;
+// of --benchmark-geodesics: vertices this far out relative to the farthest one make up the far field, whose median
+// ratio of heat method to shortest edge path distances must lie in the range, as edge paths zigzag a little
+// longer than geodesics
+constexpr double FAR_FIELD = 0.5;
+constexpr double MINIMUM_FAR_FIELD_RATIO = 0.9;
+constexpr double MAXIMUM_FAR_FIELD_RATIO = 1.05;
+
+static float squaredDistance(const Cartesian3& a, const Cartesian3& b) {
+    const float x = a.x - b.x, y = a.y - b.y, z = a.z - b.z;
+    return x * x + y * y + z * z;
+}
+
+// the vector scan that KdTree::nearest replaces
+static VertexId nearestByScan(const std::vector<Cartesian3>& vertices, const Cartesian3& query) {
+    VertexId closest = NO_VALUE;
+    float closestDistance = std::numeric_limits<float>::infinity();
+    for (VertexId vertex = 0; vertex < vertices.size(); vertex++) {
+        if (const float distance = squaredDistance(vertices[vertex], query); distance < closestDistance) {
+            closestDistance = distance;
+            closest = vertex;
+        }
+    }
+    return closest;
+}
+
+// the vector scan that KdTree::withinRadius replaces
+static std::vector<VertexId> withinRadiusByScan(const std::vector<Cartesian3>& vertices,
+                                                const Cartesian3& query,
+                                                const float radius) {
+    std::vector<VertexId> found;
+    for (VertexId vertex = 0; vertex < vertices.size(); vertex++) {
+        if (squaredDistance(vertices[vertex], query) <= radius * radius) {
+            found.push_back(vertex);
+        }
+    }
+    return found;
+}
+
+// the shortest paths along edges, by Dijkstra's algorithm, that --benchmark-geodesics checks the heat method against
+static std::vector<double> edgePathDistances(const TriangleMesh& mesh, const VertexId source) {
+    std::vector<double> distances(mesh.vertices.size(), std::numeric_limits<double>::infinity());
+    typedef std::pair<double, VertexId> Reached;
+    std::priority_queue<Reached, std::vector<Reached>, std::greater<Reached>> queue;
+    distances[source] = 0.0;
+    queue.push({0.0, source});
+
+    while (!queue.empty()) {
+        const auto [distance, vertexId] = queue.top();
+        queue.pop();
+        const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+        if (distance > distances[vertexId] || firstEdge == NO_VALUE) {
+            continue;
+        }
+
+        EdgeId currentEdge = firstEdge;
+        do {
+            const VertexId neighbour = mesh.faceVertices[currentEdge];
+            if (const double throughVertex = distance + (mesh.vertices[neighbour] - mesh.vertices[vertexId]).length();
+                throughVertex < distances[neighbour]) {
+                distances[neighbour] = throughVertex;
+                queue.push({throughVertex, neighbour});
+            }
+            currentEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[currentEdge]);
+        } while (currentEdge != firstEdge);
+    }
+
+    return distances;
+}
+
+HeadlessPipeline::HeadlessPipeline(const std::string& meshPath)
+    : meshPath(meshPath),
+      reorderLevels(false) {
+}
+
+/**
+ * @brief Applies each operation in arguments, stopping at the first failure
+ *
+ * @param arguments the operations and their parameters, e.g. {"--subdivide", "2", "--write", "out.obj"}
+ *
+ * @return EXIT_SUCCESS if every operation succeeded, EXIT_FAILURE otherwise
+ */
+int HeadlessPipeline::run(const std::vector<std::string>& arguments) {
+    for (unsigned int i = 0; i < arguments.size(); i++) {
+        const std::string& operation = arguments[i];
+
+        // any other operation may change the mesh
+        if (operation != "--geodesics") {
+            geodesics.reset();
+        }
+
+        // consumes the next argument as a parameter of operation
+        const auto parameter = [&]() -> std::optional<std::string> {
+            if (i + 1 >= arguments.size()) {
+                return std::nullopt;
+            }
+            return arguments[++i];
+        };
+        const auto unsignedParameter = [&]() -> std::optional<unsigned int> {
+            const auto value = parameter();
+            if (!value.has_value() || value->empty() || value->find_first_not_of("0123456789") != std::string::npos) {
+                return std::nullopt;
+            }
+            // parsed wider than unsigned int, so that larger values are refused rather than wrapped
+            errno = 0;
+            const unsigned long long number = std::strtoull(value->c_str(), nullptr, 10);
+            if (errno == ERANGE || number > UINT_MAX) {
+                return std::nullopt;
+            }
+            return static_cast<unsigned int>(number);
+        };
+        const auto floatParameter = [&]() -> std::optional<float> {
+            const auto value = parameter();
+            if (!value.has_value() || value->empty()) {
+                return std::nullopt;
+            }
+            char* end;
+            const float number = std::strtof(value->c_str(), &end);
+            if (*end != '\0' || !std::isfinite(number) || number < 0.0f) {
+                return std::nullopt;
+            }
+            return number;
+        };
+
+        bool success;
+
+        if (operation == "--subdivide") {
+            const auto levels = unsignedParameter();
+            success = levels.has_value() && subdivide(levels.value());
+        } else if (operation == "--write") {
+            const auto outputPath = parameter();
+            success = outputPath.has_value() && write(outputPath.value());
+        } else if (operation == "--stream-subdivide") {
+            const auto levels = unsignedParameter();
+            const auto outputPath = parameter();
+            success = levels.has_value() && outputPath.has_value() &&
+                      streamSubdivide(levels.value(), outputPath.value());
+        } else if (operation == "--decimate") {
+            const auto faces = unsignedParameter();
+            const auto error = floatParameter();
+            success = faces.has_value() && error.has_value() && decimate(faces.value(), error.value());
+        } else if (operation == "--reorder") {
+            success = reorder();
+        } else if (operation == "--validate") {
+            success = validate();
+        } else if (operation == "--components") {
+            success = reportComponents();
+        } else if (operation == "--write-components") {
+            const auto outputPath = parameter();
+            success = outputPath.has_value() && writeComponents(outputPath.value());
+        } else if (operation == "--normals") {
+            const auto weighting = parameter();
+            success = weighting.has_value() && computeNormals(weighting.value());
+        } else if (operation == "--smooth" || operation == "--taubin") {
+            const auto weighting = parameter();
+            const auto iterations = unsignedParameter();
+            const auto lambda = floatParameter();
+            success = weighting.has_value() && iterations.has_value() && lambda.has_value() &&
+                      smooth(weighting.value(), iterations.value(), lambda.value(), operation == "--taubin");
+        } else if (operation == "--reorder-levels") {
+            reorderLevels = true;
+            success = true;
+        } else if (operation == "--benchmark-locality") {
+            const auto repetitions = unsignedParameter();
+            success = repetitions.has_value() && benchmarkLocality(repetitions.value());
+        } else if (operation == "--benchmark-render") {
+            const auto levels = unsignedParameter();
+            const auto frames = unsignedParameter();
+            success = levels.has_value() && frames.has_value() && benchmarkRender(levels.value(), frames.value());
+        } else if (operation == "--benchmark-pick") {
+            const auto rays = unsignedParameter();
+            success = rays.has_value() && benchmarkPick(rays.value());
+        } else if (operation == "--benchmark-nearest") {
+            const auto levels = unsignedParameter();
+            const auto queries = unsignedParameter();
+            success = levels.has_value() && queries.has_value() && benchmarkNearest(levels.value(), queries.value());
+        } else if (operation == "--benchmark-geodesics") {
+            const auto levels = unsignedParameter();
+            success = levels.has_value() && benchmarkGeodesics(levels.value());
+        } else if (operation == "--geodesics") {
+            const auto source = unsignedParameter();
+            const auto csvPath = parameter();
+            success = source.has_value() && csvPath.has_value() && writeGeodesics(source.value(), csvPath.value());
+        } else if (operation == "--curvature") {
+            const auto csvPath = parameter();
+            success = csvPath.has_value() && writeCurvature(csvPath.value());
+        } else if (operation == "--thumbnail") {
+            const auto width = unsignedParameter();
+            const auto height = unsignedParameter();
+            const auto imagePath = parameter();
+            success = width.has_value() && height.has_value() && imagePath.has_value() &&
+                      thumbnail(width.value(), height.value(), imagePath.value());
+        } else {
+            std::cerr << "Unknown operation: " << operation << std::endl;
+            success = false;
+        }
+
+        if (!success) {
+            std::cerr << "Failed operation: " << operation << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void HeadlessPipeline::printUsage(const std::string& program) {
+    std::cout << "Usage: " << program << " --headless <mesh file> [operations...]\n"
+            << "Operations, applied in order:\n"
+            << "  --subdivide <levels>                   Loop-subdivide the mesh in memory\n"
+            << "  --write <.halfedge/.obj/.hebin/.hec>   Write the current mesh\n"
+            << "  --stream-subdivide <levels> <.hebin>   Subdivide the .hebin mesh file out-of-core\n"
+            << "  --decimate <faces> <error>             Collapse a closed mesh down to faces, or error times its size\n"
+            << "  --reorder                              Reorder vertices & faces along a Morton curve\n"
+            << "  --reorder-levels                       Reorder every level subdivided from now on\n"
+            << "  --validate                             Report every defect of the half-edge arrays\n"
+            << "  --components                           Report V, E, F, Euler characteristic, genus & bounds per component\n"
+            << "  --write-components <.ext>              Write every component to a file of its own, e.g. part_0.obj\n"
+            << "  --normals <area/angle/uniform>         Recompute vertex normals with the given face weighting\n"
+            << "  --smooth <weights> <steps> <lambda>    Laplacian-smooth, weights uniform or cotangent, lambda in (0, 1]\n"
+            << "  --taubin <weights> <steps> <lambda>    Taubin lambda/mu-smooth, which keeps the volume, pass band 0.1\n"
+            << "  --benchmark-locality <repetitions>     Time 1-ring walks & normals, with cache misses\n"
+            << "  --benchmark-render <levels> <frames>   Time offscreen frames of levels [0, levels], per render path\n"
+            << "  --benchmark-pick <rays>                Time & check bounding volume hierarchy builds & ray picks\n"
+            << "  --benchmark-nearest <levels> <queries> Time k-d tree & scanned nearest/radius queries of levels [0, levels]\n"
+            << "  --benchmark-geodesics <levels>         Time & check heat method distances of levels [0, levels] against Dijkstra\n"
+            << "  --geodesics <vertex> <.csv>            Write the distance of every vertex to vertex along the surface\n"
+            << "  --curvature <.csv>                     Write mean, Gaussian & principal curvatures, directions of every vertex\n"
+            << "  --thumbnail <w> <h> <.png/.ppm>        Render the current mesh on the CPU, no GL needed\n"
+            << std::flush;
+}
+
+TriangleMesh* HeadlessPipeline::loadedMesh() {
+    if (!mesh.has_value()) {
+        std::cout << "Reading " << meshPath << "..." << std::endl;
+
+        TriangleMesh readMesh;
+        if (!readMeshFile(meshPath, readMesh)) {
+            std::cerr << "Read failed for object " << meshPath << std::endl;
+            return nullptr;
+        }
+
+        mesh = std::move(readMesh);
+    }
+
+    return &mesh.value();
+}
+
+bool HeadlessPipeline::subdivide(const unsigned int levels) {
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    if (!reorderLevels) {
+        std::cout << "Generating Subdivision " << levels << "..." << std::endl;
+        *current = current->subdivide(levels);
+        std::cout << "Finished generating Subdivision " << levels << std::endl;
+        return true;
+    }
+
+    // Reordering between levels breaks the pipeline, so go one level at a time
+    for (unsigned int level = 1; level <= levels; level++) {
+        std::cout << "Generating Subdivision " << level << "..." << std::endl;
+        *current = current->subdivide();
+        reorderAlongMortonCurve(*current);
+        std::cout << "Finished generating Subdivision " << level << std::endl;
+    }
+
+    return true;
+}
+
+bool HeadlessPipeline::write(const std::string& outputPath) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    if (!writeMeshFile(outputPath, *current)) {
+        std::cerr << "Failed to output: " << outputPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Written to file: " << outputPath << std::endl;
+    return true;
+}
+
+/**
+ * @brief Streams from the mesh file itself, never reading it into memory.
+ *        Convert other formats first, e.g. --headless horse.tri --write horse.hebin
+ */
+bool HeadlessPipeline::streamSubdivide(const unsigned int levels, const std::string& outputPath) const {
+    if (!isBinaryFile(meshPath) || !isBinaryFile(outputPath)) {
+        std::cerr << "--stream-subdivide maps .hebin files only" << std::endl;
+        return false;
+    }
+
+    if (mesh.has_value()) {
+        std::cerr << "--stream-subdivide reads " << meshPath << ", not the in-memory mesh" << std::endl;
+        return false;
+    }
+
+    return StreamingSubdivision().subdivide(meshPath, levels, outputPath);
+}
+
+/**
+ * @param error bound on how far vertices may move from the planes of their original faces,
+ *              relative to the object size, e.g. 0.001
+ */
+bool HeadlessPipeline::decimate(const unsigned int faces, const float error) {
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const unsigned int faceCount = current->faceVertices.size() / 3;
+    const auto begin = std::chrono::steady_clock::now();
+    if (!::decimate(*current, faces, error * current->objectSize)) {
+        return false;
+    }
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "Decimated " << faceCount << " faces to " << current->faceVertices.size() / 3 << " in "
+            << milliseconds << " ms" << std::endl;
+    return true;
+}
+
+bool HeadlessPipeline::reorder() {
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    reorderAlongMortonCurve(*current);
+    std::cout << "Reordered along Morton curve" << std::endl;
+    return true;
+}
+
+/**
+ * @brief .tri & .halfedge files are validated as they are read, this checks any mesh, e.g. after operations
+ *        or read from .hebin & .hec files, which are trusted for speed
+ */
+bool HeadlessPipeline::validate() {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const std::vector<MeshDefect> defects = current->validate();
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!defects.empty()) {
+        TriangleMesh::printDefects(defects, std::cerr);
+        return false;
+    }
+
+    std::cout << "Valid, " << current->vertices.size() << " vertices & " << current->faceVertices.size() / 3
+            << " faces checked in " << milliseconds << " ms" << std::endl;
+    return true;
+}
+
+bool HeadlessPipeline::reportComponents() {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const ConnectedComponents analysis(*current);
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << analysis.components.size() << " components, analysed in " << milliseconds << " ms\n"
+            << "component,vertices,edges,faces,boundaries,euler,genus,min,max\n";
+    for (unsigned int index = 0; index < analysis.components.size(); index++) {
+        const MeshComponent& component = analysis.components[index];
+        std::cout << index << ',' << component.vertexCount << ',' << component.edgeCount << ','
+                << component.faceCount << ',' << component.boundaryCount << ','
+                << component.eulerCharacteristic << ',' << component.genus << ','
+                << component.min.x << ' ' << component.min.y << ' ' << component.min.z << ','
+                << component.max.x << ' ' << component.max.y << ' ' << component.max.z << '\n';
+    }
+    std::cout << std::flush;
+    return true;
+}
+
+/**
+ * @param outputPath the files of components are named after it, their index inserted before the extension,
+ *                   e.g. out/part.hebin gives out/part_0.hebin, out/part_1.hebin...
+ */
+bool HeadlessPipeline::writeComponents(const std::string& outputPath) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const std::vector<TriangleMesh> parts = ConnectedComponents(*current).extract(*current);
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Extracted " << parts.size() << " components in " << milliseconds << " ms" << std::endl;
+
+    const size_t dot = outputPath.find_last_of('.');
+    if (dot == std::string::npos || outputPath.find_first_of("/\\", dot) != std::string::npos) {
+        std::cerr << "--write-components needs an extension to pick the format: " << outputPath << std::endl;
+        return false;
+    }
+
+    for (unsigned int index = 0; index < parts.size(); index++) {
+        const std::string partPath = outputPath.substr(0, dot) + "_" + std::to_string(index) + outputPath.substr(dot);
+        if (!writeMeshFile(partPath, parts[index])) {
+            std::cerr << "Failed to output: " << partPath << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Written " << parts.size() << " components next to: " << outputPath << std::endl;
+    return true;
+}
+
+bool HeadlessPipeline::computeNormals(const std::string& weighting) {
+    static const std::map<std::string, NormalWeighting> weightings = {
+        {"area", NormalWeighting::AREA},
+        {"angle", NormalWeighting::ANGLE},
+        {"uniform", NormalWeighting::UNIFORM}
+    };
+
+    const auto found = weightings.find(weighting);
+    if (found == weightings.end()) {
+        std::cerr << "Unknown normal weighting: " << weighting << std::endl;
+        return false;
+    }
+
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    current->computeNormals(found->second);
+    std::cout << "Computed " << weighting << " weighted normals" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Times building the adjacency apart from the iterations, as the former is paid once per weighting
+ *
+ * @param taubin whether to alternate lambda & mu steps, rather than shrink by lambda steps alone
+ */
+bool HeadlessPipeline::smooth(const std::string& weighting, const unsigned int iterations, const float lambda,
+                              const bool taubin) {
+    static const std::map<std::string, SmoothingWeights> weightings = {
+        {"uniform", SmoothingWeights::UNIFORM},
+        {"cotangent", SmoothingWeights::COTANGENT}
+    };
+
+    const auto found = weightings.find(weighting);
+    if (found == weightings.end()) {
+        std::cerr << "Unknown smoothing weights: " << weighting << std::endl;
+        return false;
+    }
+    if (!(lambda > 0.0f && lambda <= 1.0f)) {
+        std::cerr << "Smoothing needs lambda in (0, 1]: " << lambda << std::endl;
+        return false;
+    }
+
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const LaplacianSmoothing smoothing(*current, found->second);
+    const auto built = std::chrono::steady_clock::now();
+    if (taubin) {
+        smoothing.smoothTaubin(*current, iterations, lambda);
+    } else {
+        smoothing.smooth(*current, iterations, lambda);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout << (taubin ? "Taubin" : "Laplacian") << "-smoothed " << iterations << " iterations with " << weighting
+            << " weights in " << std::chrono::duration<double, std::milli>(end - built).count() << " ms, adjacency in "
+            << std::chrono::duration<double, std::milli>(built - begin).count() << " ms" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Reports the average time & cache misses of the passes dominated by 1-ring walks
+ *        and face-to-vertex scatters, so that runs before & after --reorder can be compared
+ */
+bool HeadlessPipeline::benchmarkLocality(const unsigned int repetitions) {
+    TriangleMesh* current = loadedMesh();
+    if (current == nullptr || repetitions == 0) {
+        return false;
+    }
+
+    PerfCounter cacheMisses;
+    if (!cacheMisses.isAvailable()) {
+        std::cout << "Cache miss counters unavailable, reporting times only" << std::endl;
+    }
+
+    const auto measure = [&](const std::string& name, const std::function<void()>& pass) {
+        double milliseconds = 0.0;
+        uint64_t misses = 0;
+
+        for (unsigned int repetition = 0; repetition < repetitions; repetition++) {
+            const auto begin = std::chrono::steady_clock::now();
+            cacheMisses.start();
+            pass();
+            const auto passMisses = cacheMisses.stop();
+            milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            misses += passMisses.value_or(0);
+        }
+
+        std::cout << name << ": " << milliseconds / repetitions << " ms";
+        if (cacheMisses.isAvailable()) {
+            std::cout << ", " << misses / repetitions << " cache misses";
+        }
+        std::cout << std::endl;
+    };
+
+    std::cout << "Locality benchmark, vertices=" << current->vertices.size()
+            << " faces=" << current->faceVertices.size() / 3 << std::endl;
+
+    const HalfedgeView mesh = current->view();
+    std::vector<Cartesian3> lerped(current->vertices.size());
+    measure("centroidLerp", [&]() {
+        for (VertexId vertexId = 0; vertexId < mesh.vertexCount; vertexId++) {
+            lerped[vertexId] = centroidLerp(mesh, vertexId);
+        }
+    });
+    measure("computeNormals", [&]() {
+        current->computeNormals();
+    });
+    measure("subdivide", [&]() {
+        current->subdivide();
+    });
+
+    return true;
+}
+
+/**
+ * @brief Renders levels [0, levels] of the current mesh offscreen. The only operation that needs
+ *        a GL context, & with it a Qt platform plugin
+ */
+bool HeadlessPipeline::benchmarkRender(const unsigned int levels, const unsigned int frames) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr || frames == 0) {
+        return false;
+    }
+
+    std::map<unsigned int, TriangleMesh> meshes;
+    if (levels > 0) {
+        std::cout << "Generating Subdivision " << levels << "..." << std::endl;
+        meshes = current->subdivideLevels(levels, [](unsigned int) { return true; });
+        std::cout << "Finished generating Subdivision " << levels << std::endl;
+    }
+    meshes.emplace(0, *current);
+
+    return RenderBenchmark(frames).run(meshes);
+}
+
+/**
+ * @brief Times the build of a hierarchy over the current mesh & over its subdivision, against deriving the latter
+ *        by subdivided, then rays aimed from around the bounding sphere at random points near the centre through
+ *        each tree. The first SCANNED_QUERY_COUNT rays are also intersected with every face, their hits are
+ *        checked against the trees'
+ */
+bool HeadlessPipeline::benchmarkPick(const unsigned int rays) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr || rays == 0) {
+        return false;
+    }
+
+    const auto elapsedMilliseconds = [](const std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    };
+
+    // the same rays for every tree, so that they are compared on equal terms
+    std::mt19937 random(0);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    const auto randomPoint = [&]() {
+        return Cartesian3(uniform(random), uniform(random), uniform(random));
+    };
+    std::vector<std::pair<Cartesian3, Cartesian3>> originDirections(rays);
+    for (auto& [origin, direction] : originDirections) {
+        direction = randomPoint().unit();
+        const Cartesian3 target = current->centreOfGravity + randomPoint() * (0.5f * current->objectSize);
+        origin = target - direction * (2.0f * current->objectSize);
+    }
+    const float maximumDistance = 4.0f * current->objectSize;
+    const unsigned int scannedRays = std::min(rays, SCANNED_QUERY_COUNT);
+
+    const auto pick = [&](const std::string& name, const TriangleMesh& mesh, const BoundingVolumeHierarchy& hierarchy) {
+        unsigned int hits = 0;
+        FrameStatistics pickMilliseconds(rays);
+        std::vector<std::optional<RayHit>> scannedHits(scannedRays);
+        for (unsigned int ray = 0; ray < rays; ray++) {
+            const auto& [origin, direction] = originDirections[ray];
+            const auto begin = std::chrono::steady_clock::now();
+            const std::optional<RayHit> hit = hierarchy.intersect(mesh, origin, direction, maximumDistance);
+            pickMilliseconds.record(elapsedMilliseconds(begin));
+            hits += hit.has_value();
+            if (ray < scannedRays) {
+                scannedHits[ray] = hit;
+            }
+        }
+
+        // ties in distance may hit different faces, so hits are compared by distance
+        unsigned int mismatches = 0;
+        for (unsigned int ray = 0; ray < scannedRays; ray++) {
+            const auto& [origin, direction] = originDirections[ray];
+            const std::optional<RayHit> scanned =
+                    BoundingVolumeHierarchy::intersectByScan(mesh, origin, direction, maximumDistance);
+            mismatches += scanned.has_value() != scannedHits[ray].has_value() ||
+                          (scanned.has_value() && scanned->distance != scannedHits[ray]->distance);
+        }
+
+        std::cout << "  " << name << ": picked " << hits << "/" << rays << " hits, p50 "
+                << pickMilliseconds.percentile(50.0) << " ms, p99 " << pickMilliseconds.percentile(99.0) << " ms, "
+                << mismatches << " mismatches over " << scannedRays << " scanned rays" << std::endl;
+        if (mismatches > 0) {
+            std::cerr << "Picks through the " << name << " hierarchy disagree with scans" << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    const BoundingVolumeHierarchy hierarchy(*current);
+    std::cout << "Level 0: built " << hierarchy.nodeCount() << " nodes over " << current->faceVertices.size() / 3
+            << " faces in " << elapsedMilliseconds(begin) << " ms" << std::endl;
+    if (!pick("built", *current, hierarchy)) {
+        return false;
+    }
+
+    const TriangleMesh child = current->subdivide();
+    begin = std::chrono::steady_clock::now();
+    const BoundingVolumeHierarchy builtChildHierarchy(child);
+    std::cout << "Level 1: built " << builtChildHierarchy.nodeCount() << " nodes over "
+            << child.faceVertices.size() / 3 << " faces in " << elapsedMilliseconds(begin) << " ms" << std::endl;
+    begin = std::chrono::steady_clock::now();
+    const BoundingVolumeHierarchy subdividedHierarchy = hierarchy.subdivided(child);
+    std::cout << "Level 1: subdivided into " << subdividedHierarchy.nodeCount() << " nodes in "
+            << elapsedMilliseconds(begin) << " ms" << std::endl;
+    return pick("built", child, builtChildHierarchy) && pick("subdivided", child, subdividedHierarchy);
+}
+
+/**
+ * @brief For each of levels [0, levels] of the current mesh, times a k-d tree build over its vertices,
+ *        then batches of nearest vertex & radius queries near random vertices, through the tree
+ *        & by scanning every vertex. Only the first SCANNED_QUERY_COUNT queries are scanned,
+ *        their answers are checked against the tree's
+ */
+bool HeadlessPipeline::benchmarkNearest(const unsigned int levels, const unsigned int queries) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr || queries == 0) {
+        return false;
+    }
+
+    std::map<unsigned int, TriangleMesh> meshes;
+    if (levels > 0) {
+        std::cout << "Generating Subdivision " << levels << "..." << std::endl;
+        meshes = current->subdivideLevels(levels, [](unsigned int) { return true; });
+        std::cout << "Finished generating Subdivision " << levels << std::endl;
+    }
+    meshes.emplace(0, *current);
+
+    const auto elapsedMilliseconds = [](const std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    };
+
+    for (const auto& [level, levelMesh] : meshes) {
+        const std::vector<Cartesian3>& vertices = levelMesh.vertices;
+        const float radius = QUERY_RADIUS * levelMesh.objectSize;
+
+        std::mt19937 random(0);
+        std::uniform_int_distribution<VertexId> anyVertex(0, vertices.size() - 1);
+        std::uniform_real_distribution<float> jitter(-QUERY_JITTER * levelMesh.objectSize,
+                                                     QUERY_JITTER * levelMesh.objectSize);
+        std::vector<Cartesian3> points(queries);
+        for (Cartesian3& point : points) {
+            point = vertices[anyVertex(random)] + Cartesian3(jitter(random), jitter(random), jitter(random));
+        }
+        const std::vector<Cartesian3> scannedPoints(points.begin(),
+                                                    points.begin() + std::min(queries, SCANNED_QUERY_COUNT));
+
+        auto begin = std::chrono::steady_clock::now();
+        const KdTree tree(vertices);
+        std::cout << "Level " << level << ": built " << tree.nodeCount() << " nodes over " << vertices.size()
+                << " vertices in " << elapsedMilliseconds(begin) << " ms" << std::endl;
+
+        begin = std::chrono::steady_clock::now();
+        const std::vector<VertexId> nearest = tree.nearest(points);
+        const double nearestMilliseconds = elapsedMilliseconds(begin);
+
+        begin = std::chrono::steady_clock::now();
+        std::vector<VertexId> scannedNearest(scannedPoints.size());
+        parallelFor(0, scannedPoints.size(), [&](const unsigned int first, const unsigned int last) {
+            for (unsigned int query = first; query < last; query++) {
+                scannedNearest[query] = nearestByScan(vertices, scannedPoints[query]);
+            }
+        }, 1);
+        const double scannedNearestMilliseconds = elapsedMilliseconds(begin);
+
+        begin = std::chrono::steady_clock::now();
+        const std::vector<std::vector<VertexId>> found = tree.withinRadius(points, radius);
+        const double radiusMilliseconds = elapsedMilliseconds(begin);
+
+        begin = std::chrono::steady_clock::now();
+        std::vector<std::vector<VertexId>> scannedFound(scannedPoints.size());
+        parallelFor(0, scannedPoints.size(), [&](const unsigned int first, const unsigned int last) {
+            for (unsigned int query = first; query < last; query++) {
+                scannedFound[query] = withinRadiusByScan(vertices, scannedPoints[query], radius);
+            }
+        }, 1);
+        const double scannedRadiusMilliseconds = elapsedMilliseconds(begin);
+
+        // ties in distance may pick different vertices, so nearest answers are compared by distance
+        unsigned int mismatches = 0;
+        size_t foundCount = 0;
+        for (unsigned int query = 0; query < scannedPoints.size(); query++) {
+            std::vector<VertexId> sortedFound = found[query];
+            std::sort(sortedFound.begin(), sortedFound.end());
+            mismatches += squaredDistance(vertices[nearest[query]], scannedPoints[query]) !=
+                          squaredDistance(vertices[scannedNearest[query]], scannedPoints[query]);
+            mismatches += sortedFound != scannedFound[query];
+            foundCount += scannedFound[query].size();
+        }
+
+        const auto microsecondsPerQuery = [](const double milliseconds, const size_t count) {
+            return 1000.0 * milliseconds / count;
+        };
+        std::cout << "  nearest: " << microsecondsPerQuery(nearestMilliseconds, points.size()) << " us/query in "
+                << nearestMilliseconds << " ms, scan "
+                << microsecondsPerQuery(scannedNearestMilliseconds, scannedPoints.size()) << " us/query\n"
+                << "  radius " << radius << ": " << microsecondsPerQuery(radiusMilliseconds, points.size())
+                << " us/query in " << radiusMilliseconds << " ms, scan "
+                << microsecondsPerQuery(scannedRadiusMilliseconds, scannedPoints.size()) << " us/query, "
+                << static_cast<double>(foundCount) / scannedPoints.size() << " vertices found on average\n"
+                << "  " << mismatches << " mismatches over " << scannedPoints.size() << " scanned queries"
+                << std::endl;
+
+        if (mismatches > 0) {
+            std::cerr << "k-d tree queries disagree with scans on level " << level << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks the heat method distances from vertex 0, which every level keeps, against shortest edge paths
+ *        on levels [0, levels]. Near the source both differ by the zigzag of edge paths, so the far field is checked,
+ *        which the time step decides: too short & its heat is lost to roundoff, distances falling well short
+ */
+bool HeadlessPipeline::benchmarkGeodesics(const unsigned int levels) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr || current->vertices.empty()) {
+        return false;
+    }
+
+    std::map<unsigned int, TriangleMesh> meshes;
+    if (levels > 0) {
+        std::cout << "Generating Subdivision " << levels << "..." << std::endl;
+        meshes = current->subdivideLevels(levels, [](unsigned int) { return true; });
+        std::cout << "Finished generating Subdivision " << levels << std::endl;
+    }
+    meshes.emplace(0, *current);
+
+    const auto elapsedMilliseconds = [](const std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    };
+
+    for (const auto& [level, levelMesh] : meshes) {
+        auto begin = std::chrono::steady_clock::now();
+        const HeatGeodesics heatGeodesics(levelMesh);
+        const double factorMilliseconds = elapsedMilliseconds(begin);
+        if (!heatGeodesics.succeeded()) {
+            std::cerr << "The heat method systems are not positive definite on level " << level << std::endl;
+            return false;
+        }
+
+        begin = std::chrono::steady_clock::now();
+        const std::vector<float> distances = heatGeodesics.distancesFrom({0});
+        const double queryMilliseconds = elapsedMilliseconds(begin);
+
+        begin = std::chrono::steady_clock::now();
+        const std::vector<double> pathDistances = edgePathDistances(levelMesh, 0);
+        const double pathMilliseconds = elapsedMilliseconds(begin);
+
+        double farthestPath = 0.0;
+        float farthest = 0.0f;
+        for (VertexId vertexId = 0; vertexId < distances.size(); vertexId++) {
+            if (std::isfinite(pathDistances[vertexId])) {
+                farthestPath = std::max(farthestPath, pathDistances[vertexId]);
+                farthest = std::max(farthest, distances[vertexId]);
+            }
+        }
+        std::vector<double> farRatios;
+        for (VertexId vertexId = 0; vertexId < distances.size(); vertexId++) {
+            if (std::isfinite(pathDistances[vertexId]) && pathDistances[vertexId] > FAR_FIELD * farthestPath) {
+                farRatios.push_back(distances[vertexId] / pathDistances[vertexId]);
+            }
+        }
+        if (farRatios.empty()) {
+            std::cerr << "No vertex but the source is reached on level " << level << std::endl;
+            return false;
+        }
+        std::nth_element(farRatios.begin(), farRatios.begin() + farRatios.size() / 2, farRatios.end());
+        const double medianRatio = farRatios[farRatios.size() / 2];
+
+        std::cout << "Level " << level << ", " << levelMesh.vertices.size() << " vertices: factorised in "
+                << factorMilliseconds << " ms, " << heatGeodesics.factorNonzeros() << " nonzeros\n"
+                << "  heat method " << queryMilliseconds << " ms, farthest at " << farthest << "\n"
+                << "  edge paths " << pathMilliseconds << " ms, farthest at " << farthestPath << "\n"
+                << "  far field median ratio " << medianRatio << " over " << farRatios.size() << " vertices"
+                << std::endl;
+
+        if (!(medianRatio >= MINIMUM_FAR_FIELD_RATIO && medianRatio <= MAXIMUM_FAR_FIELD_RATIO)) {
+            std::cerr << "Heat method distances disagree with edge paths on level " << level << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Factorises the heat method systems on the first of consecutive --geodesics operations,
+ *        the others only paying for their queries
+ */
+bool HeadlessPipeline::writeGeodesics(const VertexId source, const std::string& csvPath) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    if (source >= current->vertices.size()) {
+        std::cerr << "No vertex " << source << " among " << current->vertices.size() << std::endl;
+        return false;
+    }
+
+    if (!geodesics.has_value()) {
+        const auto begin = std::chrono::steady_clock::now();
+        geodesics.emplace(*current);
+        const double milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        if (!geodesics->succeeded()) {
+            std::cerr << "The heat method systems are not positive definite, check --validate" << std::endl;
+            geodesics.reset();
+            return false;
+        }
+        std::cout << "Factorised the heat method systems in " << milliseconds << " ms, "
+                << geodesics->factorNonzeros() << " nonzeros" << std::endl;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const std::vector<float> distances = geodesics->distancesFrom({source});
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::ofstream csv(csvPath);
+    csv << "vertex,distance\n";
+    VertexId farthest = source;
+    for (VertexId vertexId = 0; vertexId < distances.size(); vertexId++) {
+        csv << vertexId << ',' << distances[vertexId] << '\n';
+        if (std::isfinite(distances[vertexId]) && distances[vertexId] > distances[farthest]) {
+            farthest = vertexId;
+        }
+    }
+    if (!csv) {
+        std::cerr << "Failed to output: " << csvPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Distances from vertex " << source << " in " << milliseconds << " ms, farthest vertex "
+            << farthest << " at " << distances[farthest] << ", written to: " << csvPath << std::endl;
+    return true;
+}
+
+/**
+ * @brief Reports the bulk of each curvature, the range a colour map needs, & writes them with the directions
+ *        of greatest curvature, those of least curvature being orthogonal within the tangent plane
+ */
+bool HeadlessPipeline::writeCurvature(const std::string& csvPath) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const MeshCurvature curvature(*current);
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::ofstream csv(csvPath);
+    csv << "vertex,mean,gaussian,minimum,maximum,maximum_x,maximum_y,maximum_z\n";
+    for (VertexId vertexId = 0; vertexId < current->vertices.size(); vertexId++) {
+        const Cartesian3& direction = curvature.maximumDirections[vertexId];
+        csv << vertexId << ',' << curvature.meanCurvatures[vertexId] << ',' << curvature.gaussianCurvatures[vertexId]
+            << ',' << curvature.minimumCurvatures[vertexId] << ',' << curvature.maximumCurvatures[vertexId] << ','
+            << direction.x << ',' << direction.y << ',' << direction.z << '\n';
+    }
+    if (!csv) {
+        std::cerr << "Failed to output: " << csvPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Curvatures of " << current->vertices.size() << " vertices in " << milliseconds << " ms\n";
+    // 5th & 95th percentiles, as the extremes are set by the few vertices with tiny areas
+    const auto printRange = [](const char* name, std::vector<float> values) {
+        if (values.empty()) {
+            return;
+        }
+        const auto lower = values.begin() + values.size() / 20;
+        const auto upper = values.begin() + (values.size() - 1) * 19 / 20;
+        std::nth_element(values.begin(), lower, values.end());
+        // the second partition must leave the first in place, so it only sorts above it
+        const float lowerValue = *lower;
+        if (upper > lower) {
+            std::nth_element(lower + 1, upper, values.end());
+        }
+        std::cout << "  " << name << " mostly in [" << lowerValue << ", " << *upper << "]\n";
+    };
+    printRange("mean", curvature.meanCurvatures);
+    printRange("Gaussian", curvature.gaussianCurvatures);
+    std::cout << "Written to: " << csvPath << std::endl;
+    return true;
+}
+
+/**
+ * @brief Renders the current mesh in the default view of the window, without vertex markers,
+ *        using the software rasterizer so that no display or GL driver is needed
+ */
+bool HeadlessPipeline::thumbnail(const unsigned int width, const unsigned int height, const std::string& imagePath) {
+    const TriangleMesh* current = loadedMesh();
+    if (current == nullptr || width == 0 || height == 0) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    SoftwareRasterizer rasterizer(width, height);
+    rasterizer.render(*current, RenderParameters());
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Rasterized " << width << "x" << height << " in " << milliseconds << " ms" << std::endl;
+
+    if (!rasterizer.writeImage(imagePath)) {
+        std::cerr << "Failed to output: " << imagePath << std::endl;
+        return false;
+    }
+
+    std::cout << "Written to file: " << imagePath << std::endl;
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef HEADLESS_PIPELINE_H
+#define HEADLESS_PIPELINE_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "HeatGeodesics.h"
+#include "TriangleMesh.h"
+
+/**
+ * Runs mesh operations from the command line without opening a window.
+ *
+ * Operations are applied in order to the mesh at meshPath, which is only read
+ * once an operation needs it in memory. See printUsage for the operations.
+ */
+class HeadlessPipeline {
+    std::string meshPath;
+    std::optional<TriangleMesh> mesh;
+    // whether every subdivided level is reordered along the Morton curve
+    bool reorderLevels;
+    // factorised for the mesh as it is, kept across consecutive --geodesics operations
+    std::optional<HeatGeodesics> geodesics;
+
+public:
+    explicit HeadlessPipeline(const std::string& meshPath);
+
+    // returns the process exit code
+    int run(const std::vector<std::string>& arguments);
+
+    static void printUsage(const std::string& program);
+
+private:
+    // reads the mesh on first use, nullptr if the read failed
+    TriangleMesh* loadedMesh();
+
+    bool subdivide(unsigned int levels);
+
+    bool write(const std::string& outputPath);
+
+    bool streamSubdivide(unsigned int levels, const std::string& outputPath) const;
+
+    // error is relative to the object size
+    bool decimate(unsigned int faces, float error);
+
+    bool reorder();
+
+    bool validate();
+
+    bool reportComponents();
+
+    bool writeComponents(const std::string& outputPath);
+
+    bool computeNormals(const std::string& weighting);
+
+    bool smooth(const std::string& weighting, unsigned int iterations, float lambda, bool taubin);
+
+    bool benchmarkLocality(unsigned int repetitions);
+
+    bool benchmarkRender(unsigned int levels, unsigned int frames);
+
+    bool benchmarkPick(unsigned int rays);
+
+    bool benchmarkNearest(unsigned int levels, unsigned int queries);
+
+    bool benchmarkGeodesics(unsigned int levels);
+
+    bool writeGeodesics(VertexId source, const std::string& csvPath);
+
+    bool writeCurvature(const std::string& csvPath);
+
+    bool thumbnail(unsigned int width, unsigned int height, const std::string& imagePath);
+};
+
+#endif
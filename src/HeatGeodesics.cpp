@@ -0,0 +1,297 @@
+#include "HeatGeodesics.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <limits>
+
+#include "DisjointSets.h"
+#include "Parallel.h"
+
+// of the time step in squared mean edge lengths. The paper's 1 leaves the far field with heat below roundoff
+// on subdivided meshes, e.g. the farthest distance on the horse shrinking from 0.23 to 0.13 at level 2
+constexpr double HEAT_TIME_FACTOR = 16.0;
+// relative to the squared object size, the least time step, so that it stops shrinking with the edges
+// of ever finer meshes once heat would take exp(-distance^2 / 4 time) below roundoff across the object
+constexpr double MINIMUM_HEAT_TIME = 1e-4;
+
+// relative to the scale of the Laplacian, the mass shift that makes it positive definite without moving
+// distances noticeably, as it is singular along constant functions
+constexpr double POISSON_SHIFT = 1e-8;
+
+typedef std::array<double, 3> Vector;
+
+static Vector vectorOf(const Cartesian3& point) {
+    return {point.x, point.y, point.z};
+}
+
+static Vector difference(const Vector& a, const Vector& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static Vector cross(const Vector& a, const Vector& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+static double dot(const Vector& a, const Vector& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/**
+ * @brief Assembles the cotan Laplacian, positive semi-definite, with an entry for every edge & the diagonal.
+ *        Each half-edge adds its weight to the 2 entries of its edge & takes it off both diagonals,
+ *        rows being merged from a counting sort so that boundaries need no special case
+ *
+ * @param diagonalEntries filled with the entry of the diagonal of every row
+ */
+static SparseMatrix cotanLaplacian(const unsigned int vertexCount,
+                                   const std::vector<VertexId>& faceVertices,
+                                   const std::vector<double>& halfCotangents,
+                                   std::vector<unsigned int>& diagonalEntries) {
+    SparseMatrix laplacian;
+    laplacian.size = vertexCount;
+
+    std::vector<unsigned int> rowStarts(vertexCount + 1, 0);
+    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+        rowStarts[faceVertices[TriangleMesh::idToIndex(edgeId)] + 1] += 2;
+        rowStarts[faceVertices[edgeId] + 1] += 2;
+    }
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        rowStarts[vertexId + 1] += rowStarts[vertexId];
+    }
+
+    // (column, value) pairs of every row, with repeats, the diagonal once per half-edge
+    std::vector<std::pair<unsigned int, double>> entries(rowStarts[vertexCount]);
+    std::vector<unsigned int> nextEntries(rowStarts.begin(), rowStarts.end() - 1);
+    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+        const VertexId tail = faceVertices[TriangleMesh::idToIndex(edgeId)];
+        const VertexId head = faceVertices[edgeId];
+        const double weight = halfCotangents[edgeId];
+        entries[nextEntries[tail]++] = {head, -weight};
+        entries[nextEntries[tail]++] = {tail, weight};
+        entries[nextEntries[head]++] = {tail, -weight};
+        entries[nextEntries[head]++] = {head, weight};
+    }
+
+    laplacian.rowStarts.assign(vertexCount + 1, 0);
+    diagonalEntries.assign(vertexCount, 0);
+    for (VertexId row = 0; row < vertexCount; row++) {
+        std::sort(entries.begin() + rowStarts[row], entries.begin() + rowStarts[row + 1],
+                  [](const auto& a, const auto& b) {
+                      return a.first < b.first;
+                  });
+
+        for (unsigned int entry = rowStarts[row]; entry < rowStarts[row + 1]; entry++) {
+            if (laplacian.columns.size() > laplacian.rowStarts[row] &&
+                laplacian.columns.back() == entries[entry].first) {
+                laplacian.values.back() += entries[entry].second;
+                continue;
+            }
+            if (entries[entry].first == row) {
+                diagonalEntries[row] = laplacian.columns.size();
+            }
+            laplacian.columns.push_back(entries[entry].first);
+            laplacian.values.push_back(entries[entry].second);
+        }
+        laplacian.rowStarts[row + 1] = laplacian.columns.size();
+    }
+
+    return laplacian;
+}
+
+/**
+ * @brief Takes the cotangents & areas from the faces, the time step from the mean edge length as in the paper
+ *        but HEAT_TIME_FACTOR times longer & bounded below by the object size, labels the vertices the Laplacian
+ *        couples, then factorises both systems concurrently in the same fill-reducing order, as they share
+ *        the pattern of the Laplacian
+ */
+HeatGeodesics::HeatGeodesics(const TriangleMesh& mesh)
+    : vertices(mesh.vertices),
+      faceVertices(mesh.faceVertices),
+      halfCotangents(mesh.faceVertices.size()),
+      vertexCornerStarts(mesh.vertices.size() + 1, 0),
+      vertexCorners(mesh.faceVertices.size()),
+      vertexComponents(mesh.vertices.size()),
+      componentCount(0) {
+    const unsigned int vertexCount = vertices.size();
+    const FaceIndex faceCount = faceVertices.size() / 3;
+
+    std::vector<double> faceAreas(faceCount);
+    std::vector<double> edgeLengths(faceVertices.size());
+    parallelFor(0, faceCount, [&](const FaceIndex begin, const FaceIndex end) {
+        for (FaceIndex face = begin; face < end; face++) {
+            for (unsigned int slot = 0; slot < 3; slot++) {
+                const EdgeId edgeId = 3 * face + slot;
+                const Vector opposite = vectorOf(vertices[faceVertices[TriangleMesh::nextIdInFace(edgeId)]]);
+                const Vector toTail = difference(vectorOf(vertices[faceVertices[TriangleMesh::idToIndex(edgeId)]]),
+                                                 opposite);
+                const Vector toHead = difference(vectorOf(vertices[faceVertices[edgeId]]), opposite);
+                const Vector normal = cross(toTail, toHead);
+                const double doubleArea = std::sqrt(dot(normal, normal));
+
+                halfCotangents[edgeId] = doubleArea > 0.0 ? dot(toTail, toHead) / doubleArea / 2.0 : 0.0;
+                faceAreas[face] = doubleArea / 2.0;
+                const Vector edge = difference(toHead, toTail);
+                edgeLengths[edgeId] = std::sqrt(dot(edge, edge));
+            }
+        }
+    });
+
+    std::vector<double> masses(vertexCount, 0.0);
+    double lengthSum = 0.0;
+    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+        masses[faceVertices[edgeId]] += faceAreas[edgeId / 3] / 3.0;
+        lengthSum += edgeLengths[edgeId];
+        vertexCornerStarts[faceVertices[edgeId] + 1]++;
+    }
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        vertexCornerStarts[vertexId + 1] += vertexCornerStarts[vertexId];
+    }
+    std::vector<unsigned int> nextCorners(vertexCornerStarts.begin(), vertexCornerStarts.end() - 1);
+    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+        vertexCorners[nextCorners[faceVertices[edgeId]]++] = edgeId;
+    }
+
+    // across faces rather than otherHalf, as pinched vertices join their fans in the Laplacian as well
+    DisjointSets vertexSets(vertexCount);
+    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+        vertexSets.unite(faceVertices[TriangleMesh::idToIndex(edgeId)], faceVertices[edgeId]);
+    }
+    std::vector<unsigned int> rootComponents(vertexCount, NO_VALUE);
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        unsigned int& component = rootComponents[vertexSets.find(vertexId)];
+        if (component == NO_VALUE) {
+            component = componentCount++;
+        }
+        vertexComponents[vertexId] = component;
+    }
+
+    if (faceVertices.empty()) {
+        return;
+    }
+
+    const double meanEdgeLength = lengthSum / faceVertices.size();
+    const double time = std::max(HEAT_TIME_FACTOR * meanEdgeLength * meanEdgeLength,
+                                 MINIMUM_HEAT_TIME * mesh.objectSize * mesh.objectSize);
+
+    std::vector<unsigned int> diagonalEntries;
+    const SparseMatrix laplacian = cotanLaplacian(vertexCount, faceVertices, halfCotangents, diagonalEntries);
+
+    double laplacianTrace = 0.0;
+    double massSum = 0.0;
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        laplacianTrace += laplacian.values[diagonalEntries[vertexId]];
+        massSum += masses[vertexId];
+    }
+    const double shift = massSum > 0.0 ? POISSON_SHIFT * laplacianTrace / massSum : POISSON_SHIFT;
+
+    SparseMatrix heatFlowMatrix = laplacian;
+    SparseMatrix poissonMatrix = laplacian;
+    for (double& value : heatFlowMatrix.values) {
+        value *= time;
+    }
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        heatFlowMatrix.values[diagonalEntries[vertexId]] += masses[vertexId];
+        poissonMatrix.values[diagonalEntries[vertexId]] += shift * masses[vertexId];
+    }
+
+    const std::vector<unsigned int> ordering = nestedDissectionOrdering(laplacian, vertices);
+    auto heatFlowFactor = std::async(std::launch::async, [&]() {
+        return SparseCholesky(heatFlowMatrix, ordering);
+    });
+    poisson.emplace(poissonMatrix, ordering);
+    heatFlow.emplace(heatFlowFactor.get());
+}
+
+bool HeatGeodesics::succeeded() const {
+    return heatFlow.has_value() && heatFlow->succeeded() && poisson.has_value() && poisson->succeeded();
+}
+
+/**
+ * @brief Flows heat from the sources, normalises its gradient in every face into the unit field pointing
+ *        away from them, then solves for the function whose Laplacian is the divergence of that field.
+ *        Faces & vertices are processed in parallel, each vertex gathering the divergence of its corners.
+ *        The function is only determined up to a constant on each component, which its sources there fix
+ */
+std::vector<float> HeatGeodesics::distancesFrom(const std::vector<VertexId>& sources) const {
+    std::vector<float> distances(vertices.size(), std::numeric_limits<float>::infinity());
+    if (!succeeded() || sources.empty()) {
+        return distances;
+    }
+
+    std::vector<double> heat(vertices.size(), 0.0);
+    for (const VertexId source : sources) {
+        heat[source] = 1.0;
+    }
+    heatFlow->solve(heat);
+
+    const FaceIndex faceCount = faceVertices.size() / 3;
+    std::vector<double> cornerDivergences(faceVertices.size());
+    parallelFor(0, faceCount, [&](const FaceIndex begin, const FaceIndex end) {
+        for (FaceIndex face = begin; face < end; face++) {
+            const VertexId* corners = &faceVertices[3 * face];
+            const std::array<Vector, 3> points = {
+                vectorOf(vertices[corners[0]]), vectorOf(vertices[corners[1]]), vectorOf(vertices[corners[2]])
+            };
+            const Vector normal = cross(difference(points[1], points[0]), difference(points[2], points[0]));
+            const double squaredNormal = dot(normal, normal);
+
+            // each corner's heat times the edge opposite it turned inwards, over twice the area
+            Vector gradient{0.0, 0.0, 0.0};
+            for (unsigned int slot = 0; slot < 3; slot++) {
+                const Vector turned = cross(normal, difference(points[(slot + 2) % 3], points[(slot + 1) % 3]));
+                for (unsigned int axis = 0; axis < 3; axis++) {
+                    gradient[axis] += heat[corners[slot]] * turned[axis];
+                }
+            }
+            const double length = std::sqrt(dot(gradient, gradient));
+            Vector field{0.0, 0.0, 0.0};
+            if (squaredNormal > 0.0 && length > 0.0) {
+                field = {-gradient[0] / length, -gradient[1] / length, -gradient[2] / length};
+            }
+
+            // the edges leaving each corner, weighted by the cotangents of the angles opposite them
+            for (unsigned int slot = 0; slot < 3; slot++) {
+                const unsigned int next = (slot + 1) % 3;
+                const unsigned int previous = (slot + 2) % 3;
+                cornerDivergences[3 * face + slot] =
+                    halfCotangents[3 * face + next] * dot(difference(points[next], points[slot]), field) +
+                    halfCotangents[3 * face + slot] * dot(difference(points[previous], points[slot]), field);
+            }
+        }
+    });
+
+    std::vector<double> potential(vertices.size());
+    parallelFor(0, vertices.size(), [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            double divergence = 0.0;
+            for (unsigned int corner = vertexCornerStarts[vertexId]; corner < vertexCornerStarts[vertexId + 1]; corner++) {
+                divergence += cornerDivergences[vertexCorners[corner]];
+            }
+            // the Laplacian is assembled positive, the divergence is of the field pointing away from the sources
+            potential[vertexId] = -divergence;
+        }
+    });
+    poisson->solve(potential);
+
+    std::vector<double> sourcePotentials(componentCount, std::numeric_limits<double>::infinity());
+    for (const VertexId source : sources) {
+        double& sourcePotential = sourcePotentials[vertexComponents[source]];
+        sourcePotential = std::min(sourcePotential, potential[source]);
+    }
+    parallelFor(0, vertices.size(), [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            if (const double sourcePotential = sourcePotentials[vertexComponents[vertexId]];
+                std::isfinite(sourcePotential)) {
+                distances[vertexId] = static_cast<float>(potential[vertexId] - sourcePotential);
+            }
+        }
+    });
+
+    return distances;
+}
+
+size_t HeatGeodesics::factorNonzeros() const {
+    return (heatFlow.has_value() ? heatFlow->factorNonzeros() : 0) + (poisson.has_value() ? poisson->factorNonzeros() : 0);
+}
@@ -0,0 +1,48 @@
+#ifndef HEAT_GEODESICS_H
+#define HEAT_GEODESICS_H
+
+#include <optional>
+#include <vector>
+
+#include "SparseCholesky.h"
+#include "TriangleMesh.h"
+
+/**
+ * Geodesic distances over a TriangleMesh by the heat method (Crane, Weischedel & Wardetzky):
+ * heat diffused from the sources for a short time gives the direction of the distance gradient,
+ * which a Poisson equation integrates back into distances.
+ *
+ * Both linear systems, over the cotan Laplacian & the lumped mass matrix, are factorised when the
+ * object is built, so that each query costs 2 pairs of substitutions plus parallel gradient &
+ * divergence passes. Keep the object for as long as the mesh does not change, like a KdTree.
+ */
+class HeatGeodesics {
+    std::vector<Cartesian3> vertices;
+    std::vector<VertexId> faceVertices;
+    // 1/2 cot of the angle opposite every half-edge
+    std::vector<double> halfCotangents;
+    // the corners of vertex v, as the half-edges arriving at it, are [vertexCornerStarts[v], vertexCornerStarts[v + 1])
+    // of vertexCorners
+    std::vector<unsigned int> vertexCornerStarts;
+    std::vector<EdgeId> vertexCorners;
+    // component of every vertex, joined by faces
+    std::vector<unsigned int> vertexComponents;
+    unsigned int componentCount;
+    // of (mass + time * laplacian) & of (laplacian + shift * mass)
+    std::optional<SparseCholesky> heatFlow;
+    std::optional<SparseCholesky> poisson;
+
+public:
+    explicit HeatGeodesics(const TriangleMesh& mesh);
+
+    // false if either system could not be factorised, e.g. for meshes with degenerate faces
+    bool succeeded() const;
+
+    // distance of every vertex to the closest of sources along the surface, infinity on components without a source
+    std::vector<float> distancesFrom(const std::vector<VertexId>& sources) const;
+
+    // nonzeros of both factors, off the diagonal
+    size_t factorNonzeros() const;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "KdTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+#include "MortonOrder.h"
+#include "Parallel.h"
+
+// nodes with this many points or fewer are leaves, scanned linearly
+constexpr unsigned int LEAF_POINT_COUNT = 8;
+
+// subtrees with fewer points are built by the thread that reached them
+constexpr unsigned int PARALLEL_SUBTREE_POINT_COUNT = 1u << 14;
+
+// a single query takes microseconds, so far fewer of them pay for a thread than items of a mesh pass
+constexpr unsigned int PARALLEL_QUERY_COUNT = 1u << 8;
+
+// depth of a median split tree over 2^32 points, bounding the nodes pending during a query
+constexpr unsigned int MAXIMUM_DEPTH = 33;
+
+/**
+ * @return the nodes of a subtree over count points, split at the median down to leaves
+ */
+static unsigned int subtreeNodeCount(const unsigned int count) {
+    if (count <= LEAF_POINT_COUNT) {
+        return 1;
+    }
+    return 1 + subtreeNodeCount(count / 2) + subtreeNodeCount(count - count / 2);
+}
+
+static float squaredDistance(const std::array<float, 3>& a, const std::array<float, 3>& b) {
+    const float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+    return x * x + y * y + z * z;
+}
+
+/**
+ * @return ids [0, queries.size()) sorted by the Morton code of their query within the bounds of queries
+ */
+static std::vector<unsigned int> alongMortonCurve(const std::vector<Cartesian3>& queries) {
+    if (queries.empty()) {
+        return {};
+    }
+
+    Cartesian3 min = queries.front();
+    Cartesian3 max = queries.front();
+    for (const Cartesian3& query : queries) {
+        min = Cartesian3(std::min(min.x, query.x), std::min(min.y, query.y), std::min(min.z, query.z));
+        max = Cartesian3(std::max(max.x, query.x), std::max(max.y, query.y), std::max(max.z, query.z));
+    }
+
+    std::vector<std::pair<uint32_t, unsigned int>> codes(queries.size());
+    parallelFor(0, queries.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int query = begin; query < end; query++) {
+            codes[query] = {mortonCode(queries[query], min, max), query};
+        }
+    });
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<unsigned int> order(queries.size());
+    for (unsigned int visit = 0; visit < order.size(); visit++) {
+        order[visit] = codes[visit].second;
+    }
+    return order;
+}
+
+class KdTree::Builder {
+    KdTree& tree;
+
+    // by index of the points the tree is built from
+    std::vector<std::array<float, 3>> positions;
+
+    // nodes were allocated up front, so that threads only hand out their indices
+    std::atomic<unsigned int> nextNode;
+
+    // splits at depths below this are built concurrently, enough to keep every thread busy
+    unsigned int parallelDepth;
+
+public:
+    Builder(KdTree& tree, const std::vector<Cartesian3>& points)
+        : tree(tree),
+          positions(points.size()),
+          nextNode(1),
+          parallelDepth(1) {
+        while ((1u << parallelDepth) < 2 * std::max(std::thread::hardware_concurrency(), 1u)) {
+            parallelDepth++;
+        }
+
+        parallelFor(0, positions.size(), [&](const unsigned int begin, const unsigned int end) {
+            for (unsigned int point = begin; point < end; point++) {
+                positions[point] = {points[point].x, points[point].y, points[point].z};
+            }
+        });
+    }
+
+    /**
+     * @brief Turns node into the root of a subtree over pointIds[first, first + count), reordering that
+     *        range so that every leaf covers consecutive points
+     *
+     * Splits along the axis of largest extent at the median point, so that the tree is balanced
+     * whatever the distribution of the points
+     */
+    void build(const unsigned int nodeIndex, const unsigned int first, const unsigned int count,
+               const unsigned int depth) {
+        Node& node = tree.nodes[nodeIndex];
+        node.first = first;
+        node.count = count;
+
+        if (count <= LEAF_POINT_COUNT) {
+            return;
+        }
+
+        VertexId* ids = tree.pointIds.data() + first;
+
+        std::array<float, 3> lower = positions[ids[0]];
+        std::array<float, 3> upper = positions[ids[0]];
+        for (unsigned int i = 1; i < count; i++) {
+            for (unsigned int axis = 0; axis < 3; axis++) {
+                lower[axis] = std::min(lower[axis], positions[ids[i]][axis]);
+                upper[axis] = std::max(upper[axis], positions[ids[i]][axis]);
+            }
+        }
+
+        unsigned int axis = 0;
+        for (unsigned int other = 1; other < 3; other++) {
+            if (upper[other] - lower[other] > upper[axis] - lower[axis]) {
+                axis = other;
+            }
+        }
+
+        // points left of the median are no greater than it along axis, points right of it no less
+        const unsigned int leftCount = count / 2;
+        std::nth_element(ids, ids + leftCount, ids + count, [&](const VertexId a, const VertexId b) {
+            return positions[a][axis] < positions[b][axis];
+        });
+
+        const unsigned int children = nextNode.fetch_add(2);
+        node.split = positions[ids[leftCount]][axis];
+        node.axis = axis;
+        node.first = children;
+        node.count = 0;
+
+        if (count >= PARALLEL_SUBTREE_POINT_COUNT && depth < parallelDepth) {
+            auto left = std::async(std::launch::async, [&]() {
+                build(children, first, leftCount, depth + 1);
+            });
+            build(children + 1, first + leftCount, count - leftCount, depth + 1);
+            left.get();
+        } else {
+            build(children, first, leftCount, depth + 1);
+            build(children + 1, first + leftCount, count - leftCount, depth + 1);
+        }
+    }
+
+    // copies the points in the order the build left them in
+    void gatherPoints() const {
+        tree.points.resize(tree.pointIds.size());
+        parallelFor(0, tree.points.size(), [&](const unsigned int begin, const unsigned int end) {
+            for (unsigned int i = begin; i < end; i++) {
+                tree.points[i] = positions[tree.pointIds[i]];
+            }
+        });
+    }
+};
+
+KdTree::KdTree(const std::vector<Cartesian3>& points)
+    : pointIds(points.size()) {
+    if (points.empty()) {
+        return;
+    }
+
+    std::iota(pointIds.begin(), pointIds.end(), 0);
+
+    nodes.resize(subtreeNodeCount(points.size()));
+    Builder builder(*this, points);
+    builder.build(0, 0, points.size(), 0);
+    builder.gatherPoints();
+}
+
+/**
+ * @brief Descends to the leaf holding query first, then backtracks into the other side of every
+ *        split that is closer than the closest point found so far
+ */
+VertexId KdTree::nearest(const Cartesian3& query) const {
+    if (nodes.empty()) {
+        return NO_VALUE;
+    }
+
+    const std::array<float, 3> point{query.x, query.y, query.z};
+    float closestDistance = std::numeric_limits<float>::infinity();
+    unsigned int closest = 0;
+
+    // nodes still to visit, with the squared distance from query to their side of the split
+    std::array<std::pair<unsigned int, float>, MAXIMUM_DEPTH> pending;
+    unsigned int pendingCount = 0;
+    pending[pendingCount++] = {0, 0.0f};
+
+    while (pendingCount > 0) {
+        const auto [nodeIndex, sideDistance] = pending[--pendingCount];
+        if (sideDistance >= closestDistance) {
+            continue;
+        }
+
+        const Node* node = &nodes[nodeIndex];
+        while (node->count == 0) {
+            const float offset = point[node->axis] - node->split;
+            const bool isRight = offset >= 0.0f;
+            pending[pendingCount++] = {node->first + !isRight, offset * offset};
+            node = &nodes[node->first + isRight];
+        }
+
+        for (unsigned int i = node->first; i < node->first + node->count; i++) {
+            if (const float distance = squaredDistance(points[i], point); distance < closestDistance) {
+                closestDistance = distance;
+                closest = i;
+            }
+        }
+    }
+
+    return pointIds[closest];
+}
+
+std::vector<VertexId> KdTree::withinRadius(const Cartesian3& query, const float radius) const {
+    std::vector<VertexId> found;
+    if (nodes.empty() || radius < 0.0f) {
+        return found;
+    }
+
+    const std::array<float, 3> point{query.x, query.y, query.z};
+    const float squaredRadius = radius * radius;
+
+    std::array<unsigned int, MAXIMUM_DEPTH> pending;
+    unsigned int pendingCount = 0;
+    pending[pendingCount++] = 0;
+
+    while (pendingCount > 0) {
+        const Node* node = &nodes[pending[--pendingCount]];
+        while (node->count == 0) {
+            const float offset = point[node->axis] - node->split;
+            const bool isRight = offset >= 0.0f;
+            if (offset * offset <= squaredRadius) {
+                pending[pendingCount++] = node->first + !isRight;
+            }
+            node = &nodes[node->first + isRight];
+        }
+
+        for (unsigned int i = node->first; i < node->first + node->count; i++) {
+            if (squaredDistance(points[i], point) <= squaredRadius) {
+                found.push_back(pointIds[i]);
+            }
+        }
+    }
+
+    return found;
+}
+
+std::vector<VertexId> KdTree::nearest(const std::vector<Cartesian3>& queries) const {
+    const std::vector<unsigned int> order = alongMortonCurve(queries);
+
+    std::vector<VertexId> found(queries.size());
+    parallelFor(0, order.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int visit = begin; visit < end; visit++) {
+            found[order[visit]] = nearest(queries[order[visit]]);
+        }
+    }, PARALLEL_QUERY_COUNT);
+
+    return found;
+}
+
+std::vector<std::vector<VertexId>> KdTree::withinRadius(const std::vector<Cartesian3>& queries,
+                                                        const float radius) const {
+    const std::vector<unsigned int> order = alongMortonCurve(queries);
+
+    std::vector<std::vector<VertexId>> found(queries.size());
+    parallelFor(0, order.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int visit = begin; visit < end; visit++) {
+            found[order[visit]] = withinRadius(queries[order[visit]], radius);
+        }
+    }, PARALLEL_QUERY_COUNT);
+
+    return found;
+}
+
+unsigned int KdTree::nodeCount() const {
+    return nodes.size();
+}
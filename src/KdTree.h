@@ -0,0 +1,57 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include <array>
+#include <vector>
+
+#include "TriangleMesh.h"
+
+/**
+ * Static k-d tree over points, e.g. TriangleMesh::vertices, for nearest point & radius queries.
+ *
+ * Built by splitting at the median along the axis of largest extent, subtrees being built
+ * concurrently. The tree keeps its own copy of the points, laid out leaf by leaf, so changes
+ * to the points it was built from need a new tree.
+ *
+ * The batch queries spread their query points over every hardware thread, visiting them along
+ * a Morton curve so that consecutive queries walk the same nodes.
+ */
+class KdTree {
+    struct Node {
+        // interior nodes: points below split along axis are under node first, the others under first + 1
+        float split;
+        unsigned int axis;
+        // leaves: the points [first, first + count) of points. Interior nodes: count is 0
+        unsigned int first;
+        unsigned int count;
+    };
+
+    // scratch of a build, shared by the threads building its subtrees
+    class Builder;
+
+    std::vector<Node> nodes;
+    // in leaf order, alongside the index each one had in the points the tree was built from
+    std::vector<std::array<float, 3>> points;
+    std::vector<VertexId> pointIds;
+
+public:
+    KdTree() = default;
+
+    explicit KdTree(const std::vector<Cartesian3>& points);
+
+    // index of the closest point to query, NO_VALUE if the tree is empty. Ties go to either point
+    VertexId nearest(const Cartesian3& query) const;
+
+    // indices of the points at most radius away from query, in no particular order
+    std::vector<VertexId> withinRadius(const Cartesian3& query, float radius) const;
+
+    // nearest for each of queries, in the same order
+    std::vector<VertexId> nearest(const std::vector<Cartesian3>& queries) const;
+
+    // withinRadius for each of queries, in the same order
+    std::vector<std::vector<VertexId>> withinRadius(const std::vector<Cartesian3>& queries, float radius) const;
+
+    unsigned int nodeCount() const;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "LaplacianSmoothing.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Parallel.h"
+
+typedef std::array<float, 3> Position;
+
+/**
+ * @return 1/2 cot of the angle opposite every half-edge, from the face it belongs to
+ */
+static std::vector<float> halfCotangentsOf(const TriangleMesh& mesh) {
+    std::vector<float> halfCotangents(mesh.faceVertices.size());
+    parallelFor(0, mesh.faceVertices.size() / 3, [&](const FaceIndex begin, const FaceIndex end) {
+        for (EdgeId edgeId = 3 * begin; edgeId < 3 * end; edgeId++) {
+            const Cartesian3& opposite = mesh.vertices[mesh.faceVertices[TriangleMesh::nextIdInFace(edgeId)]];
+            const Cartesian3& tail = mesh.vertices[mesh.faceVertices[TriangleMesh::idToIndex(edgeId)]];
+            const Cartesian3& head = mesh.vertices[mesh.faceVertices[edgeId]];
+            const float ax = tail.x - opposite.x, ay = tail.y - opposite.y, az = tail.z - opposite.z;
+            const float bx = head.x - opposite.x, by = head.y - opposite.y, bz = head.z - opposite.z;
+            const float cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+            const float doubleArea = std::sqrt(cx * cx + cy * cy + cz * cz);
+            halfCotangents[edgeId] = doubleArea > 0.0f ? (ax * bx + ay * by + az * bz) / doubleArea / 2.0f : 0.0f;
+        }
+    });
+    return halfCotangents;
+}
+
+/**
+ * @return the valence of vertexId, 0 if its 1-ring walk runs into a boundary, which keeps it in place
+ */
+static unsigned int interiorValenceOf(const TriangleMesh& mesh, const VertexId vertexId) {
+    const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+    if (firstEdge == NO_VALUE) {
+        return 0;
+    }
+
+    unsigned int valence = 0;
+    EdgeId currentEdge = firstEdge;
+    do {
+        if (mesh.otherHalf[currentEdge] == NO_VALUE) {
+            return 0;
+        }
+        valence++;
+        currentEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[currentEdge]);
+    } while (currentEdge != firstEdge);
+    return valence;
+}
+
+/**
+ * @brief Counts the neighbours of every vertex, then fills its row from its 1-ring walk, both in parallel.
+ *        Each edge weighs the cotangents of the angles opposite it on either side, negative sums, from obtuse
+ *        triangles, being clamped so that vertices never move away from their neighbours
+ */
+LaplacianSmoothing::LaplacianSmoothing(const TriangleMesh& mesh, const SmoothingWeights weighting)
+    : neighbourStarts(mesh.vertices.size() + 1, 0) {
+    const unsigned int vertexCount = mesh.vertices.size();
+
+    parallelFor(0, vertexCount, [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            neighbourStarts[vertexId + 1] = interiorValenceOf(mesh, vertexId);
+        }
+    });
+    for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+        neighbourStarts[vertexId + 1] += neighbourStarts[vertexId];
+    }
+    neighbours.resize(neighbourStarts[vertexCount]);
+    weights.resize(neighbourStarts[vertexCount]);
+
+    const std::vector<float> halfCotangents =
+        weighting == SmoothingWeights::COTANGENT ? halfCotangentsOf(mesh) : std::vector<float>();
+
+    parallelFor(0, vertexCount, [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            const unsigned int first = neighbourStarts[vertexId];
+            const unsigned int valence = neighbourStarts[vertexId + 1] - first;
+            if (valence == 0) {
+                continue;
+            }
+
+            float weightSum = 0.0f;
+            EdgeId currentEdge = mesh.firstDirectedEdge[vertexId];
+            for (unsigned int i = first; i < first + valence; i++) {
+                const EdgeId otherEdge = mesh.otherHalf[currentEdge];
+                neighbours[i] = mesh.faceVertices[currentEdge];
+                weights[i] = weighting == SmoothingWeights::COTANGENT
+                                 ? std::max(halfCotangents[currentEdge] + halfCotangents[otherEdge], 0.0f)
+                                 : 1.0f;
+                weightSum += weights[i];
+                currentEdge = TriangleMesh::nextIdInFace(otherEdge);
+            }
+
+            // every cotangent clamped, e.g. around a needle, falls back to uniform weights
+            for (unsigned int i = first; i < first + valence; i++) {
+                weights[i] = weightSum > 0.0f ? weights[i] / weightSum : 1.0f / valence;
+            }
+        }
+    });
+}
+
+void LaplacianSmoothing::smooth(TriangleMesh& mesh, const unsigned int iterations, const float lambda) const {
+    iterate(mesh, iterations, {lambda});
+}
+
+/**
+ * @brief After Taubin, "A signal processing approach to fair surface design": frequencies below passBand
+ *        are let through, 1 / lambda + 1 / mu = passBand
+ */
+void LaplacianSmoothing::smoothTaubin(TriangleMesh& mesh, const unsigned int iterations, const float lambda,
+                                      const float passBand) const {
+    const float mu = 1.0f / (passBand - 1.0f / lambda);
+    iterate(mesh, iterations, {lambda, mu});
+}
+
+/**
+ * @brief Positions are copied into plain arrays once, so that iterations run on floats rather than Cartesian3,
+ *        & only copied back at the end. Normals & the centre are recomputed in full, as every vertex moved
+ */
+void LaplacianSmoothing::iterate(TriangleMesh& mesh, const unsigned int iterations,
+                                 const std::vector<float>& factors) const {
+    const unsigned int vertexCount = mesh.vertices.size();
+    if (iterations == 0 || neighbourStarts.size() != vertexCount + 1) {
+        return;
+    }
+
+    std::vector<Position> current(vertexCount);
+    std::vector<Position> next(vertexCount);
+    parallelFor(0, vertexCount, [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            current[vertexId] = {mesh.vertices[vertexId].x, mesh.vertices[vertexId].y, mesh.vertices[vertexId].z};
+        }
+    });
+
+    for (unsigned int iteration = 0; iteration < iterations; iteration++) {
+        for (const float factor : factors) {
+            parallelFor(0, vertexCount, [&](const VertexId begin, const VertexId end) {
+                for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+                    Position average{0.0f, 0.0f, 0.0f};
+                    for (unsigned int i = neighbourStarts[vertexId]; i < neighbourStarts[vertexId + 1]; i++) {
+                        const Position& neighbour = current[neighbours[i]];
+                        average[0] += weights[i] * neighbour[0];
+                        average[1] += weights[i] * neighbour[1];
+                        average[2] += weights[i] * neighbour[2];
+                    }
+
+                    const Position& position = current[vertexId];
+                    if (neighbourStarts[vertexId] == neighbourStarts[vertexId + 1]) {
+                        next[vertexId] = position;
+                        continue;
+                    }
+                    next[vertexId] = {position[0] + factor * (average[0] - position[0]),
+                                      position[1] + factor * (average[1] - position[1]),
+                                      position[2] + factor * (average[2] - position[2])};
+                }
+            });
+            current.swap(next);
+        }
+    }
+
+    parallelFor(0, vertexCount, [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            mesh.vertices[vertexId] = Cartesian3(current[vertexId][0], current[vertexId][1], current[vertexId][2]);
+        }
+    });
+
+    mesh.computeNormals();
+    mesh.computeCentreOfGravity();
+}
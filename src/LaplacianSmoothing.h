@@ -0,0 +1,49 @@
+#ifndef LAPLACIAN_SMOOTHING_H
+#define LAPLACIAN_SMOOTHING_H
+
+#include <vector>
+
+#include "TriangleMesh.h"
+
+// how the neighbours of a vertex weigh in the average it is moved towards
+enum class SmoothingWeights {
+    // every neighbour alike, which also evens out the sampling of the surface
+    UNIFORM,
+    // by the cotangents of the angles opposite each edge, clamped at 0, which moves vertices along the normal
+    // rather than within the surface
+    COTANGENT
+};
+
+/**
+ * Laplacian & Taubin lambda/mu smoothing of the vertices of a TriangleMesh, as Jacobi iterations:
+ * every vertex moves towards the weighted average of its neighbours at the start of the iteration,
+ * concurrently, reading & writing alternate position buffers.
+ *
+ * Neighbours & weights are gathered from the 1-rings once, when the object is built, & kept in compressed
+ * rows, so that iterations only stream through them. Cotangent weights are those of the mesh at that time.
+ * Vertices on a boundary stay where they are.
+ */
+class LaplacianSmoothing {
+    // the neighbours of vertex v are [neighbourStarts[v], neighbourStarts[v + 1]) of neighbours & weights,
+    // the weights of a vertex summing to 1
+    std::vector<unsigned int> neighbourStarts;
+    std::vector<VertexId> neighbours;
+    std::vector<float> weights;
+
+public:
+    LaplacianSmoothing(const TriangleMesh& mesh, SmoothingWeights weighting);
+
+    // iterations steps moving every vertex by lambda, in (0, 1], of the way to the average of its neighbours.
+    // Shrinks the mesh as it smooths it
+    void smooth(TriangleMesh& mesh, unsigned int iterations, float lambda) const;
+
+    // iterations pairs of steps by lambda then mu, negative & larger than lambda, so that high frequencies
+    // are damped while the low ones, & with them the volume, are kept. mu follows from lambda & passBand
+    void smoothTaubin(TriangleMesh& mesh, unsigned int iterations, float lambda, float passBand = 0.1f) const;
+
+private:
+    // runs iterations rounds of a step by each of factors, then brings normals & the centre up to date
+    void iterate(TriangleMesh& mesh, unsigned int iterations, const std::vector<float>& factors) const;
+};
+
+#endif
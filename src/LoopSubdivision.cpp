@@ -0,0 +1,164 @@
+#include "LoopSubdivision.h"
+
+#include <cmath>
+
+constexpr float NEAR_NEIGHBOUR_WEIGHT = 0.375f; // 3 / 8
+constexpr float FAR_NEIGHBOUR_WEIGHT = 0.125f; // 1 / 8
+
+constexpr float N_3_ALPHA = 0.1875f; // 3 / 16
+
+/**
+ * @brief Numbers the fulledges of the parent in half-edge order
+ *
+ * The fulledge of a pair of half-edges is numbered when its lowest half-edge is visited,
+ * so the higher half-edge simply copies the number of its other half.
+ */
+unsigned int numberFulledges(const HalfedgeView& parent,
+                             const EdgeId begin, const EdgeId end,
+                             unsigned int fulledgeCount,
+                             unsigned int* fulledges) {
+    for (EdgeId edgeId = begin; edgeId < end; edgeId++) {
+        const EdgeId otherEdgeId = parent.otherHalf[edgeId];
+
+        fulledges[edgeId] = edgeId < otherEdgeId ? fulledgeCount++ : fulledges[otherEdgeId];
+    }
+
+    return fulledgeCount;
+}
+
+/**
+ * @brief Splits each parent face [v0, v1, v2] into 4 child faces
+ *
+ * With vc_i the edge vertex of half-edge 3 * face + i, i.e. [v_(i-1) -> v_i], the children are:
+ *      - central face: face -> [vc0, vc1, vc2]
+ *      - adjacent faces: F + 3 * face + i -> [v_i, vc_(i+1), vc_i]
+ *
+ * Other halves never need a search:
+ *      - central half-edges pair with slot 2 of the adjacent faces of the same parent
+ *      - adjacent slots 0 & 1 pair with the adjacent faces across the parent otherHalf
+ */
+void subdivideFaces(const HalfedgeView& parent,
+                    const unsigned int* fulledges,
+                    const FaceIndex begin, const FaceIndex end,
+                    VertexId* childFaceVertices,
+                    EdgeId* childOtherHalf) {
+    const unsigned int faceCount = parent.halfEdgeCount / 3;
+
+    for (FaceIndex face = begin; face < end; face++) {
+        const EdgeId firstEdge = 3 * face;
+
+        VertexId edgeVertices[3];
+        for (unsigned int i = 0; i < 3; i++) {
+            edgeVertices[i] = parent.vertexCount + fulledges[firstEdge + i];
+        }
+
+        // central face
+        for (unsigned int i = 0; i < 3; i++) {
+            childFaceVertices[firstEdge + i] = edgeVertices[i];
+            childOtherHalf[firstEdge + i] = 3 * (faceCount + firstEdge + (i + 2) % 3) + 2;
+        }
+
+        // adjacent faces
+        for (unsigned int i = 0; i < 3; i++) {
+            const EdgeId adjacentEdge = 3 * (faceCount + firstEdge + i);
+
+            childFaceVertices[adjacentEdge] = parent.faceVertices[firstEdge + i];
+            childFaceVertices[adjacentEdge + 1] = edgeVertices[(i + 1) % 3];
+            childFaceVertices[adjacentEdge + 2] = edgeVertices[i];
+
+            // [vc_i -> v_i] pairs with [v_i -> vc_i] across [v_(i-1) -> v_i]
+            const EdgeId incoming = parent.otherHalf[firstEdge + i];
+            childOtherHalf[adjacentEdge] = 3 * (faceCount + 3 * (incoming / 3) + (incoming + 2) % 3) + 1;
+
+            // [v_i -> vc_(i+1)] pairs with [vc_(i+1) -> v_i] across [v_i -> v_(i+1)]
+            const EdgeId outgoing = parent.otherHalf[firstEdge + (i + 1) % 3];
+            childOtherHalf[adjacentEdge + 1] = 3 * (faceCount + outgoing);
+
+            // [vc_(i+1) -> vc_i] pairs with the central face
+            childOtherHalf[adjacentEdge + 2] = firstEdge + (i + 1) % 3;
+        }
+    }
+}
+
+void subdivideEdges(const HalfedgeView& parent,
+                    const unsigned int* fulledges,
+                    const EdgeId begin, const EdgeId end,
+                    EdgeId* childFirstDirectedEdge,
+                    Cartesian3* childVertices) {
+    for (EdgeId halfEdge = begin; halfEdge < end; halfEdge++) {
+        const EdgeId otherHalf = parent.otherHalf[halfEdge];
+
+        // Only the lowest half-edge of each fulledge emits its vertex
+        if (otherHalf < halfEdge) {
+            continue;
+        }
+
+        const VertexId edgeVertexId = parent.vertexCount + fulledges[halfEdge];
+
+        if (childFirstDirectedEdge != nullptr) {
+            // central half-edge [vc_i -> vc_(i+1)]
+            childFirstDirectedEdge[edgeVertexId] = TriangleMesh::nextIdInFace(halfEdge);
+        }
+
+        if (childVertices != nullptr) {
+            const VertexId v1 = parent.faceVertices[halfEdge];
+            const VertexId v2 = parent.faceVertices[TriangleMesh::idToIndex(halfEdge)];
+            const VertexId v3 = parent.faceVertices[TriangleMesh::nextIdInFace(halfEdge)];
+            const VertexId v4 = parent.faceVertices[TriangleMesh::nextIdInFace(otherHalf)];
+
+            childVertices[edgeVertexId] = NEAR_NEIGHBOUR_WEIGHT * (parent.vertices[v1] + parent.vertices[v2]) +
+                                          FAR_NEIGHBOUR_WEIGHT * (parent.vertices[v3] + parent.vertices[v4]);
+        }
+    }
+}
+
+void subdivideVertices(const HalfedgeView& parent,
+                       const VertexId begin, const VertexId end,
+                       EdgeId* childFirstDirectedEdge,
+                       Cartesian3* childVertices) {
+    const unsigned int faceCount = parent.halfEdgeCount / 3;
+
+    for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+        if (childFirstDirectedEdge != nullptr) {
+            // FDE[vertexId] leaves from slot idToIndex(FDE) of its face,
+            // so [v_i -> vc_(i+1)] of that adjacent face leaves from vertexId too
+            const EdgeId firstEdge = parent.firstDirectedEdge[vertexId];
+            const unsigned int slot = TriangleMesh::idToIndex(firstEdge) % 3;
+            childFirstDirectedEdge[vertexId] = 3 * (faceCount + 3 * (firstEdge / 3) + slot) + 1;
+        }
+
+        if (childVertices != nullptr) {
+            childVertices[vertexId] = centroidLerp(parent, vertexId);
+        }
+    }
+}
+
+/**
+ * @param mesh whose old neighbourhoods are used
+ * @param vertexId of the vertex
+ *
+ * @return the (x, y, z) resulting of lerping vertexId with its 1-ring neighbourhood
+ */
+Cartesian3 centroidLerp(const HalfedgeView& mesh, const VertexId vertexId) {
+    Cartesian3 neighbourhoodSum;
+    unsigned int n = 0;
+
+    // Same walk as TriangleMesh::visitNeighbourhoodOf, inlined to run over raw arrays
+    const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+    EdgeId currentEdge = firstEdge;
+    do {
+        neighbourhoodSum += mesh.vertices[mesh.faceVertices[currentEdge]];
+        n++;
+        currentEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[currentEdge]);
+    } while (currentEdge != firstEdge);
+
+    float alpha;
+
+    if (n == 3) {
+        alpha = N_3_ALPHA;
+    } else {
+        alpha = (0.625f - std::pow(0.375f + 0.25f * std::cos(2.0f * M_PI / n), 2.0f)) / n;
+    }
+
+    return (1.0f - n * alpha) * mesh.vertices[vertexId] + alpha * neighbourhoodSum;
+}
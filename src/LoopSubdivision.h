@@ -0,0 +1,50 @@
+#ifndef LOOP_SUBDIVISION_H
+#define LOOP_SUBDIVISION_H
+
+#include "TriangleMesh.h"
+
+/*
+ * Block kernels of one level of Loop subdivision.
+ *
+ * Every child array entry is a closed-form function of the parent arrays, so each kernel
+ * only writes the range it is given. This allows running them over a whole TriangleMesh
+ * or block by block over memory-mapped files.
+ *
+ * For a parent with V vertices, E half-edges and F = E / 3 faces, the child has:
+ *      - vertices: the V parent vertices, followed by one edge vertex per fulledge
+ *      - faces: the F central faces, followed by the 3 * F adjacent faces
+ */
+
+// Assigns fulledges[edgeId] for edgeId in [begin, end), given fulledgeCount fulledges
+// were already numbered in [0, begin). Returns the fulledge count up to end
+unsigned int numberFulledges(const HalfedgeView& parent,
+                             EdgeId begin, EdgeId end,
+                             unsigned int fulledgeCount,
+                             unsigned int* fulledges);
+
+// Writes the child faceVertices & otherHalf of the parent faces [begin, end)
+void subdivideFaces(const HalfedgeView& parent,
+                    const unsigned int* fulledges,
+                    FaceIndex begin, FaceIndex end,
+                    VertexId* childFaceVertices,
+                    EdgeId* childOtherHalf);
+
+// Writes the child firstDirectedEdge and/or position of the edge vertices
+// of the parent half-edges [begin, end). Either output may be nullptr
+void subdivideEdges(const HalfedgeView& parent,
+                    const unsigned int* fulledges,
+                    EdgeId begin, EdgeId end,
+                    EdgeId* childFirstDirectedEdge,
+                    Cartesian3* childVertices);
+
+// Writes the child firstDirectedEdge and/or position of the parent vertices [begin, end).
+// Either output may be nullptr
+void subdivideVertices(const HalfedgeView& parent,
+                       VertexId begin, VertexId end,
+                       EdgeId* childFirstDirectedEdge,
+                       Cartesian3* childVertices);
+
+// Loop's weighted average of vertexId and its 1-ring neighbourhood
+Cartesian3 centroidLerp(const HalfedgeView& mesh, VertexId vertexId);
+
+#endif
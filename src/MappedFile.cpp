@@ -0,0 +1,67 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path)
+    : fileDescriptor(open(path.c_str(), O_RDONLY)),
+      mapping(nullptr),
+      mappingSize(0),
+      writable(false) {
+    if (struct stat fileStatus{}; fileDescriptor >= 0 && fstat(fileDescriptor, &fileStatus) == 0) {
+        mappingSize = fileStatus.st_size;
+        map(PROT_READ);
+    }
+}
+
+MappedFile::MappedFile(const std::string& path, const uint64_t size)
+    : fileDescriptor(open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)),
+      mapping(nullptr),
+      mappingSize(size),
+      writable(true) {
+    if (fileDescriptor >= 0 && ftruncate(fileDescriptor, static_cast<off_t>(size)) == 0) {
+        map(PROT_READ | PROT_WRITE);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mapping != nullptr) {
+        if (writable) {
+            msync(mapping, mappingSize, MS_SYNC);
+        }
+        munmap(mapping, mappingSize);
+    }
+
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return mapping != nullptr;
+}
+
+uint64_t MappedFile::size() const {
+    return mappingSize;
+}
+
+void MappedFile::release() const {
+    if (mapping != nullptr) {
+        madvise(mapping, mappingSize, MADV_DONTNEED);
+    }
+}
+
+void MappedFile::map(const int protection) {
+    if (mappingSize == 0) {
+        return;
+    }
+
+    void* address = mmap(nullptr, mappingSize, protection, MAP_SHARED, fileDescriptor, 0);
+    if (address == MAP_FAILED) {
+        return;
+    }
+
+    mapping = static_cast<char*>(address);
+}
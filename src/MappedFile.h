@@ -0,0 +1,49 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * RAII wrapper over a POSIX memory-mapped file.
+ *
+ * Pages are only loaded when touched, and release() hands them back to the kernel,
+ * which keeps the resident memory of block-wise passes bounded by a single block.
+ */
+class MappedFile {
+    int fileDescriptor;
+    char* mapping;
+    uint64_t mappingSize;
+    bool writable;
+
+public:
+    // map an existing file for reading
+    explicit MappedFile(const std::string& path);
+
+    // create (or truncate) a file of the given size and map it for writing
+    MappedFile(const std::string& path, uint64_t size);
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    bool isOpen() const;
+
+    uint64_t size() const;
+
+    // typed access to the array starting at byte offset
+    template<typename T>
+    T* at(const uint64_t offset) const {
+        return reinterpret_cast<T*>(mapping + offset);
+    }
+
+    // drops every resident page, written pages stay in the page cache until written back
+    void release() const;
+
+private:
+    void map(int protection);
+};
+
+#endif
@@ -0,0 +1,455 @@
+#include "MeshCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+constexpr char COMPRESSED_MESH_MAGIC[8] = {'H', 'A', 'L', 'F', 'E', 'C', 'M', 'P'};
+constexpr uint32_t COMPRESSED_MESH_VERSION = 1;
+
+// sections are read this much at a time, so that a corrupt size fails at the end of the file, not in an allocation
+constexpr size_t SECTION_CHUNK_SIZE = 1 << 20;
+
+struct CompressedMeshHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t faceCount;
+    uint32_t quantisationBits;
+    // closed meshes skip the gate/boundary bit of every edge
+    uint32_t hasBoundary;
+    uint32_t reserved;
+    float min[3];
+    float max[3];
+};
+
+typedef std::array<int64_t, 3> QuantisedPosition;
+
+// Appends bits & variable length integers (LEB128) to a byte buffer
+class ByteWriter {
+    unsigned int bitCount = 0;
+
+public:
+    std::vector<uint8_t> bytes;
+
+    void putBit(const bool bit) {
+        if (bitCount % 8 == 0) {
+            bytes.push_back(0);
+        }
+        bytes.back() |= static_cast<uint8_t>(bit) << (bitCount % 8);
+        bitCount++;
+    }
+
+    void putUnsigned(uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void putSigned(const int64_t value) {
+        // zig-zag, so that small negative values stay short
+        putUnsigned(static_cast<uint64_t>(value) << 1 ^ static_cast<uint64_t>(value >> 63));
+    }
+};
+
+// Reads back what ByteWriter wrote, failing softly past the end of the buffer
+class ByteReader {
+    const std::vector<uint8_t>& bytes;
+    size_t position = 0;
+    unsigned int bitCount = 0;
+
+public:
+    bool overrun = false;
+
+    explicit ByteReader(const std::vector<uint8_t>& bytes)
+        : bytes(bytes) {
+    }
+
+    bool getBit() {
+        if (bitCount / 8 >= bytes.size()) {
+            overrun = true;
+            return false;
+        }
+        const bool bit = bytes[bitCount / 8] >> (bitCount % 8) & 1;
+        bitCount++;
+        return bit;
+    }
+
+    uint64_t getUnsigned() {
+        uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (position >= bytes.size()) {
+                overrun = true;
+                return 0;
+            }
+            const uint8_t byte = bytes[position++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    int64_t getSigned() {
+        const uint64_t value = getUnsigned();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+};
+
+static void writeSection(std::ostream& stream, const ByteWriter& section) {
+    const uint64_t size = section.bytes.size();
+    stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    stream.write(reinterpret_cast<const char*>(section.bytes.data()), static_cast<std::streamsize>(size));
+}
+
+static bool readSection(std::istream& stream, std::vector<uint8_t>& section) {
+    uint64_t size;
+    if (!stream.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+        return false;
+    }
+    section.clear();
+    while (section.size() < size) {
+        const size_t offset = section.size();
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - offset, SECTION_CHUNK_SIZE));
+        section.resize(offset + chunk);
+        if (!stream.read(reinterpret_cast<char*>(section.data() + offset), static_cast<std::streamsize>(chunk))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static QuantisedPosition operator +(const QuantisedPosition& left, const QuantisedPosition& right) {
+    return {left[0] + right[0], left[1] + right[1], left[2] + right[2]};
+}
+
+static QuantisedPosition operator -(const QuantisedPosition& left, const QuantisedPosition& right) {
+    return {left[0] - right[0], left[1] - right[1], left[2] - right[2]};
+}
+
+/**
+ * @brief Encodes faces in breadth-first order, mirroring exactly what readCompressedMesh rebuilds
+ *
+ * Each queued face remembers the slot of its original half-edges that becomes its decoded slot 0,
+ * so that edges are visited in the decoder's order. A gate face across [u -> v] is decoded
+ * as [v, u, w], w being its third vertex.
+ */
+void writeCompressedMesh(const TriangleMesh& mesh, std::ostream& stream, const unsigned int quantisationBits) {
+    const unsigned int bits = std::clamp(quantisationBits, 1u, 31u);
+    const unsigned int faceCount = mesh.faceVertices.size() / 3;
+
+    CompressedMeshHeader header{};
+    std::memcpy(header.magic, COMPRESSED_MESH_MAGIC, sizeof(header.magic));
+    header.version = COMPRESSED_MESH_VERSION;
+    header.vertexCount = mesh.vertices.size();
+    header.faceCount = faceCount;
+    header.quantisationBits = bits;
+    header.hasBoundary = std::find(mesh.otherHalf.begin(), mesh.otherHalf.end(), NO_VALUE) != mesh.otherHalf.end();
+
+    for (int axis = 0; axis < 3; axis++) {
+        header.min[axis] = mesh.vertices.empty() ? 0.0f : mesh.vertices.front()[axis];
+        header.max[axis] = header.min[axis];
+    }
+    for (const auto& vertex : mesh.vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            header.min[axis] = std::min(header.min[axis], vertex[axis]);
+            header.max[axis] = std::max(header.max[axis], vertex[axis]);
+        }
+    }
+
+    const double steps = static_cast<double>((1u << bits) - 1);
+    std::vector<QuantisedPosition> quantised(mesh.vertices.size());
+    for (VertexId vertexId = 0; vertexId < mesh.vertices.size(); vertexId++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const double extent = header.max[axis] - header.min[axis];
+            quantised[vertexId][axis] = extent > 0.0
+                                            ? std::llround((mesh.vertices[vertexId][axis] - header.min[axis]) / extent * steps)
+                                            : 0;
+        }
+    }
+
+    ByteWriter symbols;
+    ByteWriter references;
+    ByteWriter positions;
+
+    std::vector<VertexId> newId(mesh.vertices.size(), NO_VALUE);
+    VertexId nextId = 0;
+    QuantisedPosition previous{0, 0, 0};
+
+    const auto emitVertex = [&](const VertexId vertexId, const QuantisedPosition& predicted) {
+        newId[vertexId] = nextId++;
+        const QuantisedPosition residual = quantised[vertexId] - predicted;
+        for (int axis = 0; axis < 3; axis++) {
+            positions.putSigned(residual[axis]);
+        }
+        previous = quantised[vertexId];
+    };
+
+    // <original face, original slot of decoded slot 0>
+    std::vector<std::pair<FaceIndex, unsigned int>> queue;
+    queue.reserve(faceCount);
+    std::vector<bool> queued(faceCount, false);
+
+    for (FaceIndex start = 0; start < faceCount; start++) {
+        if (queued[start]) {
+            continue;
+        }
+
+        // new component: its first face is coded explicitly
+        queued[start] = true;
+        queue.emplace_back(start, 0);
+        for (unsigned int slot = 0; slot < 3; slot++) {
+            const VertexId vertexId = mesh.faceVertices[3 * start + slot];
+            if (newId[vertexId] == NO_VALUE) {
+                references.putUnsigned(0);
+                emitVertex(vertexId, previous);
+            } else {
+                references.putUnsigned(nextId - newId[vertexId]);
+            }
+        }
+
+        for (size_t head = queue.size() - 1; head < queue.size(); head++) {
+            const auto [face, firstSlot] = queue[head];
+
+            for (unsigned int slot = 0; slot < 3; slot++) {
+                const EdgeId edgeId = 3 * face + (firstSlot + slot) % 3;
+                const EdgeId otherEdgeId = mesh.otherHalf[edgeId];
+
+                if (otherEdgeId == NO_VALUE) {
+                    symbols.putBit(false);
+                    continue;
+                }
+
+                // the decoder finds the other half already linked
+                const FaceIndex gateFace = otherEdgeId / 3;
+                if (queued[gateFace]) {
+                    continue;
+                }
+
+                if (header.hasBoundary) {
+                    symbols.putBit(true);
+                }
+
+                queued[gateFace] = true;
+                queue.emplace_back(gateFace, (otherEdgeId + 2) % 3);
+
+                const VertexId u = mesh.faceVertices[TriangleMesh::idToIndex(edgeId)];
+                const VertexId v = mesh.faceVertices[edgeId];
+                const VertexId c = mesh.faceVertices[TriangleMesh::nextIdInFace(edgeId)];
+                const VertexId w = mesh.faceVertices[TriangleMesh::nextIdInFace(otherEdgeId)];
+
+                if (newId[w] == NO_VALUE) {
+                    symbols.putBit(true);
+                    // parallelogram rule across the gate
+                    emitVertex(w, quantised[u] + quantised[v] - quantised[c]);
+                } else {
+                    symbols.putBit(false);
+                    references.putUnsigned(nextId - newId[w]);
+                }
+            }
+        }
+    }
+
+    // vertices in no face
+    references.putUnsigned(std::count(newId.begin(), newId.end(), NO_VALUE));
+    for (VertexId vertexId = 0; vertexId < mesh.vertices.size(); vertexId++) {
+        if (newId[vertexId] == NO_VALUE) {
+            emitVertex(vertexId, previous);
+        }
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeSection(stream, symbols);
+    writeSection(stream, references);
+    writeSection(stream, positions);
+}
+
+/**
+ * @brief Replays the traversal of writeCompressedMesh
+ *
+ * Faces are created in queue order, so the queue is the face array itself. Other halves are linked
+ * as faces are created, through a map of the directed edges still waiting for theirs.
+ *
+ * Nothing read is trusted: counts are bounded by the bytes that would code them before anything is allocated,
+ * back-references & positions are range checked as they are decoded, & the result is validated.
+ */
+bool readCompressedMesh(std::istream& stream, TriangleMesh& mesh) {
+    CompressedMeshHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, COMPRESSED_MESH_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COMPRESSED_MESH_VERSION ||
+        header.quantisationBits < 1 || header.quantisationBits > 31) {
+        return false;
+    }
+
+    std::vector<uint8_t> symbolBytes, referenceBytes, positionBytes;
+    if (!readSection(stream, symbolBytes) || !readSection(stream, referenceBytes) ||
+        !readSection(stream, positionBytes)) {
+        return false;
+    }
+
+    // every face but the first of a component costs at least a symbol bit, the first 3 references,
+    // & every vertex at least a byte per coordinate
+    const uint64_t halfEdgeCount = uint64_t{header.faceCount} * 3;
+    if (header.faceCount > 8 * uint64_t{symbolBytes.size()} + referenceBytes.size() / 3 ||
+        header.vertexCount > positionBytes.size() / 3 || halfEdgeCount >= NO_VALUE) {
+        return false;
+    }
+
+    ByteReader symbols(symbolBytes);
+    ByteReader references(referenceBytes);
+    ByteReader positions(positionBytes);
+    bool isCorrupt = false;
+
+    const int64_t steps = (int64_t{1} << header.quantisationBits) - 1;
+    std::vector<QuantisedPosition> quantised;
+    quantised.reserve(header.vertexCount);
+    mesh.faceVertices.assign(halfEdgeCount, NO_VALUE);
+    mesh.otherHalf.assign(halfEdgeCount, NO_VALUE);
+
+    QuantisedPosition previous{0, 0, 0};
+    const auto decodeVertex = [&](const QuantisedPosition& predicted) -> VertexId {
+        QuantisedPosition position = predicted;
+        for (int axis = 0; axis < 3; axis++) {
+            position[axis] += positions.getSigned();
+            // the encoder quantises into the bounding box
+            if (position[axis] < 0 || position[axis] > steps) {
+                isCorrupt = true;
+                position[axis] = 0;
+            }
+        }
+        quantised.push_back(position);
+        previous = position;
+        return quantised.size() - 1;
+    };
+    // the vertex reference vertices back, decoded so far, 0 for none if reference is out of range
+    const auto backReference = [&](const uint64_t reference) -> VertexId {
+        if (reference == 0 || reference > quantised.size()) {
+            isCorrupt = true;
+            return 0;
+        }
+        return quantised.size() - reference;
+    };
+    const auto referencedVertex = [&]() -> VertexId {
+        const uint64_t reference = references.getUnsigned();
+        return reference == 0 ? decodeVertex(previous) : backReference(reference);
+    };
+
+    // (from << 32 | to) -> half-edge [from -> to] without other half yet
+    std::unordered_map<uint64_t, EdgeId> openEdges;
+    openEdges.reserve(halfEdgeCount / 4);
+
+    FaceIndex faceCount = 0;
+    const auto createFace = [&](const std::array<VertexId, 3>& face) {
+        const EdgeId firstEdge = 3 * faceCount++;
+        for (unsigned int slot = 0; slot < 3; slot++) {
+            mesh.faceVertices[firstEdge + slot] = face[slot];
+        }
+
+        for (unsigned int slot = 0; slot < 3; slot++) {
+            const uint64_t from = face[(slot + 2) % 3];
+            const uint64_t to = face[slot];
+
+            if (const auto other = openEdges.find(to << 32 | from); other != openEdges.end()) {
+                mesh.otherHalf[firstEdge + slot] = other->second;
+                mesh.otherHalf[other->second] = firstEdge + slot;
+                openEdges.erase(other);
+            } else {
+                openEdges.emplace(from << 32 | to, firstEdge + slot);
+            }
+        }
+    };
+
+    for (FaceIndex head = 0; faceCount < header.faceCount; head++) {
+        if (head == faceCount) {
+            const VertexId p = referencedVertex();
+            const VertexId q = referencedVertex();
+            const VertexId r = referencedVertex();
+            if (isCorrupt) {
+                return false;
+            }
+            createFace({p, q, r});
+        }
+
+        for (unsigned int slot = 0; slot < 3 && faceCount < header.faceCount; slot++) {
+            const EdgeId edgeId = 3 * head + slot;
+            if (mesh.otherHalf[edgeId] != NO_VALUE || (header.hasBoundary && !symbols.getBit())) {
+                continue;
+            }
+
+            const VertexId u = mesh.faceVertices[TriangleMesh::idToIndex(edgeId)];
+            const VertexId v = mesh.faceVertices[edgeId];
+            const VertexId c = mesh.faceVertices[TriangleMesh::nextIdInFace(edgeId)];
+
+            const VertexId w = symbols.getBit()
+                                   ? decodeVertex(quantised[u] + quantised[v] - quantised[c])
+                                   : backReference(references.getUnsigned());
+            createFace({v, u, w});
+        }
+
+        if (isCorrupt || symbols.overrun || references.overrun || positions.overrun ||
+            quantised.size() > header.vertexCount) {
+            return false;
+        }
+    }
+
+    const uint64_t isolatedVertices = references.getUnsigned();
+    if (isolatedVertices > header.vertexCount - quantised.size()) {
+        return false;
+    }
+    for (uint64_t isolated = 0; isolated < isolatedVertices; isolated++) {
+        decodeVertex(previous);
+    }
+
+    if (isCorrupt || references.overrun || positions.overrun || quantised.size() != header.vertexCount) {
+        return false;
+    }
+
+    mesh.vertices.resize(quantised.size());
+    for (VertexId vertexId = 0; vertexId < quantised.size(); vertexId++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const double extent = header.max[axis] - header.min[axis];
+            mesh.vertices[vertexId][axis] =
+                static_cast<float>(header.min[axis] + quantised[vertexId][axis] / static_cast<double>(steps) * extent);
+        }
+    }
+
+    mesh.firstDirectedEdge.assign(mesh.vertices.size(), NO_VALUE);
+    for (EdgeId edgeId = 0; edgeId < halfEdgeCount; edgeId++) {
+        if (const VertexId from = mesh.faceVertices[TriangleMesh::idToIndex(edgeId)];
+            mesh.firstDirectedEdge[from] == NO_VALUE) {
+            mesh.firstDirectedEdge[from] = edgeId;
+        }
+    }
+
+    // quantisation may flatten the tiniest faces of a valid mesh, which only cost them their normal,
+    // & pinched vertices are read from the other formats too
+    std::vector<MeshDefect> defects = mesh.validate();
+    defects.erase(std::remove_if(defects.begin(), defects.end(), [&](const MeshDefect& defect) {
+        if (defect.kind == MeshDefect::NON_MANIFOLD_VERTEX) {
+            return true;
+        }
+        if (defect.kind != MeshDefect::DEGENERATE_FACE) {
+            return false;
+        }
+        const VertexId* corners = &mesh.faceVertices[3 * defect.element];
+        return corners[0] != corners[1] && corners[1] != corners[2] && corners[2] != corners[0];
+    }), defects.end());
+    if (!defects.empty()) {
+        std::cerr << "Malformed compressed mesh:" << std::endl;
+        TriangleMesh::printDefects(defects, std::cerr);
+        return false;
+    }
+
+    mesh.computeNormals();
+    mesh.computeCentreOfGravity();
+    mesh.computeFulledges();
+
+    return true;
+}
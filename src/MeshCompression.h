@@ -0,0 +1,26 @@
+#ifndef MESH_COMPRESSION_H
+#define MESH_COMPRESSION_H
+
+#include <iostream>
+
+#include "TriangleMesh.h"
+
+/*
+ * .hec files store a TriangleMesh compactly for archival.
+ *
+ * Connectivity is coded by a breadth-first traversal of the faces, in the spirit of Edgebreaker:
+ * every face is reached through a gate edge of an already coded face, so it costs one bit telling
+ * whether its third vertex is new, plus a short back-reference when it is not.
+ * Positions are quantised within the bounding box and predicted with the parallelogram rule
+ * across the gate edge, so only small residuals are stored.
+ *
+ * otherHalf, firstDirectedEdge & normals are not stored, the decoder rebuilds them in linear time.
+ * The decoded mesh is the same surface, with vertices & faces numbered in traversal order.
+ */
+
+void writeCompressedMesh(const TriangleMesh& mesh, std::ostream& stream, unsigned int quantisationBits = 16);
+
+// returns whether the read was successful
+bool readCompressedMesh(std::istream& stream, TriangleMesh& mesh);
+
+#endif
@@ -0,0 +1,203 @@
+#include "MeshCurvature.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Parallel.h"
+
+// relative to the cube of its trace, below which the determinant of the fit leaves the directions undetermined,
+// e.g. at vertices of valence 3 or with neighbours all along 2 lines
+constexpr double SINGULAR_FIT = 1e-9;
+
+typedef std::array<double, 3> Vector;
+
+static Vector vectorOf(const Cartesian3& point) {
+    return {point.x, point.y, point.z};
+}
+
+static Vector difference(const Vector& a, const Vector& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static Vector cross(const Vector& a, const Vector& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+static double dot(const Vector& a, const Vector& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static Vector scaled(const Vector& a, const double factor) {
+    return {a[0] * factor, a[1] * factor, a[2] * factor};
+}
+
+static Cartesian3 cartesianOf(const Vector& a) {
+    return Cartesian3(a[0], a[1], a[2]);
+}
+
+/**
+ * @brief Walks the 1-ring of vertexId once for the curvatures, each face contributing its angle, cotangents
+ *        & share of the mixed area, then once more to fit the second fundamental form in the tangent plane
+ *        to the normal curvature along every edge
+ */
+static void computeVertexCurvature(const TriangleMesh& mesh, const VertexId vertexId, MeshCurvature& curvature) {
+    const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+    if (firstEdge == NO_VALUE) {
+        return;
+    }
+
+    const Vector position = vectorOf(mesh.vertices[vertexId]);
+    // sum of the cotangent weighted edges towards vertexId, 2 mixed areas times the mean curvature normal
+    Vector laplacian{0.0, 0.0, 0.0};
+    Vector normal{0.0, 0.0, 0.0};
+    double mixedArea = 0.0;
+    double angleSum = 0.0;
+
+    EdgeId currentEdge = firstEdge;
+    do {
+        if (mesh.otherHalf[currentEdge] == NO_VALUE) {
+            return;
+        }
+
+        const Vector toHead = difference(vectorOf(mesh.vertices[mesh.faceVertices[currentEdge]]), position);
+        const Vector toThird =
+            difference(vectorOf(mesh.vertices[mesh.faceVertices[TriangleMesh::nextIdInFace(currentEdge)]]), position);
+        const Vector opposite = difference(toThird, toHead);
+        const Vector faceNormal = cross(toHead, toThird);
+        const double doubleArea = std::sqrt(dot(faceNormal, faceNormal));
+
+        if (doubleArea > 0.0) {
+            const double cornerDot = dot(toHead, toThird);
+            const double headDot = -dot(toHead, opposite);
+            const double thirdDot = dot(toThird, opposite);
+            const double headCotangent = headDot / doubleArea;
+            const double thirdCotangent = thirdDot / doubleArea;
+
+            for (unsigned int axis = 0; axis < 3; axis++) {
+                laplacian[axis] -= thirdCotangent * toHead[axis] + headCotangent * toThird[axis];
+                normal[axis] += faceNormal[axis];
+            }
+            angleSum += std::atan2(doubleArea, cornerDot);
+
+            // the Voronoi region inside the face, unless it is obtuse, when it is cut down to the face
+            if (cornerDot < 0.0) {
+                mixedArea += doubleArea / 4.0;
+            } else if (headDot < 0.0 || thirdDot < 0.0) {
+                mixedArea += doubleArea / 8.0;
+            } else {
+                mixedArea += (dot(toHead, toHead) * thirdCotangent + dot(toThird, toThird) * headCotangent) / 8.0;
+            }
+        }
+
+        currentEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[currentEdge]);
+    } while (currentEdge != firstEdge);
+
+    const double normalLength = std::sqrt(dot(normal, normal));
+    if (mixedArea <= 0.0 || normalLength <= 0.0) {
+        return;
+    }
+    normal = scaled(normal, 1.0 / normalLength);
+
+    const double mean = dot(laplacian, normal) / (4.0 * mixedArea);
+    const double gaussian = (2.0 * M_PI - angleSum) / mixedArea;
+    const double spread = std::sqrt(std::max(mean * mean - gaussian, 0.0));
+    curvature.meanCurvatures[vertexId] = mean;
+    curvature.gaussianCurvatures[vertexId] = gaussian;
+    curvature.minimumCurvatures[vertexId] = mean - spread;
+    curvature.maximumCurvatures[vertexId] = mean + spread;
+
+    // tangent basis from the axis farthest from the normal
+    unsigned int axis = 0;
+    for (unsigned int other = 1; other < 3; other++) {
+        if (std::abs(normal[other]) < std::abs(normal[axis])) {
+            axis = other;
+        }
+    }
+    Vector unitAxis{0.0, 0.0, 0.0};
+    unitAxis[axis] = 1.0;
+    Vector u = cross(normal, unitAxis);
+    u = scaled(u, 1.0 / std::sqrt(dot(u, u)));
+    const Vector v = cross(normal, u);
+
+    // normal equations of a u^2 + 2 b u v + c v^2 = normal curvature along each edge, (u, v) its unit tangent
+    std::array<double, 6> normalMatrix{0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    std::array<double, 3> rightHandSide{0.0, 0.0, 0.0};
+    do {
+        const Vector toHead = difference(vectorOf(mesh.vertices[mesh.faceVertices[currentEdge]]), position);
+        const double squaredLength = dot(toHead, toHead);
+        // coordinates of the projection of the edge onto the tangent plane
+        const double tangentU = dot(toHead, u);
+        const double tangentV = dot(toHead, v);
+        const double squaredTangent = tangentU * tangentU + tangentV * tangentV;
+
+        if (squaredLength > 0.0 && squaredTangent > 0.0) {
+            const std::array<double, 3> row = {tangentU * tangentU / squaredTangent,
+                                               2.0 * tangentU * tangentV / squaredTangent,
+                                               tangentV * tangentV / squaredTangent};
+            const double normalCurvature = -2.0 * dot(toHead, normal) / squaredLength;
+
+            normalMatrix[0] += row[0] * row[0];
+            normalMatrix[1] += row[0] * row[1];
+            normalMatrix[2] += row[0] * row[2];
+            normalMatrix[3] += row[1] * row[1];
+            normalMatrix[4] += row[1] * row[2];
+            normalMatrix[5] += row[2] * row[2];
+            for (unsigned int i = 0; i < 3; i++) {
+                rightHandSide[i] += row[i] * normalCurvature;
+            }
+        }
+
+        currentEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[currentEdge]);
+    } while (currentEdge != firstEdge);
+
+    // Cramer's rule on the symmetric 3x3 system, packed as its upper triangle
+    const double m00 = normalMatrix[0], m01 = normalMatrix[1], m02 = normalMatrix[2];
+    const double m11 = normalMatrix[3], m12 = normalMatrix[4], m22 = normalMatrix[5];
+    const double cofactor00 = m11 * m22 - m12 * m12;
+    const double cofactor01 = m02 * m12 - m01 * m22;
+    const double cofactor02 = m01 * m12 - m02 * m11;
+    const double determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02;
+    const double trace = m00 + m11 + m22;
+
+    // (u, v) coordinates of the eigenvector of [a b; b c] with the greater eigenvalue, u when undetermined
+    double directionU = 1.0;
+    double directionV = 0.0;
+    if (determinant > SINGULAR_FIT * trace * trace * trace) {
+        const double r0 = rightHandSide[0], r1 = rightHandSide[1], r2 = rightHandSide[2];
+        const double a = (cofactor00 * r0 + cofactor01 * r1 + cofactor02 * r2) / determinant;
+        const double b = (cofactor01 * r0 + (m00 * m22 - m02 * m02) * r1 + (m01 * m02 - m00 * m12) * r2) / determinant;
+        const double c = (cofactor02 * r0 + (m01 * m02 - m00 * m12) * r1 + (m00 * m11 - m01 * m01) * r2) / determinant;
+
+        // from whichever row of [a - eigenvalue, b; b, c - eigenvalue] is farther from 0, for stability
+        const double halfGap = (a - c) / 2.0;
+        const double root = std::sqrt(halfGap * halfGap + b * b);
+        if (root > 0.0) {
+            directionU = halfGap >= 0.0 ? halfGap + root : b;
+            directionV = halfGap >= 0.0 ? b : root - halfGap;
+            const double length = std::sqrt(directionU * directionU + directionV * directionV);
+            directionU /= length;
+            directionV /= length;
+        }
+    }
+
+    const Vector maximumDirection = {directionU * u[0] + directionV * v[0],
+                                     directionU * u[1] + directionV * v[1],
+                                     directionU * u[2] + directionV * v[2]};
+    curvature.maximumDirections[vertexId] = cartesianOf(maximumDirection);
+    curvature.minimumDirections[vertexId] = cartesianOf(cross(normal, maximumDirection));
+}
+
+MeshCurvature::MeshCurvature(const TriangleMesh& mesh)
+    : meanCurvatures(mesh.vertices.size(), 0.0f),
+      gaussianCurvatures(mesh.vertices.size(), 0.0f),
+      minimumCurvatures(mesh.vertices.size(), 0.0f),
+      maximumCurvatures(mesh.vertices.size(), 0.0f),
+      maximumDirections(mesh.vertices.size(), Cartesian3(0.0f, 0.0f, 0.0f)),
+      minimumDirections(mesh.vertices.size(), Cartesian3(0.0f, 0.0f, 0.0f)) {
+    parallelFor(0, mesh.vertices.size(), [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            computeVertexCurvature(mesh, vertexId, *this);
+        }
+    });
+}
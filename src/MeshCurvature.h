@@ -0,0 +1,33 @@
+#ifndef MESH_CURVATURE_H
+#define MESH_CURVATURE_H
+
+#include <vector>
+
+#include "TriangleMesh.h"
+
+/**
+ * Discrete curvatures at every vertex of a TriangleMesh, after Meyer, Desbrun, Schröder & Barr:
+ * mean curvature from the cotan Laplacian of the positions, Gaussian curvature from the angle defect,
+ * both over the mixed Voronoi area of the vertex, & principal directions from a least-squares fit
+ * of the normal curvatures along the edges of the 1-ring.
+ *
+ * Every vertex walks its own 1-ring, in parallel, so that no per-face pass or scatter is needed.
+ * Arrays are indexed like TriangleMesh::vertices. Vertices on a boundary, whose 1-ring is open,
+ * & isolated vertices get curvatures of 0 & zero directions. Signs follow the orientation of the faces:
+ * on a sphere with outward normals, both are positive.
+ */
+class MeshCurvature {
+public:
+    std::vector<float> meanCurvatures;
+    std::vector<float> gaussianCurvatures;
+    // principal curvatures, minimum <= maximum, from the mean & Gaussian curvatures
+    std::vector<float> minimumCurvatures;
+    std::vector<float> maximumCurvatures;
+    // unit tangents along which the normal curvature is greatest & least, orthogonal to each other
+    std::vector<Cartesian3> maximumDirections;
+    std::vector<Cartesian3> minimumDirections;
+
+    explicit MeshCurvature(const TriangleMesh& mesh);
+};
+
+#endif
@@ -0,0 +1,410 @@
+#include "MeshDecimation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+// a collapse may not turn a face around it further than this from its normal, about 78 degrees
+constexpr double MINIMUM_NORMAL_COSINE = 0.2;
+
+// quadrics whose determinant is this small relative to their scale have no single minimiser
+constexpr double SINGULAR_DETERMINANT = 1e-10;
+
+typedef std::array<double, 3> Position;
+
+static Position positionOf(const Cartesian3& vertex) {
+    return {vertex.x, vertex.y, vertex.z};
+}
+
+static Position cross(const Position& a, const Position& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+static double dot(const Position& a, const Position& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static Position difference(const Position& a, const Position& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+// Sum of squared distances to a set of planes, as the upper triangle of a symmetric 4x4 matrix
+struct Quadric {
+    // a00 a01 a02 b0, a11 a12 b1, a22 b2, c
+    std::array<double, 10> q{};
+
+    // of the plane through point with unit normal
+    static Quadric ofPlane(const Position& normal, const Position& point) {
+        const double d = -dot(normal, point);
+        Quadric plane;
+        plane.q = {
+            normal[0] * normal[0], normal[0] * normal[1], normal[0] * normal[2], normal[0] * d,
+            normal[1] * normal[1], normal[1] * normal[2], normal[1] * d,
+            normal[2] * normal[2], normal[2] * d,
+            d * d
+        };
+        return plane;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        for (unsigned int i = 0; i < q.size(); i++) {
+            q[i] += other.q[i];
+        }
+        return *this;
+    }
+
+    double error(const Position& p) const {
+        return q[0] * p[0] * p[0] + 2.0 * q[1] * p[0] * p[1] + 2.0 * q[2] * p[0] * p[2] + 2.0 * q[3] * p[0]
+               + q[4] * p[1] * p[1] + 2.0 * q[5] * p[1] * p[2] + 2.0 * q[6] * p[1]
+               + q[7] * p[2] * p[2] + 2.0 * q[8] * p[2]
+               + q[9];
+    }
+
+    // the position of least error, none when it is a line or a plane, e.g. for flat neighbourhoods
+    std::optional<Position> minimiser() const {
+        // cofactors of the symmetric 3x3 part
+        const double c00 = q[4] * q[7] - q[5] * q[5];
+        const double c01 = q[2] * q[5] - q[1] * q[7];
+        const double c02 = q[1] * q[5] - q[2] * q[4];
+        const double c11 = q[0] * q[7] - q[2] * q[2];
+        const double c12 = q[1] * q[2] - q[0] * q[5];
+        const double c22 = q[0] * q[4] - q[1] * q[1];
+        const double determinant = q[0] * c00 + q[1] * c01 + q[2] * c02;
+
+        const double trace = q[0] + q[4] + q[7];
+        if (std::abs(determinant) <= SINGULAR_DETERMINANT * trace * trace * trace) {
+            return std::nullopt;
+        }
+
+        // solves A p = -b
+        const double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+        return Position{
+            (c00 * b0 + c01 * b1 + c02 * b2) / determinant,
+            (c01 * b0 + c11 * b1 + c12 * b2) / determinant,
+            (c02 * b0 + c12 * b1 + c22 * b2) / determinant
+        };
+    }
+};
+
+// Binary min-heap over the ids [0, capacity), whose costs can be changed or removed wherever they sit
+class IndexedHeap {
+    std::vector<unsigned int> heap;
+    // where each id sits in heap, NO_VALUE when it is not queued
+    std::vector<unsigned int> positions;
+    std::vector<double> costs;
+
+public:
+    explicit IndexedHeap(const unsigned int capacity)
+        : positions(capacity, NO_VALUE),
+          costs(capacity) {
+        heap.reserve(capacity);
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    unsigned int top() const {
+        return heap.front();
+    }
+
+    double topCost() const {
+        return costs[heap.front()];
+    }
+
+    // queues id, or moves it to its new cost if it is queued already
+    void set(const unsigned int id, const double cost) {
+        costs[id] = cost;
+        if (positions[id] == NO_VALUE) {
+            positions[id] = heap.size();
+            heap.push_back(id);
+        }
+        siftDown(siftUp(positions[id]));
+    }
+
+    void remove(const unsigned int id) {
+        const unsigned int position = positions[id];
+        if (position == NO_VALUE) {
+            return;
+        }
+
+        positions[id] = NO_VALUE;
+        const unsigned int last = heap.back();
+        heap.pop_back();
+        if (position < heap.size()) {
+            place(position, last);
+            siftDown(siftUp(position));
+        }
+    }
+
+private:
+    void place(const unsigned int position, const unsigned int id) {
+        heap[position] = id;
+        positions[id] = position;
+    }
+
+    // returns where the id at position ended up
+    unsigned int siftUp(unsigned int position) {
+        const unsigned int id = heap[position];
+        while (position > 0) {
+            const unsigned int parent = (position - 1) / 2;
+            if (costs[heap[parent]] <= costs[id]) {
+                break;
+            }
+            place(position, heap[parent]);
+            position = parent;
+        }
+        place(position, id);
+        return position;
+    }
+
+    void siftDown(unsigned int position) {
+        const unsigned int id = heap[position];
+        while (2 * position + 1 < heap.size()) {
+            unsigned int child = 2 * position + 1;
+            if (child + 1 < heap.size() && costs[heap[child + 1]] < costs[heap[child]]) {
+                child++;
+            }
+            if (costs[id] <= costs[heap[child]]) {
+                break;
+            }
+            place(position, heap[child]);
+            position = child;
+        }
+        place(position, id);
+    }
+};
+
+// State of one decimation, over the arrays of the mesh being decimated
+class Decimation {
+    TriangleMesh& mesh;
+
+    std::vector<Quadric> quadrics;
+    // fulledge of every half-edge, merged as collapses pair up the other halves across freed faces
+    std::vector<unsigned int> edgeFulledges;
+    // a live half-edge of every fulledge
+    std::vector<EdgeId> fulledgeHalfEdges;
+    // where each queued fulledge collapses to
+    std::vector<Position> targets;
+    IndexedHeap queue;
+    // fulledges whose collapse would pinch the surface or fold a face over, queued at an infinite cost,
+    // & the list of them to retry, possibly holding some more than once or no longer deferred
+    std::vector<bool> deferred;
+    std::vector<unsigned int> deferredFulledges;
+
+    unsigned int faceCount;
+
+public:
+    explicit Decimation(TriangleMesh& mesh)
+        : mesh(mesh),
+          quadrics(mesh.vertices.size()),
+          edgeFulledges(mesh.fulledges),
+          fulledgeHalfEdges(mesh.fulledgeHalfEdges),
+          targets(mesh.fulledgeHalfEdges.size()),
+          queue(mesh.fulledgeHalfEdges.size()),
+          deferred(mesh.fulledgeHalfEdges.size(), false),
+          faceCount(mesh.faceVertices.size() / 3) {
+        for (FaceIndex face = 0; face < faceCount; face++) {
+            const Position a = positionOf(mesh.vertices[mesh.faceVertices[3 * face]]);
+            const Position b = positionOf(mesh.vertices[mesh.faceVertices[3 * face + 1]]);
+            const Position c = positionOf(mesh.vertices[mesh.faceVertices[3 * face + 2]]);
+            const Position normal = cross(difference(b, a), difference(c, a));
+            const double length = std::sqrt(dot(normal, normal));
+            if (length == 0.0) {
+                continue;
+            }
+
+            const Quadric plane = Quadric::ofPlane({normal[0] / length, normal[1] / length, normal[2] / length}, a);
+            for (unsigned int corner = 0; corner < 3; corner++) {
+                quadrics[mesh.faceVertices[3 * face + corner]] += plane;
+            }
+        }
+
+        for (unsigned int fulledge = 0; fulledge < fulledgeHalfEdges.size(); fulledge++) {
+            evaluate(fulledge);
+        }
+    }
+
+    /**
+     * @brief Collapses the cheapest edge until the mesh is down to targetFaceCount faces, or the cheapest
+     *        edge costs more than maximumError squared
+     *
+     * A cost bounds the squared distance to any single plane of the quadric, so maximumError bounds distances.
+     * Once only deferred edges are left, they are all retried, & decimation stops when that collapses nothing
+     */
+    void run(const unsigned int targetFaceCount, const float maximumError) {
+        const double maximumCost = static_cast<double>(maximumError) * maximumError;
+        bool hasRetried = false;
+
+        while (faceCount > targetFaceCount && !queue.empty()) {
+            if (std::isinf(queue.topCost())) {
+                if (hasRetried) {
+                    break;
+                }
+                hasRetried = true;
+                std::vector<unsigned int> retried;
+                retried.swap(deferredFulledges);
+                for (const unsigned int fulledge : retried) {
+                    if (deferred[fulledge]) {
+                        evaluate(fulledge);
+                    }
+                }
+                continue;
+            }
+            if (queue.topCost() > maximumCost) {
+                break;
+            }
+
+            const unsigned int fulledge = queue.top();
+            const EdgeId halfEdge = fulledgeHalfEdges[fulledge];
+            if (mesh.canCollapseEdge(halfEdge) && !isFolding(halfEdge, targets[fulledge])) {
+                collapse(halfEdge, targets[fulledge]);
+                hasRetried = false;
+            } else {
+                // retried once a collapse changes its neighbourhood
+                deferred[fulledge] = true;
+                deferredFulledges.push_back(fulledge);
+                queue.set(fulledge, std::numeric_limits<double>::infinity());
+            }
+        }
+    }
+
+private:
+    VertexId tailOf(const EdgeId halfEdge) const {
+        return mesh.faceVertices[TriangleMesh::idToIndex(halfEdge)];
+    }
+
+    VertexId headOf(const EdgeId halfEdge) const {
+        return mesh.faceVertices[halfEdge];
+    }
+
+    // calls visitor with every half-edge leaving the tail of first, starting with first
+    template<typename Visitor>
+    void visitOutgoingEdges(const EdgeId first, Visitor&& visitor) const {
+        EdgeId halfEdge = first;
+        do {
+            visitor(halfEdge);
+            halfEdge = TriangleMesh::nextIdInFace(mesh.otherHalf[halfEdge]);
+        } while (halfEdge != first);
+    }
+
+    // picks where fulledge collapses to & queues it by the error there
+    void evaluate(const unsigned int fulledge) {
+        deferred[fulledge] = false;
+        const EdgeId halfEdge = fulledgeHalfEdges[fulledge];
+        const VertexId tail = tailOf(halfEdge);
+        const VertexId head = headOf(halfEdge);
+
+        Quadric quadric = quadrics[tail];
+        quadric += quadrics[head];
+
+        if (const std::optional<Position> minimiser = quadric.minimiser(); minimiser.has_value()) {
+            targets[fulledge] = minimiser.value();
+        } else {
+            // along a line or plane of minimisers, the best of the ends & the midpoint is as good as any
+            const Position a = positionOf(mesh.vertices[tail]);
+            const Position b = positionOf(mesh.vertices[head]);
+            const Position midpoint{(a[0] + b[0]) / 2.0, (a[1] + b[1]) / 2.0, (a[2] + b[2]) / 2.0};
+
+            targets[fulledge] = midpoint;
+            for (const Position& candidate : {a, b}) {
+                if (quadric.error(candidate) < quadric.error(targets[fulledge])) {
+                    targets[fulledge] = candidate;
+                }
+            }
+        }
+
+        queue.set(fulledge, std::max(quadric.error(targets[fulledge]), 0.0));
+    }
+
+    // whether moving the ends of halfEdge to target turns a face around them too far, or leaves it with no area
+    bool isFolding(const EdgeId halfEdge, const Position& target) const {
+        const FaceIndex left = halfEdge / 3;
+        const FaceIndex right = mesh.otherHalf[halfEdge] / 3;
+
+        bool isFolding = false;
+        const auto checkFace = [&](const EdgeId outgoing) {
+            const FaceIndex face = outgoing / 3;
+            if (isFolding || face == left || face == right) {
+                return;
+            }
+
+            const Position moved = positionOf(mesh.vertices[tailOf(outgoing)]);
+            const Position p = positionOf(mesh.vertices[headOf(outgoing)]);
+            const Position q = positionOf(mesh.vertices[headOf(TriangleMesh::nextIdInFace(outgoing))]);
+            const Position before = cross(difference(p, moved), difference(q, moved));
+            const Position after = cross(difference(p, target), difference(q, target));
+
+            const double lengths = std::sqrt(dot(before, before) * dot(after, after));
+            isFolding = lengths == 0.0 || dot(before, after) < MINIMUM_NORMAL_COSINE * lengths;
+        };
+        visitOutgoingEdges(halfEdge, checkFace);
+        visitOutgoingEdges(mesh.otherHalf[halfEdge], checkFace);
+
+        return isFolding;
+    }
+
+    // collapses halfEdge, merging the fulledges on either side of each freed face, then re-evaluates the edges
+    // around the merged vertex, & the deferred edges around its neighbours, whose link & faces it is part of
+    void collapse(const EdgeId halfEdge, const Position& target) {
+        const EdgeId next = TriangleMesh::nextIdInFace(halfEdge);
+        const EdgeId previous = TriangleMesh::nextIdInFace(next);
+        const EdgeId opposite = mesh.otherHalf[halfEdge];
+        const EdgeId oppositeNext = TriangleMesh::nextIdInFace(opposite);
+        const EdgeId oppositePrevious = TriangleMesh::nextIdInFace(oppositeNext);
+
+        // these survive the collapse, paired up across the freed faces
+        const EdgeId leftIn = mesh.otherHalf[next];
+        const EdgeId leftOut = mesh.otherHalf[previous];
+        const EdgeId rightIn = mesh.otherHalf[oppositeNext];
+        const EdgeId rightOut = mesh.otherHalf[oppositePrevious];
+
+        for (const EdgeId freed : {halfEdge, next, oppositePrevious}) {
+            queue.remove(edgeFulledges[freed]);
+            deferred[edgeFulledges[freed]] = false;
+        }
+        edgeFulledges[leftIn] = edgeFulledges[leftOut];
+        fulledgeHalfEdges[edgeFulledges[leftOut]] = leftOut;
+        edgeFulledges[rightOut] = edgeFulledges[rightIn];
+        fulledgeHalfEdges[edgeFulledges[rightIn]] = rightIn;
+
+        quadrics[tailOf(halfEdge)] += quadrics[headOf(halfEdge)];
+        mesh.collapseEdge(halfEdge, Cartesian3(target[0], target[1], target[2]));
+        faceCount -= 2;
+
+        visitOutgoingEdges(leftOut, [&](const EdgeId outgoing) {
+            evaluate(edgeFulledges[outgoing]);
+        });
+        visitOutgoingEdges(leftOut, [&](const EdgeId outgoing) {
+            visitOutgoingEdges(mesh.otherHalf[outgoing], [&](const EdgeId neighbourOutgoing) {
+                if (deferred[edgeFulledges[neighbourOutgoing]]) {
+                    evaluate(edgeFulledges[neighbourOutgoing]);
+                }
+            });
+        });
+    }
+};
+
+/**
+ * @brief Decimates in place through TriangleMesh::collapseEdge, which frees faces & vertices
+ *        that a single compaction drops at the end
+ */
+bool decimate(TriangleMesh& mesh, const unsigned int targetFaceCount, const float maximumError) {
+    if (const std::vector<MeshDefect> defects = mesh.validate(); !defects.empty()) {
+        std::cerr << "Decimation needs a closed 2-manifold:" << std::endl;
+        TriangleMesh::printDefects(defects, std::cerr);
+        return false;
+    }
+
+    if (mesh.fulledges.size() != mesh.otherHalf.size()) {
+        mesh.computeFulledges();
+    }
+
+    Decimation(mesh).run(targetFaceCount, maximumError);
+
+    mesh.compact();
+    mesh.computeNormals();
+    mesh.computeCentreOfGravity();
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef MESH_DECIMATION_H
+#define MESH_DECIMATION_H
+
+#include "TriangleMesh.h"
+
+/*
+ * Quadric error metric simplification (Garland & Heckbert), the coarse end of the LOD pyramid
+ * that subdivision refines.
+ *
+ * Every vertex carries the planes of its original faces as a quadric, summed as vertices merge.
+ * Edges are collapsed cheapest first, from an indexed priority queue, into the position minimising
+ * the sum of squared distances to the planes of both ends, by TriangleMesh::collapseEdge, whose
+ * freed faces & vertices are dropped by a single compaction at the end.
+ * Collapses that would pinch the surface or fold a face over are put off until their neighbourhood changes.
+ */
+
+// Collapses edges of mesh until at most targetFaceCount faces are left, or until every collapse left
+// would move a vertex farther than maximumError from one of the planes of its original faces.
+// mesh must be a closed 2-manifold, see TriangleMesh::validate. Vertices & faces are renumbered,
+// normals, centreOfGravity, objectSize & fulledges recomputed. Returns whether mesh could be decimated
+bool decimate(TriangleMesh& mesh, unsigned int targetFaceCount, float maximumError);
+
+#endif
@@ -0,0 +1,80 @@
+#include "MeshFile.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "MeshCompression.h"
+
+bool isHalfedgeFile(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).extension() == ".halfedge";
+}
+
+bool isTriFile(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).extension() == ".tri";
+}
+
+bool isBinaryFile(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).extension() == ".hebin";
+}
+
+bool isCompressedFile(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).extension() == ".hec";
+}
+
+bool isObjFile(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).extension() == ".obj";
+}
+
+std::string extractMeshName(const std::string& rawMeshPath) {
+    return std::filesystem::path(rawMeshPath).stem();
+}
+
+bool readMeshFile(const std::string& rawMeshPath, TriangleMesh& mesh) {
+    std::ifstream meshFile(rawMeshPath, std::ios::binary);
+
+    if (!meshFile.good()) {
+        return false;
+    }
+
+    if (isHalfedgeFile(rawMeshPath)) {
+        return mesh.readHalfedgeFile(meshFile);
+    }
+
+    if (isTriFile(rawMeshPath)) {
+        return mesh.readTriFile(meshFile);
+    }
+
+    if (isBinaryFile(rawMeshPath)) {
+        return mesh.readBinaryFile(meshFile);
+    }
+
+    if (isCompressedFile(rawMeshPath)) {
+        return readCompressedMesh(meshFile, mesh);
+    }
+
+    return false;
+}
+
+bool writeMeshFile(const std::string& rawMeshPath, const TriangleMesh& mesh) {
+    std::ofstream outputFile(rawMeshPath, std::ios::binary);
+
+    if (!outputFile.good()) {
+        return false;
+    }
+
+    if (isHalfedgeFile(rawMeshPath)) {
+        mesh.writeToHalfedgeFile(outputFile);
+    } else if (isObjFile(rawMeshPath)) {
+        mesh.writeToObjFile(outputFile);
+    } else if (isBinaryFile(rawMeshPath)) {
+        if (!mesh.writeToBinaryFile(outputFile)) {
+            return false;
+        }
+    } else if (isCompressedFile(rawMeshPath)) {
+        writeCompressedMesh(mesh, outputFile);
+    } else {
+        return false;
+    }
+
+    return outputFile.good();
+}
@@ -0,0 +1,28 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <string>
+
+#include "TriangleMesh.h"
+
+/* Routines to read & write a TriangleMesh based on the extension of its path */
+
+bool isHalfedgeFile(const std::string& rawMeshPath);
+
+bool isTriFile(const std::string& rawMeshPath);
+
+bool isBinaryFile(const std::string& rawMeshPath);
+
+bool isCompressedFile(const std::string& rawMeshPath);
+
+bool isObjFile(const std::string& rawMeshPath);
+
+std::string extractMeshName(const std::string& rawMeshPath);
+
+// reads a .halfedge, .tri, .hebin or .hec file into mesh, returns whether the read was successful
+bool readMeshFile(const std::string& rawMeshPath, TriangleMesh& mesh);
+
+// writes mesh as a .halfedge, .obj, .hebin or .hec file, returns whether the write was successful
+bool writeMeshFile(const std::string& rawMeshPath, const TriangleMesh& mesh);
+
+#endif
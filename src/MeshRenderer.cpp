@@ -0,0 +1,321 @@
+#include "MeshRenderer.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// dark grey, readable over both lit & unlit faces
+constexpr GLfloat WIREFRAME_COLOUR[3] = {0.15f, 0.15f, 0.15f};
+
+MeshRenderer::MeshBuffers::MeshBuffers()
+    : mesh(nullptr),
+      smoothVertexBuffer(QOpenGLBuffer::VertexBuffer),
+      smoothIndexBuffer(QOpenGLBuffer::IndexBuffer),
+      flatVertexBuffer(QOpenGLBuffer::VertexBuffer),
+      wireframeIndexBuffer(QOpenGLBuffer::IndexBuffer),
+      smoothUploaded(false),
+      flatUploaded(false),
+      wireframeUploaded(false) {
+}
+
+MeshRenderer::MeshRenderer()
+    : buffersAvailable(false),
+      drawnFaceCount(0),
+      totalFaceCount(0) {
+}
+
+void MeshRenderer::initialise() {
+    buffersAvailable = true;
+
+    for (auto& buffers : cache) {
+        buffersAvailable = buffersAvailable &&
+                           buffers.smoothVertexBuffer.create() &&
+                           buffers.smoothIndexBuffer.create() &&
+                           buffers.flatVertexBuffer.create() &&
+                           buffers.wireframeIndexBuffer.create();
+
+        buffers.smoothVertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        buffers.smoothIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        buffers.flatVertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        buffers.wireframeIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    }
+}
+
+void MeshRenderer::invalidate() {
+    for (auto& buffers : cache) {
+        buffers.mesh = nullptr;
+        buffers.smoothUploaded = false;
+        buffers.flatUploaded = false;
+        buffers.wireframeUploaded = false;
+    }
+}
+
+/**
+ * @brief Draws the triangles of the meshlets of mesh left after culling, with one call per run of
+ *        consecutive meshlets, uploading the buffers first if mesh changed
+ */
+void MeshRenderer::render(const TriangleMesh& mesh, const bool useFlatNormals, const float normalScale) {
+    totalFaceCount = mesh.faceVertices.size() / 3;
+
+    if (!buffersAvailable) {
+        renderImmediate(mesh, useFlatNormals, normalScale);
+        drawnFaceCount = totalFaceCount;
+        return;
+    }
+
+    MeshBuffers& buffers = buffersFor(mesh);
+
+    GLfloat modelView[16];
+    GLfloat projection[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    const ViewVolume viewVolume(modelView, projection);
+
+    // back faces show through once the mesh is open or clipped in depth
+    const bool cullBackFacing = buffers.partition.closed &&
+                                viewVolume.containsDepthOf(mesh.centreOfGravity, mesh.objectSize);
+    const auto ranges = visibleFaceRanges(buffers.partition, viewVolume, cullBackFacing);
+
+    drawnFaceCount = 0;
+    for (const auto& [firstFace, faceCount] : ranges) {
+        drawnFaceCount += faceCount;
+    }
+
+    // buffered normals are unit length, so undo the uniform scale of the modelview matrix instead
+    glEnable(GL_RESCALE_NORMAL);
+    glColor3f(1.0, 1.0, 1.0);
+
+    if (useFlatNormals) {
+        if (!buffers.flatUploaded) {
+            uploadFlat(buffers);
+        }
+
+        bindVertexArrays(buffers.flatVertexBuffer, mesh.faceVertices.size());
+        for (const auto& [firstFace, faceCount] : ranges) {
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(3 * firstFace), static_cast<GLsizei>(3 * faceCount));
+        }
+        releaseVertexArrays(buffers.flatVertexBuffer);
+    } else {
+        if (!buffers.smoothUploaded) {
+            uploadSmooth(buffers);
+        }
+
+        bindVertexArrays(buffers.smoothVertexBuffer, mesh.vertices.size());
+        buffers.smoothIndexBuffer.bind();
+        for (const auto& [firstFace, faceCount] : ranges) {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(3 * faceCount), GL_UNSIGNED_INT,
+                           reinterpret_cast<const void*>(3 * firstFace * sizeof(VertexId)));
+        }
+        buffers.smoothIndexBuffer.release();
+        releaseVertexArrays(buffers.smoothVertexBuffer);
+    }
+
+    glDisable(GL_RESCALE_NORMAL);
+}
+
+/**
+ * @brief Draws every fulledge of mesh as a single line, uploading the positions & lines first
+ *        if mesh changed. Lines are not culled, the depth test hides those behind the faces
+ */
+void MeshRenderer::renderWireframe(const TriangleMesh& mesh) {
+    glColor3fv(WIREFRAME_COLOUR);
+
+    if (!buffersAvailable) {
+        renderWireframeImmediate(mesh);
+        return;
+    }
+
+    MeshBuffers& buffers = buffersFor(mesh);
+    if (!buffers.smoothUploaded) {
+        uploadSmooth(buffers);
+    }
+    if (!buffers.wireframeUploaded) {
+        uploadWireframe(buffers);
+    }
+
+    buffers.smoothVertexBuffer.bind();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+
+    buffers.wireframeIndexBuffer.bind();
+    glDrawElements(GL_LINES, static_cast<GLsizei>(2 * mesh.fulledgeHalfEdges.size()), GL_UNSIGNED_INT, nullptr);
+    buffers.wireframeIndexBuffer.release();
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    buffers.smoothVertexBuffer.release();
+}
+
+void MeshRenderer::destroy() {
+    for (auto& buffers : cache) {
+        buffers.smoothVertexBuffer.destroy();
+        buffers.smoothIndexBuffer.destroy();
+        buffers.flatVertexBuffer.destroy();
+        buffers.wireframeIndexBuffer.destroy();
+    }
+    invalidate();
+    buffersAvailable = false;
+}
+
+bool MeshRenderer::isRetained() const {
+    return buffersAvailable;
+}
+
+float MeshRenderer::culledFraction() const {
+    return totalFaceCount == 0 ? 0.0f : 1.0f - static_cast<float>(drawnFaceCount) / totalFaceCount;
+}
+
+MeshRenderer::MeshBuffers& MeshRenderer::buffersFor(const TriangleMesh& mesh) {
+    auto buffers = std::find_if(cache.begin(), cache.end(), [&mesh](const MeshBuffers& cached) {
+        return cached.mesh == &mesh;
+    });
+
+    if (buffers == cache.end()) {
+        // reuse the buffers of the least recently drawn mesh
+        buffers = std::prev(cache.end());
+        buffers->mesh = &mesh;
+        buffers->partition = MeshletPartition(mesh);
+        buffers->smoothUploaded = false;
+        buffers->flatUploaded = false;
+        buffers->wireframeUploaded = false;
+    }
+
+    std::rotate(cache.begin(), buffers, std::next(buffers));
+    return cache.front();
+}
+
+void MeshRenderer::uploadSmooth(MeshBuffers& buffers) {
+    const TriangleMesh& mesh = *buffers.mesh;
+    const int positionsSize = static_cast<int>(mesh.vertices.size() * sizeof(Cartesian3));
+
+    buffers.smoothVertexBuffer.bind();
+    buffers.smoothVertexBuffer.allocate(2 * positionsSize);
+    buffers.smoothVertexBuffer.write(0, mesh.vertices.data(), positionsSize);
+    // hard assumption: we have enough normals
+    buffers.smoothVertexBuffer.write(positionsSize, mesh.normals.data(), positionsSize);
+    buffers.smoothVertexBuffer.release();
+
+    const std::vector<FaceIndex>& faceOrder = buffers.partition.faceOrder;
+    std::vector<VertexId> indices(mesh.faceVertices.size());
+    for (unsigned int corner = 0; corner < indices.size(); corner++) {
+        indices[corner] = mesh.faceVertices[3 * faceOrder[corner / 3] + corner % 3];
+    }
+
+    buffers.smoothIndexBuffer.bind();
+    buffers.smoothIndexBuffer.allocate(indices.data(), static_cast<int>(indices.size() * sizeof(VertexId)));
+    buffers.smoothIndexBuffer.release();
+
+    buffers.smoothUploaded = true;
+}
+
+void MeshRenderer::uploadFlat(MeshBuffers& buffers) {
+    const TriangleMesh& mesh = *buffers.mesh;
+    const size_t cornerCount = mesh.faceVertices.size();
+    std::vector<Cartesian3> corners(2 * cornerCount);
+
+    const std::vector<FaceIndex>& faceOrder = buffers.partition.faceOrder;
+
+    // hard assumption: faceNormals are up to date
+    for (unsigned int corner = 0; corner < cornerCount; corner++) {
+        const FaceIndex face = faceOrder[corner / 3];
+        corners[corner] = mesh.vertices[mesh.faceVertices[3 * face + corner % 3]];
+        corners[cornerCount + corner] = mesh.faceNormals[face];
+    }
+
+    buffers.flatVertexBuffer.bind();
+    buffers.flatVertexBuffer.allocate(corners.data(), static_cast<int>(corners.size() * sizeof(Cartesian3)));
+    buffers.flatVertexBuffer.release();
+
+    buffers.flatUploaded = true;
+}
+
+void MeshRenderer::uploadWireframe(MeshBuffers& buffers) {
+    const TriangleMesh& mesh = *buffers.mesh;
+
+    // hard assumption: fulledges are up to date
+    std::vector<VertexId> indices(2 * mesh.fulledgeHalfEdges.size());
+    for (unsigned int fulledge = 0; fulledge < mesh.fulledgeHalfEdges.size(); fulledge++) {
+        const EdgeId halfEdge = mesh.fulledgeHalfEdges[fulledge];
+        indices[2 * fulledge] = mesh.faceVertices[TriangleMesh::idToIndex(halfEdge)];
+        indices[2 * fulledge + 1] = mesh.faceVertices[halfEdge];
+    }
+
+    buffers.wireframeIndexBuffer.bind();
+    buffers.wireframeIndexBuffer.allocate(indices.data(), static_cast<int>(indices.size() * sizeof(VertexId)));
+    buffers.wireframeIndexBuffer.release();
+
+    buffers.wireframeUploaded = true;
+}
+
+void MeshRenderer::bindVertexArrays(QOpenGLBuffer& vertexBuffer, const unsigned int vertexCount) {
+    vertexBuffer.bind();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    // with a buffer bound, pointers are byte offsets into it
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glNormalPointer(GL_FLOAT, 0, reinterpret_cast<const void*>(vertexCount * sizeof(Cartesian3)));
+}
+
+void MeshRenderer::releaseVertexArrays(QOpenGLBuffer& vertexBuffer) {
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    vertexBuffer.release();
+}
+
+/**
+ * @brief Fallback re-emitting every triangle, for contexts without buffer objects
+ */
+void MeshRenderer::renderImmediate(const TriangleMesh& mesh, const bool useFlatNormals, const float normalScale) {
+    glBegin(GL_TRIANGLES);
+
+    // set colour for pick render - ignored for regular render
+    glColor3f(1.0, 1.0, 1.0);
+
+    // loop through the faces
+    for (unsigned int face = 0; face < mesh.faceVertices.size(); face += 3) {
+        if (useFlatNormals) {
+            const Cartesian3& faceNormal = mesh.faceNormals[face / 3];
+            glNormal3f(faceNormal.x * normalScale, faceNormal.y * normalScale, faceNormal.z * normalScale);
+        }
+
+        for (unsigned int vertex = face; vertex < face + 3; vertex++) {
+            const auto faceVertex = mesh.faceVertices[vertex];
+            if (!useFlatNormals) {
+                // hard assumption: we have enough normals
+                glNormal3f(
+                    mesh.normals[faceVertex].x * normalScale,
+                    mesh.normals[faceVertex].y * normalScale,
+                    mesh.normals[faceVertex].z * normalScale
+                );
+            }
+
+            glVertex3f(
+                mesh.vertices[faceVertex].x,
+                mesh.vertices[faceVertex].y,
+                mesh.vertices[faceVertex].z
+            );
+        }
+    }
+
+    glEnd();
+}
+
+void MeshRenderer::renderWireframeImmediate(const TriangleMesh& mesh) {
+    glBegin(GL_LINES);
+
+    for (const EdgeId halfEdge : mesh.fulledgeHalfEdges) {
+        const Cartesian3& from = mesh.vertices[mesh.faceVertices[TriangleMesh::idToIndex(halfEdge)]];
+        const Cartesian3& to = mesh.vertices[mesh.faceVertices[halfEdge]];
+
+        glVertex3f(from.x, from.y, from.z);
+        glVertex3f(to.x, to.y, to.z);
+    }
+
+    glEnd();
+}
@@ -0,0 +1,102 @@
+#ifndef MESH_RENDERER_H
+#define MESH_RENDERER_H
+
+#include <array>
+
+#include <QOpenGLBuffer>
+
+#include "Meshlets.h"
+#include "TriangleMesh.h"
+
+/**
+ * Draws a TriangleMesh from buffer objects uploaded once per mesh.
+ *
+ * Smooth shading indexes the shared vertices with faceVertices, flat shading draws an array
+ * with 3 corners per face carrying the face normal. Faces are laid out meshlet by meshlet,
+ * and meshlets outside the view or facing away are culled before drawing. The wireframe indexes
+ * the smooth positions with one line per fulledge, so that every edge is drawn once.
+ *
+ * The buffers of the last two meshes drawn are kept, so that swapping between a subdivision level
+ * and its interaction stand-in uploads nothing. Buffers go through the fixed-function
+ * client arrays, so they also run under legacy & software GL (e.g. Mesa's llvmpipe).
+ * When buffers cannot be created, every frame falls back to immediate mode, without culling.
+ *
+ * Every call must be made with the GL context current.
+ */
+class MeshRenderer {
+    // buffers of one mesh, uploaded on first draw in each shading mode
+    struct MeshBuffers {
+        const TriangleMesh* mesh;
+        MeshletPartition partition;
+
+        // positions followed by normals
+        QOpenGLBuffer smoothVertexBuffer;
+        QOpenGLBuffer smoothIndexBuffer;
+        // corners 3f, 3f + 1 & 3f + 2 are face f of the partition order, positions followed by normals
+        QOpenGLBuffer flatVertexBuffer;
+        // both ends of every fulledge, indexing smoothVertexBuffer
+        QOpenGLBuffer wireframeIndexBuffer;
+
+        bool smoothUploaded;
+        bool flatUploaded;
+        bool wireframeUploaded;
+
+        MeshBuffers();
+    };
+
+    // the selected level & its interaction stand-in, most recently drawn first
+    static constexpr unsigned int CACHED_MESH_COUNT = 2;
+    std::array<MeshBuffers, CACHED_MESH_COUNT> cache;
+
+    bool buffersAvailable;
+
+    // faces of the last frame
+    unsigned int drawnFaceCount;
+    unsigned int totalFaceCount;
+
+public:
+    MeshRenderer();
+
+    MeshRenderer(const MeshRenderer&) = delete;
+
+    MeshRenderer& operator=(const MeshRenderer&) = delete;
+
+    void initialise();
+
+    // to be called when a mesh held by the buffers was edited in place
+    void invalidate();
+
+    // normalScale compensates for the uniform scale of the modelview matrix in immediate mode
+    void render(const TriangleMesh& mesh, bool useFlatNormals, float normalScale);
+
+    // draws the edges unlit, over the faces drawn by render
+    void renderWireframe(const TriangleMesh& mesh);
+
+    void destroy();
+
+    bool isRetained() const;
+
+    // share of the faces of the last frame skipped by meshlet culling
+    float culledFraction() const;
+
+private:
+    // moves the buffers of mesh to the front of the cache, evicting the least recently drawn mesh
+    MeshBuffers& buffersFor(const TriangleMesh& mesh);
+
+    static void uploadSmooth(MeshBuffers& buffers);
+
+    static void uploadFlat(MeshBuffers& buffers);
+
+    static void uploadWireframe(MeshBuffers& buffers);
+
+    // binds positions & normals laid out one after the other in vertexBuffer
+    static void bindVertexArrays(QOpenGLBuffer& vertexBuffer, unsigned int vertexCount);
+
+    static void releaseVertexArrays(QOpenGLBuffer& vertexBuffer);
+
+    static void renderImmediate(const TriangleMesh& mesh, bool useFlatNormals, float normalScale);
+
+    static void renderWireframeImmediate(const TriangleMesh& mesh);
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "MortonOrder.h"
+#include "Parallel.h"
+
+// cone tests err on the side of drawing, against rounding in the normals
+constexpr float CONE_CUTOFF_MARGIN = 1e-3f;
+
+MeshletPartition::MeshletPartition()
+    : closed(false) {
+}
+
+/**
+ * @brief Cuts the Morton-ordered faces into runs of MESHLET_FACE_COUNT, bounding each run with
+ *        the sphere around its box and the cone around its face normals
+ */
+MeshletPartition::MeshletPartition(const TriangleMesh& mesh)
+    : faceOrder(facesAlongMortonCurve(mesh)),
+      closed(std::find(mesh.otherHalf.begin(), mesh.otherHalf.end(), NO_VALUE) == mesh.otherHalf.end()) {
+    const unsigned int faceCount = faceOrder.size();
+    meshlets.resize((faceCount + MESHLET_FACE_COUNT - 1) / MESHLET_FACE_COUNT);
+
+    parallelFor(0, meshlets.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int meshletId = begin; meshletId < end; meshletId++) {
+            Meshlet& meshlet = meshlets[meshletId];
+            meshlet.firstFace = meshletId * MESHLET_FACE_COUNT;
+            meshlet.faceCount = std::min(MESHLET_FACE_COUNT, faceCount - meshlet.firstFace);
+
+            Cartesian3 min = mesh.vertices[mesh.faceVertices[3 * faceOrder[meshlet.firstFace]]];
+            Cartesian3 max = min;
+            Cartesian3 normalSum(0.0f, 0.0f, 0.0f);
+            for (unsigned int face = meshlet.firstFace; face < meshlet.firstFace + meshlet.faceCount; face++) {
+                for (unsigned int slot = 0; slot < 3; slot++) {
+                    const Cartesian3& vertex = mesh.vertices[mesh.faceVertices[3 * faceOrder[face] + slot]];
+                    for (int axis = 0; axis < 3; axis++) {
+                        min[axis] = std::min(min[axis], vertex[axis]);
+                        max[axis] = std::max(max[axis], vertex[axis]);
+                    }
+                }
+                normalSum += mesh.faceNormals[faceOrder[face]];
+            }
+
+            meshlet.centre = (min + max) / 2.0f;
+            meshlet.radius = 0.0f;
+            for (unsigned int face = meshlet.firstFace; face < meshlet.firstFace + meshlet.faceCount; face++) {
+                for (unsigned int slot = 0; slot < 3; slot++) {
+                    const Cartesian3& vertex = mesh.vertices[mesh.faceVertices[3 * faceOrder[face] + slot]];
+                    meshlet.radius = std::max(meshlet.radius, (vertex - meshlet.centre).length());
+                }
+            }
+
+            // the cone spans angle a around its axis, all faces point away once the view is within 90 - a of it
+            meshlet.coneAxis = normalSum.unit();
+            float minimumCosine = normalSum.length() > 0.0f ? 1.0f : -1.0f;
+            for (unsigned int face = meshlet.firstFace; face < meshlet.firstFace + meshlet.faceCount; face++) {
+                minimumCosine = std::min(minimumCosine, mesh.faceNormals[faceOrder[face]].dot(meshlet.coneAxis));
+            }
+            meshlet.coneCutoff = minimumCosine > 0.0f
+                                     ? std::sqrt(1.0f - minimumCosine * minimumCosine) + CONE_CUTOFF_MARGIN
+                                     : 2.0f;
+        }
+    });
+}
+
+/**
+ * @brief Extracts the planes of projection * modelView (Gribb & Hartmann), and the view direction,
+ *        the -z axis of eye coordinates brought back to object coordinates
+ */
+ViewVolume::ViewVolume(const float* modelView, const float* projection)
+    : planes() {
+    // row r of the combined matrix
+    std::array<std::array<float, 4>, 4> rows{};
+    for (int row = 0; row < 4; row++) {
+        for (int column = 0; column < 4; column++) {
+            for (int k = 0; k < 4; k++) {
+                rows[row][column] += projection[4 * k + row] * modelView[4 * column + k];
+            }
+        }
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (int component = 0; component < 4; component++) {
+            planes[2 * axis][component] = rows[3][component] + rows[axis][component];
+            planes[2 * axis + 1][component] = rows[3][component] - rows[axis][component];
+        }
+    }
+
+    for (auto& plane : planes) {
+        const float length = Cartesian3(plane[0], plane[1], plane[2]).length();
+        for (float& component : plane) {
+            component /= length;
+        }
+    }
+
+    // modelView is a rotation & uniform scale, so its inverse transpose keeps the direction of rows
+    viewDirection = Cartesian3(-modelView[2], -modelView[6], -modelView[10]).unit();
+}
+
+bool ViewVolume::intersects(const Cartesian3& centre, const float radius) const {
+    return std::all_of(planes.begin(), planes.end(), [&](const std::array<float, 4>& plane) {
+        return plane[0] * centre.x + plane[1] * centre.y + plane[2] * centre.z + plane[3] >= -radius;
+    });
+}
+
+bool ViewVolume::containsDepthOf(const Cartesian3& centre, const float radius) const {
+    return std::all_of(planes.begin() + 4, planes.end(), [&](const std::array<float, 4>& plane) {
+        return plane[0] * centre.x + plane[1] * centre.y + plane[2] * centre.z + plane[3] >= radius;
+    });
+}
+
+bool ViewVolume::facesAway(const Meshlet& meshlet) const {
+    return meshlet.coneAxis.dot(viewDirection) >= meshlet.coneCutoff;
+}
+
+std::vector<std::pair<unsigned int, unsigned int>> visibleFaceRanges(const MeshletPartition& partition,
+                                                                     const ViewVolume& viewVolume,
+                                                                     const bool cullBackFacing) {
+    std::vector<std::pair<unsigned int, unsigned int>> ranges;
+
+    for (const auto& meshlet : partition.meshlets) {
+        if (!viewVolume.intersects(meshlet.centre, meshlet.radius) ||
+            (cullBackFacing && viewVolume.facesAway(meshlet))) {
+            continue;
+        }
+
+        // merge with the previous range when adjacent, so that draws stay few
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == meshlet.firstFace) {
+            ranges.back().second += meshlet.faceCount;
+        } else {
+            ranges.emplace_back(meshlet.firstFace, meshlet.faceCount);
+        }
+    }
+
+    return ranges;
+}
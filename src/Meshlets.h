@@ -0,0 +1,73 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "TriangleMesh.h"
+
+// faces per meshlet, small enough to cull finely, large enough to keep draws few
+constexpr unsigned int MESHLET_FACE_COUNT = 128;
+
+// Spatially coherent cluster of faces, culled as a whole
+struct Meshlet {
+    // range within the face order of the partition
+    unsigned int firstFace;
+    unsigned int faceCount;
+
+    // bounding sphere
+    Cartesian3 centre;
+    float radius;
+
+    // the faces all point away from any view direction d with coneAxis.dot(d) >= coneCutoff,
+    // coneCutoff > 1 when the normals spread too much for that to happen
+    Cartesian3 coneAxis;
+    float coneCutoff;
+};
+
+/**
+ * Faces of a TriangleMesh cut into meshlets along the Morton curve of their centroids.
+ * Requires up to date faceNormals.
+ */
+struct MeshletPartition {
+    // newFace -> oldFace, meshlets cover consecutive ranges of it
+    std::vector<FaceIndex> faceOrder;
+    std::vector<Meshlet> meshlets;
+    // back faces of closed meshes are hidden behind front faces
+    bool closed;
+
+    MeshletPartition();
+
+    explicit MeshletPartition(const TriangleMesh& mesh);
+};
+
+/**
+ * What the camera sees, in the object coordinates of the mesh.
+ * Built from column-major OpenGL matrices, the projection being orthographic.
+ */
+class ViewVolume {
+    // left, right, bottom, top, near & far, pointing inwards with unit normals
+    std::array<std::array<float, 4>, 6> planes;
+
+    // direction the camera looks along
+    Cartesian3 viewDirection;
+
+public:
+    ViewVolume(const float* modelView, const float* projection);
+
+    bool intersects(const Cartesian3& centre, float radius) const;
+
+    // whether the sphere lies between the near & far planes, i.e. nothing of it is clipped in depth
+    bool containsDepthOf(const Cartesian3& centre, float radius) const;
+
+    bool facesAway(const Meshlet& meshlet) const;
+};
+
+// Returns the consecutive face ranges <firstFace, faceCount> of the meshlets left after culling.
+// Back-facing meshlets are only culled when cullBackFacing holds
+std::vector<std::pair<unsigned int, unsigned int>> visibleFaceRanges(const MeshletPartition& partition,
+                                                                     const ViewVolume& viewVolume,
+                                                                     bool cullBackFacing);
+
+#endif
@@ -0,0 +1,156 @@
+#include "MortonOrder.h"
+
+#include <algorithm>
+#include <numeric>
+
+constexpr uint32_t MORTON_AXIS_CELLS = 1u << 10;
+
+/**
+ * @return value with two zero bits interleaved between each of its 10 lowest bits
+ */
+static uint32_t spreadBits(uint32_t value) {
+    value = (value | (value << 16)) & 0x030000FF;
+    value = (value | (value << 8)) & 0x0300F00F;
+    value = (value | (value << 4)) & 0x030C30C3;
+    value = (value | (value << 2)) & 0x09249249;
+    return value;
+}
+
+static uint32_t quantise(const float value, const float min, const float max) {
+    const float extent = max - min;
+    if (extent <= 0.0f) {
+        return 0;
+    }
+
+    const float cell = (value - min) / extent * MORTON_AXIS_CELLS;
+    return std::clamp(static_cast<uint32_t>(std::max(cell, 0.0f)), 0u, MORTON_AXIS_CELLS - 1);
+}
+
+uint32_t mortonCode(const Cartesian3& point, const Cartesian3& min, const Cartesian3& max) {
+    return spreadBits(quantise(point.x, min.x, max.x)) << 2 |
+           spreadBits(quantise(point.y, min.y, max.y)) << 1 |
+           spreadBits(quantise(point.z, min.z, max.z));
+}
+
+/**
+ * @return ids [0, codes.size()) stably sorted by codes
+ */
+static std::vector<unsigned int> sortedByCode(const std::vector<uint32_t>& codes) {
+    std::vector<unsigned int> order(codes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&codes](const unsigned int a, const unsigned int b) {
+        return codes[a] < codes[b];
+    });
+    return order;
+}
+
+/**
+ * @return bounding box <min, max> of the vertices of mesh, which must not be empty
+ */
+static std::pair<Cartesian3, Cartesian3> boundsOf(const TriangleMesh& mesh) {
+    Cartesian3 min = mesh.vertices.front();
+    Cartesian3 max = mesh.vertices.front();
+    for (const auto& vertex : mesh.vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            min[axis] = std::min(min[axis], vertex[axis]);
+            max[axis] = std::max(max[axis], vertex[axis]);
+        }
+    }
+    return {min, max};
+}
+
+static std::vector<FaceIndex> facesByCentroidCode(const TriangleMesh& mesh, const Cartesian3& min, const Cartesian3& max) {
+    std::vector<uint32_t> faceCodes(mesh.faceVertices.size() / 3);
+    for (FaceIndex face = 0; face < faceCodes.size(); face++) {
+        const Cartesian3 centroid = (mesh.vertices[mesh.faceVertices[3 * face]] +
+                                     mesh.vertices[mesh.faceVertices[3 * face + 1]] +
+                                     mesh.vertices[mesh.faceVertices[3 * face + 2]]) / 3.0f;
+        faceCodes[face] = mortonCode(centroid, min, max);
+    }
+    return sortedByCode(faceCodes);
+}
+
+std::vector<FaceIndex> facesAlongMortonCurve(const TriangleMesh& mesh) {
+    if (mesh.vertices.empty()) {
+        return {};
+    }
+
+    const auto [min, max] = boundsOf(mesh);
+    return facesByCentroidCode(mesh, min, max);
+}
+
+/**
+ * @brief Sorts vertices by the Morton code of their position, and faces by the Morton code of their
+ *        centroid, both within the bounding box of the mesh
+ *
+ * Half-edges keep their slot within their face, so the edge[to] format is preserved:
+ * half-edge 3 * face + slot becomes 3 * newFace + slot.
+ */
+void reorderAlongMortonCurve(TriangleMesh& mesh) {
+    if (mesh.vertices.empty()) {
+        return;
+    }
+
+    const auto [min, max] = boundsOf(mesh);
+
+    // newVertex -> oldVertex, then oldVertex -> newVertex
+    std::vector<uint32_t> vertexCodes(mesh.vertices.size());
+    for (VertexId vertexId = 0; vertexId < mesh.vertices.size(); vertexId++) {
+        vertexCodes[vertexId] = mortonCode(mesh.vertices[vertexId], min, max);
+    }
+    const std::vector<unsigned int> vertexOrder = sortedByCode(vertexCodes);
+    std::vector<VertexId> newVertexId(vertexOrder.size());
+    for (VertexId newId = 0; newId < vertexOrder.size(); newId++) {
+        newVertexId[vertexOrder[newId]] = newId;
+    }
+
+    // newFace -> oldFace, then oldFace -> newFace
+    const std::vector<FaceIndex> faceOrder = facesByCentroidCode(mesh, min, max);
+    std::vector<FaceIndex> newFace(faceOrder.size());
+    for (FaceIndex newId = 0; newId < faceOrder.size(); newId++) {
+        newFace[faceOrder[newId]] = newId;
+    }
+
+    const auto newEdgeId = [&newFace](const EdgeId edgeId) -> EdgeId {
+        return edgeId == NO_VALUE ? NO_VALUE : 3 * newFace[edgeId / 3] + edgeId % 3;
+    };
+
+    TriangleMesh reordered;
+    reordered.vertices.resize(mesh.vertices.size());
+    reordered.normals.resize(mesh.normals.size());
+    reordered.firstDirectedEdge.resize(mesh.firstDirectedEdge.size());
+    for (VertexId newId = 0; newId < vertexOrder.size(); newId++) {
+        const VertexId oldId = vertexOrder[newId];
+        reordered.vertices[newId] = mesh.vertices[oldId];
+        if (oldId < mesh.normals.size()) {
+            reordered.normals[newId] = mesh.normals[oldId];
+        }
+        if (oldId < mesh.firstDirectedEdge.size()) {
+            reordered.firstDirectedEdge[newId] = newEdgeId(mesh.firstDirectedEdge[oldId]);
+        }
+    }
+
+    reordered.faceVertices.resize(mesh.faceVertices.size());
+    reordered.faceNormals.resize(mesh.faceNormals.size());
+    reordered.otherHalf.resize(mesh.otherHalf.size());
+    for (FaceIndex newId = 0; newId < faceOrder.size(); newId++) {
+        const FaceIndex oldId = faceOrder[newId];
+        if (oldId < mesh.faceNormals.size()) {
+            reordered.faceNormals[newId] = mesh.faceNormals[oldId];
+        }
+        for (unsigned int slot = 0; slot < 3; slot++) {
+            reordered.faceVertices[3 * newId + slot] = newVertexId[mesh.faceVertices[3 * oldId + slot]];
+            if (3 * oldId + slot < mesh.otherHalf.size()) {
+                reordered.otherHalf[3 * newId + slot] = newEdgeId(mesh.otherHalf[3 * oldId + slot]);
+            }
+        }
+    }
+
+    mesh.vertices = std::move(reordered.vertices);
+    mesh.normals = std::move(reordered.normals);
+    mesh.faceNormals = std::move(reordered.faceNormals);
+    mesh.faceVertices = std::move(reordered.faceVertices);
+    mesh.otherHalf = std::move(reordered.otherHalf);
+    mesh.firstDirectedEdge = std::move(reordered.firstDirectedEdge);
+    mesh.computeFulledges();
+}
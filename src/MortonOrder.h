@@ -0,0 +1,21 @@
+#ifndef MORTON_ORDER_H
+#define MORTON_ORDER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "TriangleMesh.h"
+
+/* Routines to sort geometry along a Morton (Z-order) space-filling curve */
+
+// 30-bit Morton code of point, quantised to 10 bits per axis within [min, max]
+uint32_t mortonCode(const Cartesian3& point, const Cartesian3& min, const Cartesian3& max);
+
+// faces of mesh sorted by the Morton code of their centroid, as newFace -> oldFace
+std::vector<FaceIndex> facesAlongMortonCurve(const TriangleMesh& mesh);
+
+// Renumbers vertices & faces of mesh along the Morton curve, so that 1-ring walks touch nearby memory.
+// faceVertices, otherHalf & firstDirectedEdge are remapped consistently, the surface is unchanged
+void reorderAlongMortonCurve(TriangleMesh& mesh);
+
+#endif
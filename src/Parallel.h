@@ -0,0 +1,51 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// below this many items per thread, spawning threads costs more than it saves
+constexpr unsigned int MINIMUM_ITEMS_PER_THREAD = 1u << 14;
+
+/**
+ * Splits [begin, end) into contiguous chunks, one per hardware thread, and calls
+ * body(chunkBegin, chunkEnd) for each of them concurrently. Returns once every chunk is done.
+ * Items that are expensive on their own may lower minimumItemsPerThread, down to 1.
+ *
+ * Chunks are disjoint, so body may write to per-item outputs without synchronisation.
+ */
+template<typename Body>
+void parallelFor(const unsigned int begin, const unsigned int end, const Body& body,
+                 const unsigned int minimumItemsPerThread = MINIMUM_ITEMS_PER_THREAD) {
+    if (end <= begin) {
+        return;
+    }
+
+    const unsigned int itemCount = end - begin;
+    const unsigned int threadCount = std::clamp(itemCount / minimumItemsPerThread,
+                                                1u,
+                                                std::max(std::thread::hardware_concurrency(), 1u));
+    if (threadCount == 1) {
+        body(begin, end);
+        return;
+    }
+
+    const unsigned int chunkSize = (itemCount + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned int chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize) {
+        threads.emplace_back(std::cref(body), chunkBegin, std::min(chunkBegin + chunkSize, end));
+    }
+
+    // the calling thread takes the first chunk
+    body(begin, std::min(begin + chunkSize, end));
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "PerfCounter.h"
+
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+PerfCounter::PerfCounter()
+    : startCount(0) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    // threads created from now on count into this counter as well
+    attributes.inherit = 1;
+
+    // this thread, any CPU, no group
+    fileDescriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+PerfCounter::~PerfCounter() {
+    if (isAvailable()) {
+        close(fileDescriptor);
+    }
+}
+
+bool PerfCounter::isAvailable() const {
+    return fileDescriptor >= 0;
+}
+
+/**
+ * @brief Enabled before the pass spawns its threads, which inherit the counter in that state
+ */
+void PerfCounter::start() {
+    if (isAvailable()) {
+        startCount = read().value_or(0);
+        ioctl(fileDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+std::optional<uint64_t> PerfCounter::stop() const {
+    if (!isAvailable()) {
+        return std::nullopt;
+    }
+
+    ioctl(fileDescriptor, PERF_EVENT_IOC_DISABLE, 0);
+
+    const auto count = read();
+    if (!count.has_value()) {
+        return std::nullopt;
+    }
+
+    return count.value() - startCount;
+}
+
+std::optional<uint64_t> PerfCounter::read() const {
+    uint64_t count;
+    if (::read(fileDescriptor, &count, sizeof(count)) != sizeof(count)) {
+        return std::nullopt;
+    }
+
+    return count;
+}
@@ -0,0 +1,40 @@
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <cstdint>
+#include <optional>
+
+/**
+ * Hardware cache miss counter of the calling thread & of the threads it spawns once the counter exists,
+ * e.g. by parallelFor or std::async, backed by Linux perf events inheriting into those threads. Their counts
+ * are added in as they exit, so passes must join their threads before stop() to be counted in full.
+ *
+ * Counting may be refused by the kernel (e.g. perf_event_paranoid or containers),
+ * in which case isAvailable() is false and readings are std::nullopt.
+ */
+class PerfCounter {
+    int fileDescriptor;
+    // reading at start(), as resets do not clear the counts of threads that already exited
+    uint64_t startCount;
+
+public:
+    PerfCounter();
+
+    PerfCounter(const PerfCounter&) = delete;
+
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter();
+
+    bool isAvailable() const;
+
+    void start();
+
+    // cache misses since start()
+    std::optional<uint64_t> stop() const;
+
+private:
+    std::optional<uint64_t> read() const;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "RenderBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QSurfaceFormat>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include "SceneRenderer.h"
+
+// size of the framebuffer, that of the render widget in the default window
+constexpr int FRAME_WIDTH = 960;
+constexpr int FRAME_HEIGHT = 600;
+
+RenderBenchmark::RenderBenchmark(const unsigned int frameCount)
+    : frameCount(frameCount) {
+}
+
+/**
+ * @brief Draws frameCount frames of every level with each render path, waiting for the GPU after every frame
+ *        as the viewer does. A first frame uploading the buffers is drawn beforehand, untimed
+ */
+bool RenderBenchmark::run(const std::map<unsigned int, TriangleMesh>& levels) const {
+    // surfaces need an application, whose platform plugin is picked from the environment
+    static int argc = 1;
+    static char name[] = "half-edge";
+    static char* argv[] = {name, nullptr};
+    std::unique_ptr<QGuiApplication> application;
+    if (QCoreApplication::instance() == nullptr) {
+        application = std::make_unique<QGuiApplication>(argc, argv);
+    }
+
+    // instanced markers & the fixed-function pipeline both need a compatibility profile
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CompatibilityProfile);
+    format.setDepthBufferSize(24);
+
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "Failed to make an OpenGL context current" << std::endl;
+        return false;
+    }
+
+    QOpenGLFramebufferObject framebuffer(FRAME_WIDTH, FRAME_HEIGHT, QOpenGLFramebufferObject::Depth);
+    if (!framebuffer.isValid() || !framebuffer.bind()) {
+        std::cerr << "Failed to bind a " << FRAME_WIDTH << "x" << FRAME_HEIGHT << " framebuffer" << std::endl;
+        return false;
+    }
+
+    std::cout << "Render benchmark, " << frameCount << " frames at " << FRAME_WIDTH << "x" << FRAME_HEIGHT
+            << " on " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << std::endl;
+
+    RenderParameters renderParameters;
+    renderParameters.showVertices = false;
+
+    for (const bool immediate : {false, true}) {
+        SceneRenderer sceneRenderer;
+        sceneRenderer.initialise(immediate);
+        sceneRenderer.resize(FRAME_WIDTH, FRAME_HEIGHT);
+        const char* renderPath = sceneRenderer.isRetained() ? "retained" : "immediate";
+
+        for (const auto& [level, mesh] : levels) {
+            renderParameters.rotationMatrix = SceneRenderer::sweepRotation(0, frameCount);
+            sceneRenderer.render(mesh, renderParameters, std::min(FRAME_WIDTH, FRAME_HEIGHT));
+            glFinish();
+
+            double culledFraction = 0.0;
+            const auto begin = std::chrono::steady_clock::now();
+            for (unsigned int frame = 0; frame < frameCount; frame++) {
+                renderParameters.rotationMatrix = SceneRenderer::sweepRotation(frame, frameCount);
+                sceneRenderer.render(mesh, renderParameters, std::min(FRAME_WIDTH, FRAME_HEIGHT));
+                glFinish();
+                culledFraction += sceneRenderer.culledFraction();
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            std::cout << std::fixed << std::setprecision(1)
+                    << "level " << level << ", " << renderPath << ": " << mesh.faceVertices.size() / 3 << " faces, "
+                    << frameCount / seconds << " fps, " << 1000.0 * seconds / frameCount << " ms/frame, "
+                    << 100.0 * culledFraction / frameCount << "% culled" << std::endl
+                    << std::defaultfloat;
+        }
+
+        sceneRenderer.destroy();
+    }
+
+    // the framebuffer is freed before the context, which is still current
+    framebuffer.release();
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include <map>
+
+#include "TriangleMesh.h"
+
+/**
+ * Times the viewer's renderers without a window, drawing into a framebuffer object
+ * of an offscreen surface.
+ *
+ * Every level is drawn along the same deterministic sweep as --record-frames, once per render path,
+ * and the frames per second are reported. Without a GPU, Mesa's llvmpipe serves the GL context,
+ * e.g. under xvfb-run. Vertex markers are left out, as they would dominate immediate mode.
+ */
+class RenderBenchmark {
+    unsigned int frameCount;
+
+public:
+    explicit RenderBenchmark(unsigned int frameCount);
+
+    // levels keyed by subdivision level, false if no GL context could be made current
+    bool run(const std::map<unsigned int, TriangleMesh>& levels) const;
+};
+
+#endif
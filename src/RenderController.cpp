@@ -25,6 +25,8 @@ RenderController::RenderController(
                      this, SLOT(continueScaledDrag(float, float)));
     QObject::connect(renderWindow->renderWidget, SIGNAL(endScaledDrag(float, float)),
                      this, SLOT(endScaledDrag(float, float)));
+    QObject::connect(renderWindow->renderWidget, SIGNAL(pickAt(float, float)),
+                     this, SLOT(pickAt(float, float)));
 
     // signal for zoom slider
     QObject::connect(renderWindow->zoomSlider, SIGNAL(valueChanged(int)),
@@ -50,6 +52,14 @@ RenderController::RenderController(
     QObject::connect(renderWindow->showVerticesBox, SIGNAL(stateChanged(int)),
                      this, SLOT(showVerticesCheckChanged(int)));
 
+    // signal for check box for showing the wireframe
+    QObject::connect(renderWindow->showWireframeBox, SIGNAL(stateChanged(int)),
+                     this, SLOT(showWireframeCheckChanged(int)));
+
+    // signal for check box for showing statistics
+    QObject::connect(renderWindow->showStatisticsBox, SIGNAL(stateChanged(int)),
+                     this, SLOT(showStatisticsCheckChanged(int)));
+
     // signal for check box for showing vertices
     QObject::connect(renderWindow->subdivisionSlider, SIGNAL(valueChanged(int)),
                      this, SLOT(subdivisionNumberChanged(int)));
@@ -69,58 +79,72 @@ RenderController::RenderController(
 void RenderController::objectRotationChanged() const {
     renderParameters->rotationMatrix = renderWindow->modelRotator->rotationMatrix();
 
-    renderWindow->resetInterface();
+    renderWindow->continueInteraction();
+    renderWindow->inputChanged(RenderWindow::DIRTY_LEVEL | RenderWindow::DIRTY_ROTATORS);
 }
 
 void RenderController::lightRotationChanged() const {
     renderParameters->lightMatrix = renderWindow->lightRotator->rotationMatrix();
 
-    renderWindow->resetInterface();
+    renderWindow->continueInteraction();
+    renderWindow->inputChanged(RenderWindow::DIRTY_LEVEL | RenderWindow::DIRTY_ROTATORS);
 }
 
 void RenderController::zoomChanged(const int value) const {
     renderParameters->zoomScale =
             std::clamp(std::pow(10.0f, static_cast<float>(value) / 100.0f), ZOOM_SCALE_MIN, ZOOM_SCALE_MAX);
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::xTranslateChanged(const int value) const {
     renderParameters->xTranslate =
             std::clamp(static_cast<float>(value) / 100.0f, TRANSLATE_MIN, TRANSLATE_MAX);
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::yTranslateChanged(const int value) const {
     renderParameters->yTranslate =
             std::clamp(static_cast<float>(value) / 100.0f, TRANSLATE_MIN, TRANSLATE_MAX);;
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::vertexSizeChanged(const int value) const {
     renderParameters->vertexSize = static_cast<float>(value) / 512.0f;
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::showVerticesCheckChanged(const int state) const {
     renderParameters->showVertices = state == Qt::Checked;
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
+}
+
+void RenderController::showWireframeCheckChanged(const int state) const {
+    renderParameters->showWireframe = state == Qt::Checked;
+
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::flatNormalsCheckChanged(const int state) const {
     renderParameters->useFlatNormals = state == Qt::Checked;
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
+}
+
+void RenderController::showStatisticsCheckChanged(const int state) const {
+    renderParameters->showStatistics = state == Qt::Checked;
+
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
 
 void RenderController::subdivisionNumberChanged(const int number) const {
     renderParameters->subdivisionNumber = number;
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_LEVEL);
 }
 
 void RenderController::writeToHalfedgeFile() const {
@@ -138,7 +162,7 @@ void RenderController::writeToHalfedgeFile() const {
     if (!outputFile.good()) {
         std::cerr << "Failed to output: " << std::endl << outputMeshPath << std::endl << std::endl;
     } else {
-        renderWindow->renderWidget->triangleMesh->writeToHalfedgeFile(outputFile);
+        renderWindow->selectedMesh().writeToHalfedgeFile(outputFile);
         std::cout << "Written to file: " << outputMeshPath << std::endl << std::endl;
     }
 }
@@ -158,7 +182,7 @@ void RenderController::writeToObjFile() const {
     if (!outputFile.good()) {
         std::cerr << "Failed to output: " << std::endl << outputMeshPath << std::endl << std::endl;
     } else {
-        renderWindow->renderWidget->triangleMesh->writeToObjFile(outputFile);
+        renderWindow->selectedMesh().writeToObjFile(outputFile);
         std::cout << "Written to file: " << outputMeshPath << std::endl << std::endl;
     }
 }
@@ -167,6 +191,8 @@ void RenderController::beginScaledDrag(const int whichButton, const float x, con
     // Remember drag button
     dragButton = whichButton;
 
+    // the rotator signals rotationChanged in turn, which marks the window dirty
+
     switch (dragButton) {
         case Qt::LeftButton:
             renderWindow->modelRotator->beginDrag(x, y);
@@ -174,8 +200,6 @@ void RenderController::beginScaledDrag(const int whichButton, const float x, con
         default:
             break;
     }
-
-    renderWindow->resetInterface();
 }
 
 void RenderController::continueScaledDrag(const float x, const float y) const {
@@ -186,8 +210,6 @@ void RenderController::continueScaledDrag(const float x, const float y) const {
         default:
             break;
     }
-
-    renderWindow->resetInterface();
 }
 
 void RenderController::endScaledDrag(const float x, const float y) {
@@ -201,6 +223,10 @@ void RenderController::endScaledDrag(const float x, const float y) {
 
     // Forget drag button
     dragButton = Qt::NoButton;
+}
+
+void RenderController::pickAt(const float x, const float y) const {
+    renderWindow->pick(x, y);
 
-    renderWindow->resetInterface();
+    renderWindow->inputChanged(RenderWindow::DIRTY_VIEW);
 }
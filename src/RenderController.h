@@ -41,8 +41,12 @@ public slots:
     // slots for responding to check boxes
     void showVerticesCheckChanged(int state) const;
 
+    void showWireframeCheckChanged(int state) const;
+
     void flatNormalsCheckChanged(int state) const;
 
+    void showStatisticsCheckChanged(int state) const;
+
     // slot for subdivision slider
     void subdivisionNumberChanged(int number) const;
 
@@ -57,6 +61,8 @@ public slots:
     void continueScaledDrag(float x, float y) const;
 
     void endScaledDrag(float x, float y);
+
+    void pickAt(float x, float y) const;
 };
 
 #endif
@@ -17,6 +17,11 @@ public:
 
     bool useFlatNormals;
     bool showVertices;
+    bool showWireframe;
+    bool showStatistics;
+
+    // draw without buffer objects or instancing, only read when the GL context is initialised
+    bool forceImmediateMode;
 
     float vertexSize;
 
@@ -33,6 +38,9 @@ inline RenderParameters::RenderParameters()
       lightPosition({0.0f, 0.0f, 1.0f, 0.0f}),
       useFlatNormals(true),
       showVertices(true),
+      showWireframe(false),
+      showStatistics(false),
+      forceImmediateMode(false),
       vertexSize(0.25f),
       subdivisionNumber(0) {
     rotationMatrix = Matrix4::identity();
@@ -49,7 +57,7 @@ inline RenderParameters::RenderParameters()
 #define ZOOM_SCALE_MAX 100.0f
 
 #define MINIMUM_SUBDIVISION_NUMBER 0
-// Only for the brave, or the willing to wait for O(N^2)
+// Only for the brave, every level takes 4x the memory of the previous one
 #define MAXIMUM_SUBDIVISION_NUMBER 8
 
 // Scale to/from integer values
@@ -1,6 +1,8 @@
 #include "RenderWidget.h"
 
-#include <cmath>
+#include <algorithm>
+
+#include <QElapsedTimer>
 
 #ifdef __APPLE__
 #include <OpenGL/gl.h>
@@ -8,7 +10,8 @@
 #include <GL/gl.h>
 #endif
 
-#include "SphereVertices.h"
+// frames kept for the percentiles of the statistics overlay, a couple of seconds at 60 Hz
+constexpr unsigned int FRAME_HISTORY_LENGTH = 120;
 
 RenderWidget::RenderWidget(
     TriangleMesh* triangleMesh,
@@ -16,142 +19,117 @@ RenderWidget::RenderWidget(
     QWidget* parent
 ) : QOpenGLWidget(parent),
     renderParameters(renderParameters),
-    triangleMesh(triangleMesh) {
+    triangleMesh(triangleMesh),
+    frameMilliseconds(0.0),
+    frameFaceCount(0),
+    recentFrames(FRAME_HISTORY_LENGTH),
+    isSynchronised(false),
+    queriedSubmissionMilliseconds({0.0, 0.0}),
+    queriedFaceCounts({0, 0}),
+    isQueryPending({false, false}),
+    frameNumber(0) {
 }
 
-void RenderWidget::initializeGL() {
-    glShadeModel(GL_SMOOTH);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_LIGHTING);
-    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+RenderWidget::~RenderWidget() {
+    // buffers & queries belong to the context of the widget
+    makeCurrent();
+    sceneRenderer.destroy();
+    for (QOpenGLTimerQuery& query : frameQueries) {
+        query.destroy();
+    }
+    doneCurrent();
 }
 
-void RenderWidget::resizeGL(const int width, const int height) {
-    glViewport(0, 0, width, height);
+double RenderWidget::millisecondsPerFace() const {
+    return frameFaceCount == 0 ? 0.0 : frameMilliseconds / frameFaceCount;
+}
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+float RenderWidget::culledFraction() const {
+    return sceneRenderer.culledFraction();
+}
 
-    const float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+double RenderWidget::lastFrameMilliseconds() const {
+    return frameMilliseconds;
+}
 
-    // we want to capture a sphere of radius 1.0 without distortion
-    // so we set the ortho projection based on whether the window is portrait (> 1.0) or landscape
-    if (aspectRatio > 1.0) {
-        // portrait ratio is wider, so make bottom & top -1.0 & 1.0
-        glOrtho(-aspectRatio, aspectRatio, -1.0, 1.0, -1.1, 1.1);
-    } else {
-        // otherwise, make left & right -1.0 & 1.0
-        glOrtho(-1.0, 1.0, -1.0 / aspectRatio, 1.0 / aspectRatio, -1.1, 1.1);
-    }
+double RenderWidget::lastSubmissionMilliseconds() const {
+    return sceneRenderer.lastSubmissionMilliseconds();
 }
 
-void RenderWidget::paintGL() {
-    glEnable(GL_DEPTH_TEST);
-
-    glClearColor(0.8, 0.8, 0.6, 1.0);
-    glEnable(GL_LIGHTING);
-
-    // clear the buffer
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // set model view matrix based on stored translation, rotation &c.
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    // set light position first, pushing/popping matrix so that it the transformation does
-    // not affect the position of the geometric object
-    glPushMatrix();
-    glMultMatrixf(reinterpret_cast<GLfloat*>(renderParameters->lightMatrix.columnMajor().coordinates));
-    glLightfv(GL_LIGHT0, GL_POSITION, renderParameters->lightPosition.data());
-    glPopMatrix();
-
-    // translate by the visual translation
-    glTranslatef(renderParameters->xTranslate, renderParameters->yTranslate, 0.0f);
-
-    // apply rotation matrix from arcball
-    glMultMatrixf(reinterpret_cast<GLfloat*>(renderParameters->rotationMatrix.columnMajor().coordinates));
-
-    // render triangle mesh
-    renderMesh();
-}
-
-void RenderWidget::renderMesh() const {
-    // Ideally, we would apply a global transformation to the object, but sadly that breaks down
-    // when we want to scale things, as unless we normalise the normal vectors, we end up affecting
-    // the illumination.  Known solutions include:
-    // 1.   Normalising the normal vectors
-    // 2.   Explicitly dividing the normal vectors by the scale to balance
-    // 3.   Scaling only the vertex position (slower, but safer)
-    // 4.   Not allowing spatial zoom (note: sniper scopes are a modified projection matrix)
-    //
-    // Inside a game engine, zoom usually doesn't apply. Normalisation of normal vectors is expensive,
-    // so we will choose option 2.
-    float scale = renderParameters->zoomScale;
-    scale /= triangleMesh->objectSize;
-    glScalef(scale, scale, scale);
-
-    const Cartesian3 centreOfGravity = triangleMesh->centreOfGravity;
-    glTranslatef(-centreOfGravity.x, -centreOfGravity.y, -centreOfGravity.z);
-
-    // render triangles
-    glBegin(GL_TRIANGLES);
-
-    // set colour for pick render - ignored for regular render
-    glColor3f(1.0, 1.0, 1.0);
-
-    // loop through the faces
-    for (unsigned int face = 0; face < triangleMesh->faceVertices.size(); face += 3) {
-        if (renderParameters->useFlatNormals) {
-            const auto& p = triangleMesh->vertices[triangleMesh->faceVertices[face]];
-            const auto& q = triangleMesh->vertices[triangleMesh->faceVertices[face + 1]];
-            const auto& r = triangleMesh->vertices[triangleMesh->faceVertices[face + 2]];
-
-            // Compute flat face normal
-            Cartesian3 pq = q - p;
-            Cartesian3 pr = r - p;
-            const Cartesian3 faceNormal = pq.cross(pr).unit();
-
-            glNormal3f(faceNormal.x * scale, faceNormal.y * scale, faceNormal.z * scale);
-        }
+const FrameStatistics& RenderWidget::frameStatistics() const {
+    return recentFrames;
+}
 
-        for (unsigned int vertex = face; vertex < face + 3; vertex++) {
-            const auto faceVertex = triangleMesh->faceVertices[vertex];
-            if (!renderParameters->useFlatNormals) {
-                // hard assumption: we have enough normals
-                glNormal3f(
-                    triangleMesh->normals[faceVertex].x * scale,
-                    triangleMesh->normals[faceVertex].y * scale,
-                    triangleMesh->normals[faceVertex].z * scale
-                );
-            }
-
-            glVertex3f(
-                triangleMesh->vertices[faceVertex].x,
-                triangleMesh->vertices[faceVertex].y,
-                triangleMesh->vertices[faceVertex].z
-            );
-        }
+bool RenderWidget::isRetained() const {
+    return sceneRenderer.isRetained();
+}
+
+void RenderWidget::select(std::optional<MeshSelection> selection) {
+    sceneRenderer.select(std::move(selection));
+}
+
+void RenderWidget::setSynchronised(const bool synchronised) {
+    isSynchronised = synchronised;
+}
+
+void RenderWidget::initializeGL() {
+    sceneRenderer.initialise(renderParameters->forceImmediateMode);
+    for (QOpenGLTimerQuery& query : frameQueries) {
+        query.create();
     }
+}
+
+void RenderWidget::resizeGL(const int width, const int height) {
+    sceneRenderer.resize(width, height);
+}
 
-    glEnd();
+/**
+ * @brief Times the frame without waiting for the GPU: a timer query around it is read back while the next
+ *        frame is drawn, by which time the GPU is done with it unless it lags more than a frame behind,
+ *        when the reading is skipped. A frame costs the longer of its submission & its GPU time
+ */
+void RenderWidget::paintGL() {
+    QElapsedTimer frameTimer;
+    frameTimer.start();
 
-    if (!renderParameters->showVertices) {
-        return;
+    const unsigned int slot = frameNumber % frameQueries.size();
+    const bool isQueried = !isSynchronised && frameQueries[slot].isCreated();
+    if (isQueried) {
+        frameQueries[slot].begin();
     }
 
-    glDisable(GL_LIGHTING);
-
-    // loop through the vertices
-    for (const auto& vertex : triangleMesh->vertices) {
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glTranslatef(vertex.x, vertex.y, vertex.z);
-        glScalef(0.1f * renderParameters->vertexSize,
-                 0.1f * renderParameters->vertexSize,
-                 0.1f * renderParameters->vertexSize);
-        renderTriangulatedSphere();
-        glPopMatrix();
+    sceneRenderer.render(*triangleMesh, *renderParameters,
+                         std::min(width(), height()) * static_cast<float>(devicePixelRatioF()));
+    const unsigned int faceCount = triangleMesh->faceVertices.size() / 3;
+
+    if (isSynchronised) {
+        glFinish();
+        recordFrame(frameTimer.nsecsElapsed() / 1e6, faceCount);
+    } else if (isQueried) {
+        frameQueries[slot].end();
+        queriedSubmissionMilliseconds[slot] = frameTimer.nsecsElapsed() / 1e6;
+        queriedFaceCounts[slot] = faceCount;
+        isQueryPending[slot] = true;
+
+        const unsigned int previous = (slot + 1) % frameQueries.size();
+        if (isQueryPending[previous] && frameQueries[previous].isResultAvailable()) {
+            const double gpuMilliseconds = frameQueries[previous].waitForResult() / 1e6;
+            recordFrame(std::max(queriedSubmissionMilliseconds[previous], gpuMilliseconds),
+                        queriedFaceCounts[previous]);
+        }
+        isQueryPending[previous] = false;
+    } else {
+        recordFrame(frameTimer.nsecsElapsed() / 1e6, faceCount);
     }
+    frameNumber++;
+
+    emit frameRendered();
+}
+
+void RenderWidget::recordFrame(const double milliseconds, const unsigned int faceCount) {
+    frameMilliseconds = milliseconds;
+    frameFaceCount = faceCount;
+    recentFrames.record(frameMilliseconds);
 }
 
 void RenderWidget::mousePressEvent(QMouseEvent* event) {
@@ -167,6 +145,12 @@ void RenderWidget::mousePressEvent(QMouseEvent* event) {
         whichButton = Qt::RightButton;
     }
 
+    // ctrl-click picks instead, & the drag that follows it moves nothing
+    if (event->modifiers() & Qt::ControlModifier) {
+        emit pickAt((2.0f * event->x() - width()) / size, (height() - 2.0f * event->y()) / size);
+        whichButton = Qt::NoButton;
+    }
+
     emit beginScaledDrag(whichButton, x, y);
 }
 
@@ -1,9 +1,14 @@
 #ifndef RENDER_WIDGET_H
 #define RENDER_WIDGET_H
 
+#include <array>
+
+#include <QOpenGLTimerQuery>
 #include <QOpenGLWidget>
 #include <QMouseEvent>
 
+#include "FrameStatistics.h"
+#include "SceneRenderer.h"
 #include "TriangleMesh.h"
 #include "RenderParameters.h"
 
@@ -13,6 +18,25 @@ class RenderWidget : public QOpenGLWidget {
 
     RenderParameters* renderParameters;
 
+    SceneRenderer sceneRenderer;
+
+    // duration of the last frame timed, until the GPU finished it, & the faces it drew.
+    // A frame late, from timer queries, unless frames are synchronised
+    double frameMilliseconds;
+    unsigned int frameFaceCount;
+    FrameStatistics recentFrames;
+
+    // whether paintGL waits for the GPU, timing every frame as it is drawn, e.g. while recording
+    bool isSynchronised;
+    // GPU time of alternate frames, each read back while the next one is drawn, so that nothing waits.
+    // Not created where timer queries are unsupported, frames then being timed on the CPU only
+    std::array<QOpenGLTimerQuery, 2> frameQueries;
+    // of the frame each query times, until its result is read
+    std::array<double, 2> queriedSubmissionMilliseconds;
+    std::array<unsigned int, 2> queriedFaceCounts;
+    std::array<bool, 2> isQueryPending;
+    unsigned int frameNumber;
+
 public:
     TriangleMesh* triangleMesh;
 
@@ -22,6 +46,31 @@ public:
         QWidget* parent
     );
 
+    ~RenderWidget();
+
+    // estimated from the last frame, 0 until something was drawn
+    double millisecondsPerFace() const;
+
+    // share of the faces of the last frame skipped by meshlet culling
+    float culledFraction() const;
+
+    double lastFrameMilliseconds() const;
+
+    double lastSubmissionMilliseconds() const;
+
+    // durations of the last FRAME_HISTORY_LENGTH frames
+    const FrameStatistics& frameStatistics() const;
+
+    // whether the mesh is drawn from buffer objects rather than in immediate mode
+    bool isRetained() const;
+
+    // highlights selection from the next frame on
+    void select(std::optional<MeshSelection> selection);
+
+    // waits for the GPU at the end of every frame from now on, so that lastFrameMilliseconds is of the frame
+    // just drawn, at the cost of draining the pipeline. Off by default, as it slows down interaction
+    void setSynchronised(bool synchronised);
+
 protected:
     void initializeGL();
 
@@ -36,7 +85,7 @@ protected:
     void mouseReleaseEvent(QMouseEvent* event);
 
 private:
-    void renderMesh() const;
+    void recordFrame(double milliseconds, unsigned int faceCount);
 
 signals:
     // these are general purpose signals, which scale the drag to
@@ -46,6 +95,12 @@ signals:
     void continueScaledDrag(float x, float y);
 
     void endScaledDrag(float x, float y);
+
+    // ctrl-click, in eye coordinates where the shorter side spans [-1, 1]
+    void pickAt(float x, float y);
+
+    // emitted at the end of every paintGL, once frame statistics are up to date
+    void frameRendered();
 };
 
 #endif
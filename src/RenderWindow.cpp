@@ -1,17 +1,54 @@
 #include "RenderWindow.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
 #include "RenderParameters.h"
 
+// frame time aimed at while dragging, coarser levels are displayed to stay under it
+constexpr double INTERACTIVE_FRAME_MILLISECONDS = 33.0;
+// time without input after which the selected level is displayed again
+constexpr int INTERACTION_IDLE_MILLISECONDS = 200;
+// distance in pixels between the statistics overlay & the corner of the render widget
+constexpr int STATISTICS_MARGIN = 8;
+// near plane of the projection of SceneRenderer, picking rays start on it
+constexpr float EYE_NEAR_DEPTH = 1.1f;
+
+/**
+ * @brief Faces around vertexId, stopping at a boundary
+ */
+static std::vector<FaceIndex> oneRingFaces(const TriangleMesh& mesh, const VertexId vertexId) {
+    std::vector<FaceIndex> faces;
+
+    const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+    EdgeId currentEdge = firstEdge;
+    do {
+        faces.push_back(currentEdge / 3);
+        const EdgeId otherEdge = mesh.otherHalf[currentEdge];
+        if (otherEdge == NO_VALUE) {
+            break;
+        }
+        currentEdge = TriangleMesh::nextIdInFace(otherEdge);
+    } while (currentEdge != firstEdge);
+
+    return faces;
+}
+
 RenderWindow::RenderWindow(
     TriangleMesh* triangleMesh,
     RenderParameters* renderParameters,
     const std::string& windowName
 ) : QWidget(nullptr),
-    renderParameters(renderParameters) {
+    renderParameters(renderParameters),
+    interacting(false),
+    dirtyFlags(0),
+    flushScheduled(false),
+    inputCount(0),
+    repaintCount(0),
+    flushMilliseconds(0.0) {
     // Consider subdivisions[0] as first surface
-    this->subdivisions = {*triangleMesh};
+    this->subdivisions = {{0, *triangleMesh}};
 
     setWindowTitle(QString(windowName.c_str()));
 
@@ -19,11 +56,18 @@ RenderWindow::RenderWindow(
 
     renderWidget = new RenderWidget(triangleMesh, renderParameters, this);
 
+    interactionIdleTimer = new QTimer(this);
+    interactionIdleTimer->setSingleShot(true);
+    interactionIdleTimer->setInterval(INTERACTION_IDLE_MILLISECONDS);
+    connect(interactionIdleTimer, &QTimer::timeout, this, &RenderWindow::endInteraction);
+
     lightRotator = new ArcBallWidget(this);
     modelRotator = new ArcBallWidget(this);
 
     showVerticesBox = new QCheckBox("Show Vertices", this);
+    showWireframeBox = new QCheckBox("Show Wireframe", this);
     flatNormalsBox = new QCheckBox("Flat Normals", this);
+    showStatisticsBox = new QCheckBox("Show Statistics", this);
     writeHalfedgeFile = new QPushButton("Write .halfedge", this);
     writeObjFile = new QPushButton("Write .obj", this);
 
@@ -44,6 +88,13 @@ RenderWindow::RenderWindow(
                                              std::to_string(MAXIMUM_SUBDIVISION_NUMBER) + "]";
     subdivisionLabel = new QLabel(subdivisionLabelText.c_str(), this);
 
+    // child of the render widget so that it is composited over the mesh, without catching drags
+    statisticsLabel = new QLabel(renderWidget);
+    statisticsLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    statisticsLabel->setStyleSheet("QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 4px; }");
+    statisticsLabel->move(STATISTICS_MARGIN, STATISTICS_MARGIN);
+    connect(renderWidget, &RenderWidget::frameRendered, this, &RenderWindow::updateStatistics);
+
     // Add the widgets to the grid | Row | Column | Row Span | Column Span |
 
     // the top two widgets have to fit to the widgets stack between them
@@ -62,6 +113,8 @@ RenderWindow::RenderWindow(
     windowLayout->addWidget(showVerticesBox, 5, 3, 1, 1);
     windowLayout->addWidget(writeHalfedgeFile, 6, 3, 1, 1);
     windowLayout->addWidget(writeObjFile, 7, 3, 1, 1);
+    windowLayout->addWidget(showStatisticsBox, 8, 3, 1, 1);
+    windowLayout->addWidget(showWireframeBox, 9, 3, 1, 1);
 
     // Translate Slider Row
     windowLayout->addWidget(xTranslateSlider, nStacked, 1, 1, 1);
@@ -77,24 +130,71 @@ RenderWindow::RenderWindow(
     windowLayout->addWidget(subdivisionSlider, nStacked + 2, 1, 1, 1);
     windowLayout->addWidget(subdivisionLabel, nStacked + 2, 2, 1, 1);
 
-    resetInterface();
+    synchroniseControls();
+    updateDisplayedMesh();
 }
 
-// sets every visual control to match the model
-void RenderWindow::resetInterface() {
-    // Check if subdivisions need to be generated
-    for (unsigned int i = subdivisions.size(); i <= renderParameters->subdivisionNumber; i++) {
-        std::cout << "Generating Subdivision " << i << "..." << std::endl;
-        TriangleMesh subdivision = subdivisions[i - 1].subdivide();
-        subdivisions.push_back(subdivision);
-        std::cout << "Finished generating Subdivision " << i << std::endl;
+void RenderWindow::inputChanged(const unsigned int dirty) {
+    inputCount++;
+    markDirty(dirty);
+}
+
+void RenderWindow::markDirty(const unsigned int dirty) {
+    dirtyFlags |= dirty;
+
+    // everything marked until control returns to the event loop is flushed at once
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QTimer::singleShot(0, this, &RenderWindow::flushUpdates);
+    }
+}
+
+/**
+ * @brief Brings the window up to date with what was marked dirty since the last flush. Repaints requested
+ *        before the next frame are merged by Qt, & that frame waits on the vsync of the window
+ */
+void RenderWindow::flushUpdates() {
+    QElapsedTimer flushTimer;
+    flushTimer.start();
+
+    const unsigned int dirty = dirtyFlags;
+    dirtyFlags = 0;
+    flushScheduled = false;
+
+    if (dirty & DIRTY_LEVEL) {
+        updateDisplayedMesh();
     }
-    // Render target subdivision, guaranteed to be ready by this point
-    renderWidget->triangleMesh = &subdivisions[renderParameters->subdivisionNumber];
+
+    if (dirty & DIRTY_ROTATORS) {
+        modelRotator->update();
+        lightRotator->update();
+    }
+
+    if (dirty & (DIRTY_VIEW | DIRTY_LEVEL)) {
+        statisticsLabel->setVisible(renderParameters->showStatistics);
+        renderWidget->update();
+    }
+
+    flushMilliseconds = flushTimer.nsecsElapsed() / 1e6;
+}
+
+/**
+ * @brief Sets every control to match renderParameters, without the controls signalling back
+ */
+void RenderWindow::synchroniseControls() {
+    const QSignalBlocker blockers[] = {
+        QSignalBlocker(showVerticesBox), QSignalBlocker(showWireframeBox), QSignalBlocker(flatNormalsBox),
+        QSignalBlocker(showStatisticsBox),
+        QSignalBlocker(xTranslateSlider), QSignalBlocker(yTranslateSlider), QSignalBlocker(zoomSlider),
+        QSignalBlocker(subdivisionSlider), QSignalBlocker(vertexSizeSlider)
+    };
 
     // set check boxes
     showVerticesBox->setChecked(renderParameters->showVertices);
+    showWireframeBox->setChecked(renderParameters->showWireframe);
     flatNormalsBox->setChecked(renderParameters->useFlatNormals);
+    showStatisticsBox->setChecked(renderParameters->showStatistics);
+    statisticsLabel->setVisible(renderParameters->showStatistics);
 
     // set sliders
     // x & y translate are scaled to notional unit sphere in render widgets
@@ -123,16 +223,147 @@ void RenderWindow::resetInterface() {
     vertexSizeSlider->setMinimum(0);
     vertexSizeSlider->setMaximum(512);
     vertexSizeSlider->setValue(512 * renderParameters->vertexSize);
+}
+
+void RenderWindow::updateDisplayedMesh() {
+    // Check if the subdivision needs to be generated, from the deepest level kept below it
+    if (const unsigned int target = renderParameters->subdivisionNumber;
+        subdivisions.count(target) == 0) {
+        const auto& [baseLevel, baseMesh] = *std::prev(subdivisions.lower_bound(target));
+        std::cout << "Generating Subdivision " << target << "..." << std::endl;
+        // levels on the way are kept, as cheaper stand-ins while interacting
+        for (auto& [level, mesh] : baseMesh.subdivideLevels(target - baseLevel, [](unsigned int) { return true; })) {
+            subdivisions.emplace(baseLevel + level, std::move(mesh));
+        }
+        std::cout << "Finished generating Subdivision " << target << std::endl;
+    }
+    // Render target subdivision or its stand-in, guaranteed to be ready by this point
+    renderWidget->triangleMesh = &subdivisions[displayedLevel()];
+}
+
+void RenderWindow::continueInteraction() {
+    interacting = true;
+    interactionIdleTimer->start();
+}
+
+/**
+ * @brief Casts the ray through (x, y) along the view direction, inverting the modelview of SceneRenderer,
+ *        & selects the corner of the hit face closest to the hit
+ */
+void RenderWindow::pick(const float x, const float y) {
+    const auto displayed = std::find_if(subdivisions.begin(), subdivisions.end(), [this](const auto& level) {
+        return &level.second == renderWidget->triangleMesh;
+    });
+    const TriangleMesh& mesh = displayed->second;
+    const BoundingVolumeHierarchy& hierarchy = hierarchyFor(displayed->first);
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    const float scale = renderParameters->zoomScale / mesh.objectSize;
+    // rotations are orthogonal, so their inverse is their transpose
+    const Matrix4 inverseRotation = renderParameters->rotationMatrix.transpose();
+    const Cartesian3 eyeOrigin(x - renderParameters->xTranslate, y - renderParameters->yTranslate, EYE_NEAR_DEPTH);
+    const Cartesian3 origin = mesh.centreOfGravity + (inverseRotation * eyeOrigin) / scale;
+    const Cartesian3 direction = inverseRotation * Cartesian3(0.0f, 0.0f, -1.0f);
+
+    const auto hit = hierarchy.intersect(mesh, origin, direction, 2.0f * EYE_NEAR_DEPTH / scale);
+
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!hit.has_value()) {
+        std::cout << "Picked nothing in " << milliseconds << " ms" << std::endl;
+        renderWidget->select(std::nullopt);
+        return;
+    }
+
+    const unsigned int corner = std::max_element(hit->weights, hit->weights + 3) - hit->weights;
+    const VertexId vertexId = mesh.faceVertices[3 * hit->face + corner];
+    std::cout << "Picked face " << hit->face << " & vertex " << vertexId << " in " << milliseconds << " ms" << std::endl;
+
+    renderWidget->select(MeshSelection{&mesh, hit->face, vertexId, oneRingFaces(mesh, vertexId)});
+}
+
+const BoundingVolumeHierarchy& RenderWindow::hierarchyFor(const unsigned int level) {
+    if (const auto found = hierarchies.find(level); found != hierarchies.end()) {
+        return found->second;
+    }
+
+    // subdivisions keeps every level below a kept one
+    const TriangleMesh& mesh = subdivisions.at(level);
+    if (level == 0) {
+        std::cout << "Building bounding volume hierarchy of level 0..." << std::endl;
+        return hierarchies.emplace(level, BoundingVolumeHierarchy(mesh)).first->second;
+    }
+
+    const BoundingVolumeHierarchy& parent = hierarchyFor(level - 1);
+    std::cout << "Refitting bounding volume hierarchy of level " << level << "..." << std::endl;
+    return hierarchies.emplace(level, parent.subdivided(mesh)).first->second;
+}
+
+const TriangleMesh& RenderWindow::selectedMesh() {
+    return subdivisions[renderParameters->subdivisionNumber];
+}
+
+unsigned int RenderWindow::displayedLevel() const {
+    const unsigned int selected = renderParameters->subdivisionNumber;
+    const double millisecondsPerFace = renderWidget->millisecondsPerFace();
+    if (!interacting || millisecondsPerFace == 0.0) {
+        return selected;
+    }
+
+    // walk down the cached levels, level 0 is always there
+    auto level = subdivisions.upper_bound(selected);
+    do {
+        --level;
+        const double estimatedMilliseconds = millisecondsPerFace * level->second.faceVertices.size() / 3;
+        if (estimatedMilliseconds <= INTERACTIVE_FRAME_MILLISECONDS) {
+            return level->first;
+        }
+    } while (level != subdivisions.begin());
+
+    return level->first;
+}
+
+void RenderWindow::endInteraction() {
+    interacting = false;
+    markDirty(DIRTY_LEVEL);
+}
+
+/**
+ * @brief Refreshes the overlay after every frame, while it is shown
+ */
+void RenderWindow::updateStatistics() {
+    repaintCount++;
+
+    if (!renderParameters->showStatistics) {
+        return;
+    }
+
+    const FrameStatistics& frames = renderWidget->frameStatistics();
+    const TriangleMesh& mesh = *renderWidget->triangleMesh;
+    const auto displayed = std::find_if(subdivisions.begin(), subdivisions.end(), [&mesh](const auto& level) {
+        return &level.second == &mesh;
+    });
 
-    // flag them all for update
-    renderWidget->update();
-    modelRotator->update();
-    lightRotator->update();
-    xTranslateSlider->update();
-    yTranslateSlider->update();
-    zoomSlider->update();
-    vertexSizeSlider->update();
-    showVerticesBox->update();
-    flatNormalsBox->update();
-    subdivisionSlider->update();
+    statisticsLabel->setText(
+        QString("Frame: p50 %1 ms, p95 %2 ms, p99 %3 ms (%4)\n"
+                "Submission: %5 ms, last UI update: %6 ms\n"
+                "Level %7: %8 triangles, %9 vertices, %10 MiB\n"
+                "Meshlets culled: %11% of faces\n"
+                "Repaints: %12 for %13 inputs")
+        .arg(frames.percentile(50.0), 0, 'f', 2)
+        .arg(frames.percentile(95.0), 0, 'f', 2)
+        .arg(frames.percentile(99.0), 0, 'f', 2)
+        .arg(renderWidget->isRetained() ? "retained" : "immediate")
+        .arg(renderWidget->lastSubmissionMilliseconds(), 0, 'f', 2)
+        .arg(flushMilliseconds, 0, 'f', 2)
+        .arg(displayed == subdivisions.end() ? 0 : displayed->first)
+        .arg(mesh.faceVertices.size() / 3)
+        .arg(mesh.vertices.size())
+        .arg(mesh.memoryFootprint() / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(100.0f * renderWidget->culledFraction(), 0, 'f', 1)
+        .arg(repaintCount)
+        .arg(inputCount));
+    statisticsLabel->adjustSize();
 }
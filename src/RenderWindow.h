@@ -4,12 +4,20 @@
 #include <QtWidgets>
 
 #include "ArcBallWidget.h"
+#include "BoundingVolumeHierarchy.h"
 #include "RenderWidget.h"
 
 // window that displays a geometric model with controls
 class RenderWindow : public QWidget {
-    // subdivision[renderParameters->subdivisionNumber] is the one displayed
-    std::vector<TriangleMesh> subdivisions;
+    // subdivisions[renderParameters->subdivisionNumber] is the one selected,
+    // only the levels that have been selected & those generated on the way are kept
+    std::map<unsigned int, TriangleMesh> subdivisions;
+    // by level of subdivisions, built on the first pick of that level
+    std::map<unsigned int, BoundingVolumeHierarchy> hierarchies;
+
+    // while interacting, a coarser level may be displayed instead of the selected one
+    bool interacting;
+    QTimer* interactionIdleTimer;
 
     RenderParameters* renderParameters;
 
@@ -21,6 +29,8 @@ class RenderWindow : public QWidget {
 
     QCheckBox* flatNormalsBox;
     QCheckBox* showVerticesBox;
+    QCheckBox* showWireframeBox;
+    QCheckBox* showStatisticsBox;
     QPushButton* writeHalfedgeFile;
     QPushButton* writeObjFile;
 
@@ -39,6 +49,19 @@ class RenderWindow : public QWidget {
     QLabel* vertexSizeLabel;
     QLabel* subdivisionLabel;
 
+    // overlay on top of renderWidget, with the statistics of the recent frames
+    QLabel* statisticsLabel;
+
+    // DirtyFlags marked since the last flush
+    unsigned int dirtyFlags;
+    bool flushScheduled;
+
+    // inputs received from the controller & frames drawn since the window opened
+    unsigned int inputCount;
+    unsigned int repaintCount;
+    // duration of the last flush, including any subdivision it generated
+    double flushMilliseconds;
+
 public:
     RenderWindow(
         TriangleMesh* triangleMesh,
@@ -46,10 +69,53 @@ public:
         const std::string& windowName = "Half-Edge Renderer"
     );
 
-    void resetInterface();
+    // what an input left out of date
+    enum DirtyFlags : unsigned int {
+        // the render widget needs repainting
+        DIRTY_VIEW = 1u << 0,
+        // the arcball widgets need repainting
+        DIRTY_ROTATORS = 1u << 1,
+        // the level displayed may have changed, which also repaints the render widget
+        DIRTY_LEVEL = 1u << 2
+    };
+
+    // to be called by the controller once renderParameters reflect an input,
+    // dirty being DirtyFlags, applied on the next pass of the event loop
+    void inputChanged(unsigned int dirty);
+
+    // to be called on every step of a drag, displays a cheaper level until input goes idle
+    void continueInteraction();
+
+    const TriangleMesh& selectedMesh();
+
+    // selects the face & vertex of the displayed mesh under (x, y), in the eye coordinates of the render
+    // widget, or clears the selection if there is none. Takes effect on the next repaint
+    void pick(float x, float y);
 
-    // declare the render controller class a friend so it can access the UI elements
+    // declare the render controller & frame recorder classes friends so they can access the UI elements
     friend class RenderController;
+    friend class FrameRecorder;
+
+private:
+    void markDirty(unsigned int dirty);
+
+    void flushUpdates();
+
+    // sets every control to match renderParameters
+    void synchroniseControls();
+
+    // generates the selected level if needed, then displays it or its interaction stand-in
+    void updateDisplayedMesh();
+
+    // deepest cached level, up to the selected one, estimated to draw within INTERACTIVE_FRAME_MILLISECONDS
+    unsigned int displayedLevel() const;
+
+    void endInteraction();
+
+    // built from the hierarchy of the level below if there is one, which is cheaper than building anew
+    const BoundingVolumeHierarchy& hierarchyFor(unsigned int level);
+
+    void updateStatistics();
 };
 
 #endif
@@ -0,0 +1,191 @@
+#include "SceneRenderer.h"
+
+#include <chrono>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// tilt of the sweep axis towards the viewer, so that the top & bottom of the model come into view
+constexpr float SWEEP_TILT_DEGREES = 30.0f;
+
+// highlight of the picked face, the rest of its vertex one-ring & the vertex itself
+constexpr GLfloat PICKED_FACE_COLOUR[3] = {0.9f, 0.2f, 0.1f};
+constexpr GLfloat RING_FACE_COLOUR[3] = {1.0f, 0.65f, 0.2f};
+constexpr GLfloat PICKED_VERTEX_COLOUR[3] = {0.1f, 0.2f, 0.9f};
+constexpr GLfloat PICKED_VERTEX_PIXELS = 8.0f;
+
+SceneRenderer::SceneRenderer()
+    : submissionMilliseconds(0.0) {
+}
+
+void SceneRenderer::initialise(const bool forceImmediateMode) {
+    glShadeModel(GL_SMOOTH);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_LIGHTING);
+    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+
+    if (forceImmediateMode) {
+        return;
+    }
+
+    meshRenderer.initialise();
+    vertexMarkerRenderer.initialise();
+}
+
+void SceneRenderer::resize(const int width, const int height) {
+    glViewport(0, 0, width, height);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+
+    const float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+
+    // we want to capture a sphere of radius 1.0 without distortion
+    // so we set the ortho projection based on whether the window is portrait (> 1.0) or landscape
+    if (aspectRatio > 1.0) {
+        // portrait ratio is wider, so make bottom & top -1.0 & 1.0
+        glOrtho(-aspectRatio, aspectRatio, -1.0, 1.0, -1.1, 1.1);
+    } else {
+        // otherwise, make left & right -1.0 & 1.0
+        glOrtho(-1.0, 1.0, -1.0 / aspectRatio, 1.0 / aspectRatio, -1.1, 1.1);
+    }
+}
+
+void SceneRenderer::render(const TriangleMesh& mesh,
+                           const RenderParameters& renderParameters,
+                           const float shortSidePixels) {
+    glEnable(GL_DEPTH_TEST);
+
+    glClearColor(0.8, 0.8, 0.6, 1.0);
+    glEnable(GL_LIGHTING);
+
+    // clear the buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // set model view matrix based on stored translation, rotation &c.
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // set light position first, pushing/popping matrix so that it the transformation does
+    // not affect the position of the geometric object
+    glPushMatrix();
+    glMultMatrixf(reinterpret_cast<const GLfloat*>(renderParameters.lightMatrix.columnMajor().coordinates));
+    glLightfv(GL_LIGHT0, GL_POSITION, renderParameters.lightPosition.data());
+    glPopMatrix();
+
+    // translate by the visual translation
+    glTranslatef(renderParameters.xTranslate, renderParameters.yTranslate, 0.0f);
+
+    // apply rotation matrix from arcball
+    glMultMatrixf(reinterpret_cast<const GLfloat*>(renderParameters.rotationMatrix.columnMajor().coordinates));
+
+    // Ideally, we would apply a global transformation to the object, but sadly that breaks down
+    // when we want to scale things, as unless we normalise the normal vectors, we end up affecting
+    // the illumination.  Known solutions include:
+    // 1.   Normalising the normal vectors
+    // 2.   Explicitly dividing the normal vectors by the scale to balance
+    // 3.   Scaling only the vertex position (slower, but safer)
+    // 4.   Not allowing spatial zoom (note: sniper scopes are a modified projection matrix)
+    //
+    // Inside a game engine, zoom usually doesn't apply. Normalisation of normal vectors is expensive,
+    // so we will choose option 2.
+    float scale = renderParameters.zoomScale;
+    scale /= mesh.objectSize;
+    glScalef(scale, scale, scale);
+
+    const Cartesian3 centreOfGravity = mesh.centreOfGravity;
+    glTranslatef(-centreOfGravity.x, -centreOfGravity.y, -centreOfGravity.z);
+
+    // faces are pushed back in depth so that the edges lying on them pass the depth test
+    if (renderParameters.showWireframe) {
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+    }
+
+    // render triangles, timing the CPU side only, the GPU catches up later
+    const auto submissionBegin = std::chrono::steady_clock::now();
+    meshRenderer.render(mesh, renderParameters.useFlatNormals, scale);
+    if (renderParameters.showWireframe) {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_LIGHTING);
+        meshRenderer.renderWireframe(mesh);
+    }
+    submissionMilliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submissionBegin).count();
+
+    if (selection.has_value() && selection->mesh == &mesh) {
+        renderSelection(mesh);
+    }
+
+    if (!renderParameters.showVertices) {
+        return;
+    }
+
+    glDisable(GL_LIGHTING);
+
+    // the projection maps [-1, 1] to the shorter side of the viewport
+    const float markerRadius = 0.1f * renderParameters.vertexSize;
+    const float pixelRadius = markerRadius * scale * shortSidePixels / 2.0f;
+    vertexMarkerRenderer.render(mesh, markerRadius, pixelRadius);
+}
+
+void SceneRenderer::destroy() {
+    meshRenderer.destroy();
+    vertexMarkerRenderer.destroy();
+}
+
+void SceneRenderer::select(std::optional<MeshSelection> selection) {
+    this->selection = std::move(selection);
+}
+
+float SceneRenderer::culledFraction() const {
+    return meshRenderer.culledFraction();
+}
+
+double SceneRenderer::lastSubmissionMilliseconds() const {
+    return submissionMilliseconds;
+}
+
+bool SceneRenderer::isRetained() const {
+    return meshRenderer.isRetained();
+}
+
+Matrix4 SceneRenderer::sweepRotation(const unsigned int frame, const unsigned int frameCount) {
+    const float degrees = 360.0f * static_cast<float>(frame) / static_cast<float>(frameCount);
+    return Matrix4::rotationX(SWEEP_TILT_DEGREES) * Matrix4::rotationY(degrees);
+}
+
+/**
+ * @brief Paints the one-ring faces unlit, pulled forward in depth over the same faces of the mesh,
+ *        & the vertex on top of everything
+ */
+void SceneRenderer::renderSelection(const TriangleMesh& mesh) const {
+    glDisable(GL_LIGHTING);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f);
+
+    glBegin(GL_TRIANGLES);
+    for (const FaceIndex face : selection->ringFaces) {
+        glColor3fv(face == selection->face ? PICKED_FACE_COLOUR : RING_FACE_COLOUR);
+        for (unsigned int slot = 0; slot < 3; slot++) {
+            const Cartesian3& vertex = mesh.vertices[mesh.faceVertices[3 * face + slot]];
+            glVertex3f(vertex.x, vertex.y, vertex.z);
+        }
+    }
+    glEnd();
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    glDisable(GL_DEPTH_TEST);
+    glPointSize(PICKED_VERTEX_PIXELS);
+    glColor3fv(PICKED_VERTEX_COLOUR);
+    glBegin(GL_POINTS);
+    const Cartesian3& vertex = mesh.vertices[selection->vertex];
+    glVertex3f(vertex.x, vertex.y, vertex.z);
+    glEnd();
+    glPointSize(1.0f);
+    glEnable(GL_DEPTH_TEST);
+}
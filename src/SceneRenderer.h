@@ -0,0 +1,69 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <optional>
+#include <vector>
+
+#include "Matrix4.h"
+#include "MeshRenderer.h"
+#include "RenderParameters.h"
+#include "TriangleMesh.h"
+#include "VertexMarkerRenderer.h"
+
+// face & vertex picked on a mesh, highlighted along with the faces around the vertex
+struct MeshSelection {
+    const TriangleMesh* mesh;
+    FaceIndex face;
+    VertexId vertex;
+    // one-ring of vertex, face among them
+    std::vector<FaceIndex> ringFaces;
+};
+
+/**
+ * Draws the scene of the viewer, a lit mesh with optional vertex markers, into whatever
+ * framebuffer is bound, so that the window & offscreen benchmarks render the same frames.
+ *
+ * Every call must be made with the GL context current.
+ */
+class SceneRenderer {
+    MeshRenderer meshRenderer;
+    VertexMarkerRenderer vertexMarkerRenderer;
+
+    // CPU time spent issuing the draws of the mesh within the last render
+    double submissionMilliseconds;
+
+    // only drawn over the mesh it was picked on
+    std::optional<MeshSelection> selection;
+
+public:
+    SceneRenderer();
+
+    // immediate mode leaves the renderers uninitialised, so that they fall back to it
+    void initialise(bool forceImmediateMode);
+
+    // fits a sphere of radius 1 to the shorter side of the viewport
+    void resize(int width, int height);
+
+    // shortSidePixels is the number of pixels across the shorter side of the viewport
+    void render(const TriangleMesh& mesh, const RenderParameters& renderParameters, float shortSidePixels);
+
+    void destroy();
+
+    void select(std::optional<MeshSelection> selection);
+
+    // share of the faces of the last frame skipped by meshlet culling
+    float culledFraction() const;
+
+    double lastSubmissionMilliseconds() const;
+
+    // whether the mesh is drawn from buffer objects rather than in immediate mode
+    bool isRetained() const;
+
+    // step frame of a deterministic sweep turning the model once around its tilted vertical axis
+    static Matrix4 sweepRotation(unsigned int frame, unsigned int frameCount);
+
+private:
+    void renderSelection(const TriangleMesh& mesh) const;
+};
+
+#endif
@@ -0,0 +1,349 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include <QImage>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Parallel.h"
+
+// side of the square tiles, a multiple of the pixels evaluated at once
+constexpr int TILE_SIZE = 64;
+constexpr int LANES = 4;
+
+// fixed-function defaults: global ambient 0.2 on material ambient 0.2, white light 0 on material diffuse 0.8
+constexpr float AMBIENT_INTENSITY = 0.2f * 0.2f;
+constexpr float DIFFUSE_INTENSITY = 0.8f;
+
+// clear colour of SceneRenderer
+constexpr std::array<uint8_t, 4> BACKGROUND = {204, 204, 153, 255};
+
+// near & far planes of the projection of SceneRenderer, in eye coordinates
+constexpr float DEPTH_RANGE = 1.1f;
+
+// a * dx + b * dy + c, dx & dy in pixels from the corner of the bounding box of a triangle
+struct Plane {
+    float a, b, c;
+};
+
+// everything the tiles need to rasterize a triangle
+struct TriangleSetup {
+    // bounding box of the pixels whose centres the triangle may cover, inclusive, empty if minX > maxX
+    int minX, minY, maxX, maxY;
+
+    // edge k is opposite corner k & positive inside
+    std::array<Plane, 3> edges;
+    // whether the pixel centres lying exactly on edge k belong to this triangle rather than its neighbour
+    std::array<bool, 3> ownsEdge;
+
+    // window depth in [0, 1]
+    Plane depth;
+    Plane intensity;
+};
+
+// pixels of one tile, rows from the bottom like window coordinates
+struct Tile {
+    alignas(16) std::array<float, TILE_SIZE * TILE_SIZE> depth;
+    alignas(16) std::array<float, TILE_SIZE * TILE_SIZE> intensity;
+};
+
+/**
+ * @brief Edge functions & interpolation planes of the triangle with the given window positions
+ *        & intensities, computed in double precision relative to its bounding box so that small
+ *        triangles far from the origin keep their precision
+ */
+static TriangleSetup setUpTriangle(const std::array<Cartesian3, 3>& corners,
+                                   const std::array<float, 3>& intensities,
+                                   const int width,
+                                   const int height) {
+    TriangleSetup setup{};
+
+    double minX = corners[0].x, maxX = minX, minY = corners[0].y, maxY = minY;
+    for (const Cartesian3& corner : corners) {
+        minX = std::min<double>(minX, corner.x);
+        maxX = std::max<double>(maxX, corner.x);
+        minY = std::min<double>(minY, corner.y);
+        maxY = std::max<double>(maxY, corner.y);
+    }
+
+    // pixel x covers the centre x + 0.5
+    setup.minX = std::max(0, static_cast<int>(std::ceil(minX - 0.5)));
+    setup.maxX = std::min(width - 1, static_cast<int>(std::floor(maxX - 0.5)));
+    setup.minY = std::max(0, static_cast<int>(std::ceil(minY - 0.5)));
+    setup.maxY = std::min(height - 1, static_cast<int>(std::floor(maxY - 0.5)));
+
+    // corners relative to the centre of the first pixel of the bounding box
+    const double originX = setup.minX + 0.5;
+    const double originY = setup.minY + 0.5;
+    std::array<std::array<double, 3>, 3> edges{};
+    for (int k = 0; k < 3; k++) {
+        const Cartesian3& from = corners[(k + 1) % 3];
+        const Cartesian3& to = corners[(k + 2) % 3];
+        const double fromX = from.x - originX, fromY = from.y - originY;
+        const double toX = to.x - originX, toY = to.y - originY;
+        edges[k] = {fromY - toY, toX - fromX, fromX * toY - fromY * toX};
+    }
+
+    // twice the signed area, the value of edge 0 at corner 0
+    double area = edges[0][0] * (corners[0].x - originX) + edges[0][1] * (corners[0].y - originY) + edges[0][2];
+    if (area == 0.0) {
+        setup.minX = setup.maxX + 1;
+        return setup;
+    }
+
+    // both windings are drawn, as face culling is off
+    if (area < 0.0) {
+        area = -area;
+        for (auto& edge : edges) {
+            for (double& coefficient : edge) {
+                coefficient = -coefficient;
+            }
+        }
+    }
+
+    std::array<double, 3> depth{};
+    std::array<double, 3> intensity{};
+    for (int k = 0; k < 3; k++) {
+        const auto& edge = edges[k];
+        setup.edges[k] = {static_cast<float>(edge[0]), static_cast<float>(edge[1]), static_cast<float>(edge[2])};
+        // an edge shared by two triangles has opposite coefficients in each, so exactly one owns it
+        setup.ownsEdge[k] = edge[0] > 0.0 || (edge[0] == 0.0 && edge[1] > 0.0);
+
+        // edge k divided by the area is the barycentric weight of corner k
+        for (int coefficient = 0; coefficient < 3; coefficient++) {
+            depth[coefficient] += corners[k].z * edge[coefficient] / area;
+            intensity[coefficient] += intensities[k] * edge[coefficient] / area;
+        }
+    }
+    setup.depth = {static_cast<float>(depth[0]), static_cast<float>(depth[1]), static_cast<float>(depth[2])};
+    setup.intensity = {static_cast<float>(intensity[0]), static_cast<float>(intensity[1]), static_cast<float>(intensity[2])};
+
+    return setup;
+}
+
+/**
+ * @brief Depth tests & writes the pixels of setup within the tile whose bottom left pixel is (tileX, tileY),
+ *        LANES adjacent pixels of a row at a time
+ */
+static void rasterizeTriangle(const TriangleSetup& setup, const int tileX, const int tileY, Tile& tile) {
+    const int x0 = std::max(setup.minX, tileX);
+    const int x1 = std::min(setup.maxX, tileX + TILE_SIZE - 1);
+    const int y0 = std::max(setup.minY, tileY);
+    const int y1 = std::min(setup.maxY, tileY + TILE_SIZE - 1);
+
+    // runs of lanes start at multiples of LANES within the tile, the lanes outside [x0, x1] are masked
+    const int firstX = tileX + (x0 - tileX) / LANES * LANES;
+
+    for (int y = y0; y <= y1; y++) {
+        const float dy = static_cast<float>(y - setup.minY);
+        float* depthRow = tile.depth.data() + (y - tileY) * TILE_SIZE - tileX;
+        float* intensityRow = tile.intensity.data() + (y - tileY) * TILE_SIZE - tileX;
+
+        std::array<float, 3> rowEdges{};
+        for (int k = 0; k < 3; k++) {
+            rowEdges[k] = setup.edges[k].b * dy + setup.edges[k].c;
+        }
+        const float rowDepth = setup.depth.b * dy + setup.depth.c;
+        const float rowIntensity = setup.intensity.b * dy + setup.intensity.c;
+
+#ifdef __SSE2__
+        const __m128 laneOffsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (int x = firstX; x <= x1; x += LANES) {
+            const __m128 columns = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+            const __m128 dx = _mm_add_ps(_mm_set1_ps(static_cast<float>(x - setup.minX)), laneOffsets);
+
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(columns, _mm_set1_ps(static_cast<float>(x0))),
+                                       _mm_cmple_ps(columns, _mm_set1_ps(static_cast<float>(x1))));
+            for (int k = 0; k < 3; k++) {
+                const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.edges[k].a), dx),
+                                               _mm_set1_ps(rowEdges[k]));
+                inside = _mm_and_ps(inside, setup.ownsEdge[k] ? _mm_cmpge_ps(edge, zero) : _mm_cmpgt_ps(edge, zero));
+            }
+            if (_mm_movemask_ps(inside) == 0) {
+                continue;
+            }
+
+            const __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.depth.a), dx), _mm_set1_ps(rowDepth));
+            const __m128 storedDepth = _mm_load_ps(depthRow + x);
+            // in front of the near plane is clipped, behind the far plane never passes
+            inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(depth, storedDepth), _mm_cmpge_ps(depth, zero)));
+
+            const __m128 intensity = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.intensity.a), dx),
+                                                _mm_set1_ps(rowIntensity));
+            const __m128 storedIntensity = _mm_load_ps(intensityRow + x);
+
+            _mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, depth), _mm_andnot_ps(inside, storedDepth)));
+            _mm_store_ps(intensityRow + x,
+                         _mm_or_ps(_mm_and_ps(inside, intensity), _mm_andnot_ps(inside, storedIntensity)));
+        }
+#else
+        for (int x = firstX; x <= x1; x += LANES) {
+            for (int lane = 0; lane < LANES; lane++) {
+                const int column = x + lane;
+                const float dx = static_cast<float>(column - setup.minX);
+                bool inside = column >= x0 && column <= x1;
+                for (int k = 0; k < 3; k++) {
+                    const float edge = setup.edges[k].a * dx + rowEdges[k];
+                    inside = inside && (setup.ownsEdge[k] ? edge >= 0.0f : edge > 0.0f);
+                }
+
+                const float depth = setup.depth.a * dx + rowDepth;
+                if (inside && depth < depthRow[column] && depth >= 0.0f) {
+                    depthRow[column] = depth;
+                    intensityRow[column] = setup.intensity.a * dx + rowIntensity;
+                }
+            }
+        }
+#endif
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const unsigned int width, const unsigned int height)
+    : width(width),
+      height(height),
+      pixels(4 * width * height) {
+}
+
+/**
+ * @brief Lights the vertices or faces, sets up & bins the triangles in parallel slices of faces,
+ *        then rasterizes the tiles concurrently. Tiles go through the bins of every slice in order,
+ *        so that triangles at equal depth resolve in face order, as in GL
+ */
+void SoftwareRasterizer::render(const TriangleMesh& mesh, const RenderParameters& renderParameters) {
+    const unsigned int faceCount = mesh.faceVertices.size() / 3;
+    const bool useFlatNormals = renderParameters.useFlatNormals;
+
+    // modelview of SceneRenderer
+    const Matrix4& rotation = renderParameters.rotationMatrix;
+    const Cartesian3 translation(renderParameters.xTranslate, renderParameters.yTranslate, 0.0f);
+    const float scale = renderParameters.zoomScale / mesh.objectSize;
+
+    // projection of SceneRenderer, fitting [-1, 1] to the shorter side
+    const float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+    const float xScale = aspectRatio > 1.0f ? 1.0f / aspectRatio : 1.0f;
+    const float yScale = aspectRatio > 1.0f ? 1.0f : aspectRatio;
+
+    // directional light, transformed by lightMatrix only
+    const std::array<float, 4>& lightPosition = renderParameters.lightPosition;
+    const Cartesian3 light = (renderParameters.lightMatrix * Homogeneous4(
+        lightPosition[0], lightPosition[1], lightPosition[2], lightPosition[3])).Vector().unit();
+    const auto intensityOf = [&](const Cartesian3& normal) {
+        const Cartesian3 eyeNormal = (rotation * Homogeneous4(normal.x, normal.y, normal.z, 0.0f)).Vector().unit();
+        return std::min(1.0f, AMBIENT_INTENSITY + DIFFUSE_INTENSITY * std::max(0.0f, eyeNormal.dot(light)));
+    };
+
+    std::vector<Cartesian3> windowPositions(mesh.vertices.size());
+    std::vector<float> vertexIntensities(useFlatNormals ? 0 : mesh.vertices.size());
+    parallelFor(0, mesh.vertices.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            const Cartesian3 eye =
+                (rotation * ((mesh.vertices[vertexId] - mesh.centreOfGravity) * scale)) + translation;
+            windowPositions[vertexId] = Cartesian3(
+                (eye.x * xScale + 1.0f) * width / 2.0f,
+                (eye.y * yScale + 1.0f) * height / 2.0f,
+                (-eye.z / DEPTH_RANGE + 1.0f) / 2.0f
+            );
+
+            if (!useFlatNormals) {
+                // hard assumption: we have enough normals
+                vertexIntensities[vertexId] = intensityOf(mesh.normals[vertexId]);
+            }
+        }
+    });
+
+    const int tilesAcross = (static_cast<int>(width) + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesDown = (static_cast<int>(height) + TILE_SIZE - 1) / TILE_SIZE;
+    const unsigned int tileCount = tilesAcross * tilesDown;
+    const unsigned int sliceCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // bins[slice][tile] lists the faces of the slice overlapping the tile
+    std::vector<TriangleSetup> setups(faceCount);
+    std::vector<std::vector<std::vector<FaceIndex>>> bins(sliceCount,
+                                                          std::vector<std::vector<FaceIndex>>(tileCount));
+    parallelFor(0, sliceCount, [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int slice = begin; slice < end; slice++) {
+            const auto firstFace = static_cast<FaceIndex>(static_cast<uint64_t>(faceCount) * slice / sliceCount);
+            const auto lastFace = static_cast<FaceIndex>(static_cast<uint64_t>(faceCount) * (slice + 1) / sliceCount);
+
+            for (FaceIndex face = firstFace; face < lastFace; face++) {
+                std::array<Cartesian3, 3> corners;
+                std::array<float, 3> intensities{};
+                for (int corner = 0; corner < 3; corner++) {
+                    const VertexId vertexId = mesh.faceVertices[3 * face + corner];
+                    corners[corner] = windowPositions[vertexId];
+                    // hard assumption: faceNormals are up to date
+                    intensities[corner] = useFlatNormals ? 0.0f : vertexIntensities[vertexId];
+                }
+                if (useFlatNormals) {
+                    intensities.fill(intensityOf(mesh.faceNormals[face]));
+                }
+
+                const TriangleSetup& setup = setups[face] = setUpTriangle(corners, intensities, width, height);
+                if (setup.minX > setup.maxX || setup.minY > setup.maxY) {
+                    continue;
+                }
+
+                for (int tileY = setup.minY / TILE_SIZE; tileY <= setup.maxY / TILE_SIZE; tileY++) {
+                    for (int tileX = setup.minX / TILE_SIZE; tileX <= setup.maxX / TILE_SIZE; tileX++) {
+                        bins[slice][tileY * tilesAcross + tileX].push_back(face);
+                    }
+                }
+            }
+        }
+    }, 1);
+
+    // tiles are handed out one at a time, as those covering the mesh take far longer than the others
+    std::atomic<unsigned int> nextTile(0);
+    parallelFor(0, sliceCount, [&](const unsigned int, const unsigned int) {
+        Tile tile;
+
+        for (unsigned int tileIndex = nextTile++; tileIndex < tileCount; tileIndex = nextTile++) {
+            const int tileX = static_cast<int>(tileIndex % tilesAcross) * TILE_SIZE;
+            const int tileY = static_cast<int>(tileIndex / tilesAcross) * TILE_SIZE;
+
+            tile.depth.fill(1.0f);
+            tile.intensity.fill(0.0f);
+            for (const auto& sliceBins : bins) {
+                for (const FaceIndex face : sliceBins[tileIndex]) {
+                    rasterizeTriangle(setups[face], tileX, tileY, tile);
+                }
+            }
+
+            // only pixels that passed the depth test were written closer than the far plane
+            for (int y = tileY; y < std::min<int>(tileY + TILE_SIZE, height); y++) {
+                uint8_t* row = pixels.data() + 4 * static_cast<size_t>(height - 1 - y) * width;
+                for (int x = tileX; x < std::min<int>(tileX + TILE_SIZE, width); x++) {
+                    const unsigned int index = (y - tileY) * TILE_SIZE + (x - tileX);
+                    uint8_t* pixel = row + 4 * x;
+                    if (tile.depth[index] >= 1.0f) {
+                        std::copy(BACKGROUND.begin(), BACKGROUND.end(), pixel);
+                        continue;
+                    }
+
+                    const auto grey = static_cast<uint8_t>(std::lround(std::clamp(tile.intensity[index], 0.0f, 1.0f) * 255.0f));
+                    pixel[0] = pixel[1] = pixel[2] = grey;
+                    pixel[3] = 255;
+                }
+            }
+        }
+    }, 1);
+}
+
+const std::vector<uint8_t>& SoftwareRasterizer::rgba() const {
+    return pixels;
+}
+
+bool SoftwareRasterizer::writeImage(const std::string& imagePath) const {
+    const QImage image(pixels.data(), static_cast<int>(width), static_cast<int>(height),
+                       static_cast<int>(4 * width), QImage::Format_RGBA8888);
+    return image.save(QString::fromStdString(imagePath));
+}
@@ -0,0 +1,37 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "RenderParameters.h"
+#include "TriangleMesh.h"
+
+/**
+ * Renders a TriangleMesh on the CPU into an RGBA image, the way SceneRenderer draws it without
+ * vertex markers or wireframe: same orthographic projection, fixed-function lighting of light 0
+ * with the default material, flat or smooth normals, and depth test.
+ *
+ * Triangles are set up in parallel and binned into square tiles, then every tile is rasterized
+ * by a single thread, evaluating edge functions 4 pixels at a time (with SSE2 where available).
+ */
+class SoftwareRasterizer {
+    unsigned int width;
+    unsigned int height;
+
+    // rows from the top, 4 bytes per pixel
+    std::vector<uint8_t> pixels;
+
+public:
+    SoftwareRasterizer(unsigned int width, unsigned int height);
+
+    void render(const TriangleMesh& mesh, const RenderParameters& renderParameters);
+
+    const std::vector<uint8_t>& rgba() const;
+
+    // .png or .ppm, chosen by extension
+    bool writeImage(const std::string& imagePath) const;
+};
+
+#endif
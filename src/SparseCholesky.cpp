@@ -0,0 +1,221 @@
+#include "SparseCholesky.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+// parts this small are ordered as they are, splitting them further saves less fill than it costs
+constexpr unsigned int DISSECTION_LEAF_SIZE = 64;
+
+constexpr unsigned int NO_PARENT = std::numeric_limits<unsigned int>::max();
+
+// which half of the part being split a point lies in, outside of it being neither
+enum DissectionSide : unsigned char {
+    OUTSIDE,
+    LOWER,
+    UPPER
+};
+
+/**
+ * @brief Appends ids to order so that the rows separating the 2 halves of ids come after both halves,
+ *        which are ordered the same way first. Eliminating a half then fills in nothing in the other
+ */
+static void dissect(const SparseMatrix& matrix, const std::vector<std::array<float, 3>>& points,
+                    unsigned int* ids, const unsigned int count,
+                    std::vector<DissectionSide>& sides, std::vector<unsigned int>& order) {
+    if (count <= DISSECTION_LEAF_SIZE) {
+        order.insert(order.end(), ids, ids + count);
+        return;
+    }
+
+    std::array<float, 3> lower = points[ids[0]];
+    std::array<float, 3> upper = points[ids[0]];
+    for (unsigned int i = 1; i < count; i++) {
+        for (unsigned int axis = 0; axis < 3; axis++) {
+            lower[axis] = std::min(lower[axis], points[ids[i]][axis]);
+            upper[axis] = std::max(upper[axis], points[ids[i]][axis]);
+        }
+    }
+    unsigned int axis = 0;
+    for (unsigned int other = 1; other < 3; other++) {
+        if (upper[other] - lower[other] > upper[axis] - lower[axis]) {
+            axis = other;
+        }
+    }
+
+    const unsigned int lowerCount = count / 2;
+    std::nth_element(ids, ids + lowerCount, ids + count, [&](const unsigned int a, const unsigned int b) {
+        return points[a][axis] < points[b][axis];
+    });
+
+    for (unsigned int i = 0; i < count; i++) {
+        sides[ids[i]] = i < lowerCount ? LOWER : UPPER;
+    }
+
+    // the separator is the lower rows coupled to an upper one
+    const auto isSeparator = [&](const unsigned int row) {
+        for (unsigned int entry = matrix.rowStarts[row]; entry < matrix.rowStarts[row + 1]; entry++) {
+            if (sides[matrix.columns[entry]] == UPPER) {
+                return true;
+            }
+        }
+        return false;
+    };
+    const unsigned int* separator = std::stable_partition(ids, ids + lowerCount, [&](const unsigned int row) {
+        return !isSeparator(row);
+    });
+    const unsigned int separatorBegin = separator - ids;
+
+    for (unsigned int i = 0; i < count; i++) {
+        sides[ids[i]] = OUTSIDE;
+    }
+
+    dissect(matrix, points, ids, separatorBegin, sides, order);
+    dissect(matrix, points, ids + lowerCount, count - lowerCount, sides, order);
+    order.insert(order.end(), ids + separatorBegin, ids + lowerCount);
+}
+
+std::vector<unsigned int> nestedDissectionOrdering(const SparseMatrix& matrix, const std::vector<Cartesian3>& points) {
+    std::vector<std::array<float, 3>> coordinates(points.size());
+    for (unsigned int point = 0; point < points.size(); point++) {
+        coordinates[point] = {points[point].x, points[point].y, points[point].z};
+    }
+
+    std::vector<unsigned int> ids(matrix.size);
+    for (unsigned int row = 0; row < matrix.size; row++) {
+        ids[row] = row;
+    }
+
+    std::vector<DissectionSide> sides(matrix.size, OUTSIDE);
+    std::vector<unsigned int> order;
+    order.reserve(matrix.size);
+    dissect(matrix, coordinates, ids.data(), matrix.size, sides, order);
+    return order;
+}
+
+/**
+ * @brief Up-looking factorisation, after LDL by T. Davis: row k of L is found by a sparse triangular solve
+ *        with the rows above it, whose pattern is the path from the entries of row k up the elimination tree
+ */
+SparseCholesky::SparseCholesky(const SparseMatrix& matrix, const std::vector<unsigned int>& ordering)
+    : ordering(ordering),
+      inverseOrdering(matrix.size),
+      columnStarts(matrix.size + 1, 0),
+      diagonal(matrix.size, 0.0),
+      isFactorised(true) {
+    const unsigned int size = matrix.size;
+    for (unsigned int newIndex = 0; newIndex < size; newIndex++) {
+        inverseOrdering[ordering[newIndex]] = newIndex;
+    }
+
+    std::vector<unsigned int> parents(size);
+    std::vector<unsigned int> flags(size);
+    std::vector<unsigned int> columnCounts(size, 0);
+
+    // symbolic: the elimination tree, & how many entries every column of L gets
+    for (unsigned int k = 0; k < size; k++) {
+        parents[k] = NO_PARENT;
+        flags[k] = k;
+        const unsigned int row = ordering[k];
+        for (unsigned int entry = matrix.rowStarts[row]; entry < matrix.rowStarts[row + 1]; entry++) {
+            for (unsigned int i = inverseOrdering[matrix.columns[entry]]; i < k && flags[i] != k; i = parents[i]) {
+                if (parents[i] == NO_PARENT) {
+                    parents[i] = k;
+                }
+                columnCounts[i]++;
+                flags[i] = k;
+            }
+        }
+    }
+    for (unsigned int k = 0; k < size; k++) {
+        columnStarts[k + 1] = columnStarts[k] + columnCounts[k];
+    }
+    rows.resize(columnStarts[size]);
+    values.resize(columnStarts[size]);
+
+    // numeric: row by row, columns of L filling up as rows below reach them
+    std::vector<double> scattered(size, 0.0);
+    std::vector<unsigned int> pattern(size);
+    std::fill(columnCounts.begin(), columnCounts.end(), 0);
+    for (unsigned int k = 0; k < size; k++) {
+        unsigned int top = size;
+        flags[k] = k;
+
+        const unsigned int row = ordering[k];
+        for (unsigned int entry = matrix.rowStarts[row]; entry < matrix.rowStarts[row + 1]; entry++) {
+            unsigned int i = inverseOrdering[matrix.columns[entry]];
+            if (i > k) {
+                continue;
+            }
+            scattered[i] += matrix.values[entry];
+
+            // the path up the tree, reversed onto the top of pattern so that it is visited top-down
+            unsigned int length = 0;
+            for (; flags[i] != k; i = parents[i]) {
+                pattern[length++] = i;
+                flags[i] = k;
+            }
+            while (length > 0) {
+                pattern[--top] = pattern[--length];
+            }
+        }
+
+        diagonal[k] = scattered[k];
+        scattered[k] = 0.0;
+        for (; top < size; top++) {
+            const unsigned int i = pattern[top];
+            const double value = scattered[i];
+            scattered[i] = 0.0;
+
+            const unsigned int end = columnStarts[i] + columnCounts[i];
+            for (unsigned int entry = columnStarts[i]; entry < end; entry++) {
+                scattered[rows[entry]] -= values[entry] * value;
+            }
+
+            const double factor = value / diagonal[i];
+            diagonal[k] -= factor * value;
+            rows[end] = k;
+            values[end] = factor;
+            columnCounts[i]++;
+        }
+
+        if (!(diagonal[k] > 0.0)) {
+            isFactorised = false;
+            return;
+        }
+    }
+}
+
+bool SparseCholesky::succeeded() const {
+    return isFactorised;
+}
+
+void SparseCholesky::solve(std::vector<double>& rightHandSide) const {
+    const unsigned int size = diagonal.size();
+    std::vector<double> x(size);
+    for (unsigned int k = 0; k < size; k++) {
+        x[k] = rightHandSide[ordering[k]];
+    }
+
+    for (unsigned int column = 0; column < size; column++) {
+        for (unsigned int entry = columnStarts[column]; entry < columnStarts[column + 1]; entry++) {
+            x[rows[entry]] -= values[entry] * x[column];
+        }
+    }
+    for (unsigned int k = 0; k < size; k++) {
+        x[k] /= diagonal[k];
+    }
+    for (unsigned int column = size; column-- > 0;) {
+        for (unsigned int entry = columnStarts[column]; entry < columnStarts[column + 1]; entry++) {
+            x[column] -= values[entry] * x[rows[entry]];
+        }
+    }
+
+    for (unsigned int k = 0; k < size; k++) {
+        rightHandSide[ordering[k]] = x[k];
+    }
+}
+
+size_t SparseCholesky::factorNonzeros() const {
+    return rows.size();
+}
@@ -0,0 +1,54 @@
+#ifndef SPARSE_CHOLESKY_H
+#define SPARSE_CHOLESKY_H
+
+#include <vector>
+
+#include "Cartesian3.h"
+
+// Symmetric matrix in compressed rows, both triangles stored, columns sorted within each row
+struct SparseMatrix {
+    unsigned int size = 0;
+    // row r holds the entries [rowStarts[r], rowStarts[r + 1]) of columns & values
+    std::vector<unsigned int> rowStarts;
+    std::vector<unsigned int> columns;
+    std::vector<double> values;
+};
+
+/**
+ * LDL^T factorisation of a sparse symmetric positive definite matrix, for solving many right-hand sides.
+ *
+ * Rows are eliminated in a fill-reducing order, the nonzeros of every column of L being counted
+ * from the elimination tree before any arithmetic, so that L is allocated once. Each solve is then
+ * a forward & a backward substitution, in time proportional to the nonzeros of L.
+ */
+class SparseCholesky {
+    // ordering[newIndex] = oldIndex, & its inverse
+    std::vector<unsigned int> ordering;
+    std::vector<unsigned int> inverseOrdering;
+    // strictly lower triangle of L by column, column k holding [columnStarts[k], columnStarts[k + 1])
+    std::vector<unsigned int> columnStarts;
+    std::vector<unsigned int> rows;
+    std::vector<double> values;
+    std::vector<double> diagonal;
+    bool isFactorised;
+
+public:
+    // factorises matrix with its rows & columns permuted by ordering, as ordering[newIndex] = oldIndex
+    SparseCholesky(const SparseMatrix& matrix, const std::vector<unsigned int>& ordering);
+
+    // false if a pivot was not positive, i.e. the matrix was not positive definite
+    bool succeeded() const;
+
+    // overwrites rightHandSide with the solution x of matrix x = rightHandSide
+    void solve(std::vector<double>& rightHandSide) const;
+
+    // nonzeros of L, off the diagonal
+    size_t factorNonzeros() const;
+};
+
+// Fill-reducing ordering of a matrix whose rows are points in space, e.g. a mesh Laplacian over its vertices:
+// the points are split at the median along their longest axis, the rows coupling both halves are ordered last,
+// & each half recursively so
+std::vector<unsigned int> nestedDissectionOrdering(const SparseMatrix& matrix, const std::vector<Cartesian3>& points);
+
+#endif
@@ -1,6 +1,7 @@
 #include "SphereVertices.h"
 
 #include <array>
+#include <cmath>
 
 #ifdef __APPLE__
 #include <OpenGL/gl.h>
@@ -156,3 +157,49 @@ void renderTriangulatedSphere() {
 
     glEnd();
 }
+
+void triangulateSphere(const unsigned int segments, const unsigned int layers,
+                       std::vector<Cartesian3>& vertices, std::vector<unsigned short>& indices) {
+    vertices.clear();
+    indices.clear();
+
+    // meridians are closed by repeating their first vertex, like sphereVert
+    for (unsigned int segment = 0; segment < segments; segment++) {
+        const float longitude = 2.0f * M_PI * segment / segments;
+
+        for (unsigned int layer = 0; layer <= layers; layer++) {
+            const float latitude = M_PI * layer / layers;
+            vertices.emplace_back(
+                std::sin(latitude) * std::cos(longitude),
+                std::sin(latitude) * std::sin(longitude),
+                -std::cos(latitude)
+            );
+        }
+    }
+
+    const auto vertexAt = [layers](const unsigned int segment, const unsigned int layer) {
+        return static_cast<unsigned short>(segment * (layers + 1) + layer);
+    };
+
+    for (unsigned int segment = 0; segment < segments; segment++) {
+        const unsigned int nextSegment = (segment + 1) % segments;
+
+        for (unsigned int layer = 0; layer < layers; layer++) {
+            // the quads touching the poles are single triangles
+            if (layer > 0) {
+                indices.insert(indices.end(), {
+                                   vertexAt(segment, layer),
+                                   vertexAt(segment, layer + 1),
+                                   vertexAt(nextSegment, layer)
+                               });
+            }
+            if (layer + 1 < layers) {
+                indices.insert(indices.end(), {
+                                   vertexAt(segment, layer + 1),
+                                   vertexAt(nextSegment, layer + 1),
+                                   vertexAt(nextSegment, layer)
+                               });
+            }
+        }
+    }
+}
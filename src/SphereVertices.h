@@ -1,6 +1,10 @@
 #ifndef SPHERE_VERTICES
 #define SPHERE_VERTICES
 
+#include <vector>
+
+#include "Cartesian3.h"
+
 /* Routines to draw triangle-based spheres */
 
 void renderWireframeSphereOutline();
@@ -9,4 +13,8 @@ void renderWireframeSphere();
 
 void renderTriangulatedSphere();
 
+// unit sphere with segments meridians & layers bands from pole to pole, as indexed triangles
+void triangulateSphere(unsigned int segments, unsigned int layers,
+                       std::vector<Cartesian3>& vertices, std::vector<unsigned short>& indices);
+
 #endif
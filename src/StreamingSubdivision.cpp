@@ -0,0 +1,196 @@
+#include "StreamingSubdivision.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include "BinaryMeshFormat.h"
+#include "LoopSubdivision.h"
+#include "MappedFile.h"
+
+StreamingSubdivision::StreamingSubdivision(const unsigned int blockSize)
+    : blockSize(std::max(blockSize, 1u)) {
+}
+
+/**
+ * @brief Subdivides level by level, each intermediate level living in a temporary .hebin
+ *        next to outputPath until the following level has consumed it
+ *
+ * @return whether every level was written successfully
+ */
+bool StreamingSubdivision::subdivide(const std::string& inputPath,
+                                     const unsigned int levels,
+                                     const std::string& outputPath) const {
+    std::string levelInput = inputPath;
+
+    for (unsigned int level = 1; level <= levels; level++) {
+        const std::string levelOutput = level == levels
+                                            ? outputPath
+                                            : outputPath + ".level" + std::to_string(level);
+
+        std::cout << "Streaming Subdivision " << level << "..." << std::endl;
+        const bool success = subdivideLevel(levelInput, levelOutput);
+
+        if (levelInput != inputPath) {
+            std::remove(levelInput.c_str());
+        }
+
+        if (!success) {
+            std::remove(levelOutput.c_str());
+            return false;
+        }
+
+        std::cout << "Finished streaming Subdivision " << level << std::endl;
+        levelInput = levelOutput;
+    }
+
+    return true;
+}
+
+bool StreamingSubdivision::subdivideLevel(const std::string& inputPath, const std::string& outputPath) const {
+    const MappedFile input(inputPath);
+    if (!input.isOpen() || input.size() < sizeof(BinaryMeshHeader)) {
+        std::cerr << "Failed to map: " << inputPath << std::endl;
+        return false;
+    }
+
+    const BinaryMeshHeader header = *input.at<BinaryMeshHeader>(0);
+    const BinaryMeshLayout layout(header);
+    if (!header.isValid() || layout.fileSize != input.size()) {
+        std::cerr << "Not a valid .hebin file: " << inputPath << std::endl;
+        return false;
+    }
+
+    const uint64_t vertexCount = header.vertexCount;
+    const uint64_t halfEdgeCount = header.halfEdgeCount;
+    const uint64_t faceCount = halfEdgeCount / 3;
+
+    // Ids are 32 bits wide, like in TriangleMesh
+    if (4 * halfEdgeCount >= NO_VALUE || vertexCount + halfEdgeCount / 2 >= NO_VALUE) {
+        std::cerr << "Subdivision of " << inputPath << " exceeds 32-bit ids" << std::endl;
+        return false;
+    }
+
+    const HalfedgeView parent{
+        input.at<Cartesian3>(layout.vertices),
+        input.at<VertexId>(layout.faceVertices),
+        input.at<EdgeId>(layout.otherHalf),
+        input.at<EdgeId>(layout.firstDirectedEdge),
+        header.vertexCount,
+        header.halfEdgeCount
+    };
+
+    // every kernel indexes the parent through its arrays, so they are checked first, block by block
+    for (uint64_t begin = 0; begin < halfEdgeCount; begin += blockSize) {
+        if (!halfEdgesInRange(parent, begin, std::min(begin + blockSize, halfEdgeCount))) {
+            std::cerr << "Out of range or missing indices in: " << inputPath << std::endl;
+            return false;
+        }
+        input.release();
+    }
+    for (uint64_t begin = 0; begin < vertexCount; begin += blockSize) {
+        if (!verticesInRange(parent, begin, std::min(begin + blockSize, vertexCount))) {
+            std::cerr << "Out of range or missing indices in: " << inputPath << std::endl;
+            return false;
+        }
+        input.release();
+    }
+
+    // edgeId -> fulledgeId, kept out-of-core as well
+    const std::string fulledgesPath = outputPath + ".fulledges";
+    const MappedFile fulledgeFile(fulledgesPath, halfEdgeCount * sizeof(unsigned int));
+    std::remove(fulledgesPath.c_str());
+    if (!fulledgeFile.isOpen() && halfEdgeCount > 0) {
+        std::cerr << "Failed to map: " << fulledgesPath << std::endl;
+        return false;
+    }
+    unsigned int* fulledges = fulledgeFile.at<unsigned int>(0);
+
+    unsigned int fulledgeCount = 0;
+    for (uint64_t begin = 0; begin < halfEdgeCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, halfEdgeCount);
+        fulledgeCount = numberFulledges(parent, begin, end, fulledgeCount, fulledges);
+        input.release();
+        fulledgeFile.release();
+    }
+
+    // A closed 2-manifold has exactly two half-edges per fulledge
+    if (2 * uint64_t{fulledgeCount} != halfEdgeCount) {
+        std::cerr << "Streaming subdivision requires a closed 2-manifold: " << inputPath << std::endl;
+        return false;
+    }
+
+    const BinaryMeshHeader childHeader(vertexCount + fulledgeCount, 4 * halfEdgeCount);
+    const BinaryMeshLayout childLayout(childHeader);
+    const MappedFile output(outputPath, childLayout.fileSize);
+    if (!output.isOpen()) {
+        std::cerr << "Failed to map: " << outputPath << std::endl;
+        return false;
+    }
+
+    *output.at<BinaryMeshHeader>(0) = childHeader;
+    auto* childVertices = output.at<Cartesian3>(childLayout.vertices);
+    auto* childNormals = output.at<Cartesian3>(childLayout.normals);
+    auto* childFaceVertices = output.at<VertexId>(childLayout.faceVertices);
+    auto* childOtherHalf = output.at<EdgeId>(childLayout.otherHalf);
+    auto* childFirstDirectedEdge = output.at<EdgeId>(childLayout.firstDirectedEdge);
+
+    // Blocks read the parent at random (1-rings, other halves), so drop everything once done
+    const auto releaseBlock = [&]() {
+        input.release();
+        fulledgeFile.release();
+        output.release();
+    };
+
+    for (uint64_t begin = 0; begin < faceCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, faceCount);
+        subdivideFaces(parent, fulledges, begin, end, childFaceVertices, childOtherHalf);
+        releaseBlock();
+    }
+
+    for (uint64_t begin = 0; begin < halfEdgeCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, halfEdgeCount);
+        subdivideEdges(parent, fulledges, begin, end, childFirstDirectedEdge, childVertices);
+        releaseBlock();
+    }
+
+    for (uint64_t begin = 0; begin < vertexCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, vertexCount);
+        subdivideVertices(parent, begin, end, childFirstDirectedEdge, childVertices);
+        releaseBlock();
+    }
+
+    // Normals, area weighted like TriangleMesh::computeNormals, scattered block by block into the zero-filled output
+    const uint64_t childFaceCount = childHeader.halfEdgeCount / 3;
+    for (uint64_t begin = 0; begin < childFaceCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, childFaceCount);
+
+        for (uint64_t face = 3 * begin; face < 3 * end; face += 3) {
+            const VertexId pId = childFaceVertices[face];
+            const VertexId qId = childFaceVertices[face + 1];
+            const VertexId rId = childFaceVertices[face + 2];
+
+            const Cartesian3 cross = (childVertices[qId] - childVertices[pId])
+                    .cross(childVertices[rId] - childVertices[pId]);
+
+            childNormals[pId] += cross;
+            childNormals[qId] += cross;
+            childNormals[rId] += cross;
+        }
+
+        output.release();
+    }
+
+    const uint64_t childVertexCount = childHeader.vertexCount;
+    for (uint64_t begin = 0; begin < childVertexCount; begin += blockSize) {
+        const uint64_t end = std::min(begin + blockSize, childVertexCount);
+
+        for (uint64_t vertex = begin; vertex < end; vertex++) {
+            childNormals[vertex] = childNormals[vertex].unit();
+        }
+
+        output.release();
+    }
+
+    return true;
+}
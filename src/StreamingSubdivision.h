@@ -0,0 +1,27 @@
+#ifndef STREAMING_SUBDIVISION_H
+#define STREAMING_SUBDIVISION_H
+
+#include <string>
+
+/**
+ * Out-of-core Loop subdivision between .hebin files.
+ *
+ * The parent mesh is memory-mapped and processed in blocks of blockSize faces, half-edges
+ * or vertices, with the child arrays written block by block into a memory-mapped output.
+ * Each block is released once written, so resident memory stays bounded by a few blocks
+ * regardless of the subdivision level. Produces the same mesh as TriangleMesh::subdivide.
+ */
+class StreamingSubdivision {
+    unsigned int blockSize;
+
+public:
+    explicit StreamingSubdivision(unsigned int blockSize = 1u << 16);
+
+    // subdivides the .hebin at inputPath levels times into the .hebin at outputPath
+    bool subdivide(const std::string& inputPath, unsigned int levels, const std::string& outputPath) const;
+
+private:
+    bool subdivideLevel(const std::string& inputPath, const std::string& outputPath) const;
+};
+
+#endif
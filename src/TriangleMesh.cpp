@@ -1,27 +1,103 @@
 #include "TriangleMesh.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <future>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <string>
-#include <limits>
 #include <unordered_map>
 
+#include "BinaryMeshFormat.h"
+#include "LoopSubdivision.h"
+#include "Parallel.h"
+
 #define MAXIMUM_LINE_LENGTH 1024
 
-constexpr unsigned int NO_VALUE = std::numeric_limits<unsigned int>::max();
+// defects of each kind printed by TriangleMesh::printDefects, the rest are only counted
+constexpr unsigned int PRINTED_DEFECTS_PER_KIND = 5;
+
+// times a lower bound on the object size that updateMovedVertices lets objectSize reach before a full pass
+constexpr float OBJECT_SIZE_SLACK = 2.0f;
+
+// hashes positions bit for bit, so that .tri corners at the same position are welded into one vertex
+struct PositionHash {
+    size_t operator()(const Cartesian3& position) const {
+        // -0 & 0 compare equal, so they must hash alike
+        const std::array<float, 3> coordinates = {position.x + 0.0f, position.y + 0.0f, position.z + 0.0f};
+        std::array<uint32_t, 3> bits;
+        std::memcpy(bits.data(), coordinates.data(), sizeof(bits));
+        return (static_cast<size_t>(bits[0]) * 73856093u) ^ (static_cast<size_t>(bits[1]) * 19349663u) ^
+               (static_cast<size_t>(bits[2]) * 83492791u);
+    }
+};
+
+/**
+ * Half-edges grouped by the vertex they leave, by a counting sort over faceVertices.
+ * Finding the half-edges between two vertices then takes time proportional to the valence of one of them
+ */
+struct OutgoingEdges {
+    const std::vector<VertexId>& faceVertices;
+    // the half-edges leaving vertex v are edges[offsets[v], offsets[v + 1]), arriving at heads[...] alike
+    std::vector<unsigned int> offsets;
+    std::vector<EdgeId> edges;
+    std::vector<VertexId> heads;
+
+    // every entry of faceVertices must be below vertexCount
+    OutgoingEdges(const std::vector<VertexId>& faceVertices, const unsigned int vertexCount)
+        : faceVertices(faceVertices),
+          offsets(vertexCount + 1, 0),
+          edges(faceVertices.size()),
+          heads(faceVertices.size()) {
+        for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+            offsets[tail(edgeId) + 1]++;
+        }
+        for (VertexId vertexId = 0; vertexId < vertexCount; vertexId++) {
+            offsets[vertexId + 1] += offsets[vertexId];
+        }
+
+        std::vector<unsigned int> next(offsets.begin(), offsets.end() - 1);
+        for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
+            const unsigned int slot = next[tail(edgeId)]++;
+            edges[slot] = edgeId;
+            heads[slot] = faceVertices[edgeId];
+        }
+    }
+
+    VertexId tail(const EdgeId edgeId) const {
+        return faceVertices[TriangleMesh::idToIndex(edgeId)];
+    }
 
-constexpr float NEAR_NEIGHBOUR_WEIGHT = 0.375f; // 3 / 8
-constexpr float FAR_NEIGHBOUR_WEIGHT = 0.125f; // 1 / 8
+    unsigned int valence(const VertexId vertexId) const {
+        return offsets[vertexId + 1] - offsets[vertexId];
+    }
 
-constexpr float N_3_ALPHA = 0.1875f; // 3 / 16
+    // how many half-edges run from -> to, & the lowest of them, NO_VALUE if there is none
+    std::pair<unsigned int, EdgeId> between(const VertexId from, const VertexId to) const {
+        unsigned int count = 0;
+        EdgeId lowest = NO_VALUE;
+        for (unsigned int i = offsets[from]; i < offsets[from + 1]; i++) {
+            if (heads[i] == to) {
+                lowest = count == 0 ? edges[i] : lowest;
+                count++;
+            }
+        }
+        return {count, lowest};
+    }
+};
 
 TriangleMesh::TriangleMesh()
     : centreOfGravity(0.0f, 0.0f, 0.0f),
-      objectSize(0.0f) {
+      objectSize(0.0f),
+      normalWeighting(NormalWeighting::AREA),
+      vertexSum({0.0, 0.0, 0.0}),
+      farthestVertex(NO_VALUE) {
     vertices.clear();
     normals.clear();
+    faceNormals.clear();
     firstDirectedEdge.clear();
     faceVertices.clear();
     otherHalf.clear();
@@ -110,26 +186,23 @@ bool TriangleMesh::readHalfedgeFile(std::istream& halfedgeFile) {
         }
     }
 
+    if (const auto defects = validate(); !onlyPinchedVertices(defects)) {
+        std::cerr << "Malformed half-edge file:" << std::endl;
+        printDefects(defects, std::cerr);
+        return false;
+    } else if (!defects.empty()) {
+        std::cerr << "Read with pinched vertices:" << std::endl;
+        printDefects(defects, std::cerr);
+    }
+
+    // vertex normals come with the file
+    computeFaceNormals();
     computeCentreOfGravity();
+    computeFulledges();
 
     return true;
 }
 
-/**
- * @return std::optional with the value EdgeId of the edge [to -> from] if it exists,
- *         otherwise std::nullopt (i.e. half-edge [to -> from] was not found)
- */
-std::optional<EdgeId> TriangleMesh::findHalfEdgeFor(const VertexId from, const VertexId to) const {
-    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
-        auto [otherFrom, otherTo] = vertexIndicesOf(edgeId);
-        if (otherFrom == to && otherTo == from) {
-            return {edgeId};
-        }
-    }
-
-    return std::nullopt;
-}
-
 /**
  * @brief Computes the half-edge structure from a .tri file
  *
@@ -147,32 +220,35 @@ bool TriangleMesh::readTriFile(std::istream& triFile) {
     /*
      * For each vertex:
      *      - Process vertex value
-     *      - Linear lookup to find vertexId in indexedVertices:
-     *          -- If vertex is new (not found), vertexId = #vertices and store indexedVertices.push_back(vertex)
-     *          -- Otherwise, vertexId = #index of vertex in indexedVertices
+     *      - Hashed lookup to find vertexId among the positions seen so far:
+     *          -- If vertex is new (not found), vertexId = #vertices and store vertices.push_back(vertex)
+     *          -- Otherwise, vertexId = the id stored when it was first seen
      *      - Current vertex is assumed to be the tail of an edge within a face, therefore:
      *          -- Store faceVertices[edgeId] = vertexId, where edgeId = #edges
      *             See TriangleMesh.faceVertices for a more detailed explanation
      */
+    std::unordered_map<Cartesian3, VertexId, PositionHash> vertexIds;
+    vertexIds.reserve(totalVerticesAmount);
     for (unsigned int v = 0; v < totalVerticesAmount; v++) {
         Cartesian3 vertex;
         triFile >> vertex;
 
-        const auto vertexIdLookup = std::find(vertices.begin(), vertices.end(), vertex);
-        const bool isVertexNew = vertexIdLookup == vertices.end();
-
-        VertexId vertexId = isVertexNew ? vertices.size() : vertexIdLookup - vertices.begin();
-
+        const auto [vertexIdLookup, isVertexNew] = vertexIds.try_emplace(vertex, vertices.size());
         if (isVertexNew) {
             vertices.push_back(vertex);
         }
 
-        faceVertices.push_back(vertexId);
+        faceVertices.push_back(vertexIdLookup->second);
+    }
+
+    if (!triFile) {
+        std::cerr << "Expected " << trianglesAmount << " triangles" << std::endl;
+        return false;
     }
 
     /*
      * For each edge:
-     *      - Set from = faceVertices[edge]
+     *      - Set from = faceVertices[idToIndex(edge)], the tail of edge
      *      - If FDE[from] already has a value, skip it
      *      - Otherwise, set FDE[from] = edge
      */
@@ -185,69 +261,435 @@ bool TriangleMesh::readTriFile(std::istream& triFile) {
             continue;
         }
 
-        firstDirectedEdge[vertexIdFrom] = idToIndex(edgeId);
+        firstDirectedEdge[vertexIdFrom] = edgeId;
     }
 
     /*
-     * For each edge, find and map its other half
+     * For each edge [from -> to], map its other half to the only edge [to -> from], if there is exactly one.
+     * Edges left unpaired are reported by validate
      */
+    const OutgoingEdges outgoingEdges(faceVertices, vertices.size());
     otherHalf.assign(faceVertices.size(), NO_VALUE);
     for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
         auto [from, to] = vertexIndicesOf(edgeId);
-        auto halfEdgeLookup = findHalfEdgeFor(from, to);
-
-        if (!halfEdgeLookup.has_value()) {
-            const auto& fromVertex = vertices[from];
-            const auto& toVertex = vertices[to];
-            throw OtherHalfNotFound(edgeId, fromVertex, toVertex);
+        if (const auto [count, halfEdge] = outgoingEdges.between(to, from); count == 1) {
+            otherHalf[edgeId] = halfEdge;
         }
+    }
 
-        const EdgeId halfEdge = halfEdgeLookup.value();
-
-        otherHalf[edgeId] = halfEdge;
-        otherHalf[halfEdge] = edgeId;
+    if (const auto defects = validate(); !onlyPinchedVertices(defects)) {
+        std::cerr << "Malformed mesh, check that every edge is shared by exactly 2 faces of consistent winding, "
+                  << "& that the positions of shared corners match exactly:" << std::endl;
+        printDefects(defects, std::cerr);
+        return false;
+    } else if (!defects.empty()) {
+        std::cerr << "Read with pinched vertices:" << std::endl;
+        printDefects(defects, std::cerr);
     }
 
     computeNormals();
     computeCentreOfGravity();
+    computeFulledges();
+
+    return true;
+}
+
+/**
+ * @brief Reads the half-edge structure as-is from a .hebin file, once its size matches the header
+ *        & every index is checked to be in range, in parallel, then validates it like the other formats
+ *
+ * @param binaryFile .hebin binary half-edge file, see BinaryMeshFormat.h
+ *
+ * @return whether the read was successful
+ */
+bool TriangleMesh::readBinaryFile(std::istream& binaryFile) {
+    BinaryMeshHeader header;
+    if (!binaryFile.read(reinterpret_cast<char*>(&header), sizeof(header)) || !header.isValid()) {
+        return false;
+    }
+
+    // before allocating anything, as the counts could be anything
+    binaryFile.seekg(0, std::ios::end);
+    const std::streamoff fileSize = binaryFile.tellg();
+    binaryFile.seekg(sizeof(header), std::ios::beg);
+    if (fileSize < 0 || static_cast<uint64_t>(fileSize) != BinaryMeshLayout(header).fileSize) {
+        std::cerr << "The size of the .hebin file does not match its header" << std::endl;
+        return false;
+    }
+
+    vertices.resize(header.vertexCount);
+    normals.resize(header.vertexCount);
+    faceVertices.resize(header.halfEdgeCount);
+    otherHalf.resize(header.halfEdgeCount);
+    firstDirectedEdge.resize(header.vertexCount);
+
+    binaryFile.read(reinterpret_cast<char*>(vertices.data()), vertices.size() * sizeof(Cartesian3));
+    binaryFile.read(reinterpret_cast<char*>(normals.data()), normals.size() * sizeof(Cartesian3));
+    binaryFile.read(reinterpret_cast<char*>(faceVertices.data()), faceVertices.size() * sizeof(VertexId));
+    binaryFile.read(reinterpret_cast<char*>(otherHalf.data()), otherHalf.size() * sizeof(EdgeId));
+    binaryFile.read(reinterpret_cast<char*>(firstDirectedEdge.data()), firstDirectedEdge.size() * sizeof(EdgeId));
+
+    if (!binaryFile) {
+        return false;
+    }
+
+    const HalfedgeView arrays = view();
+    std::atomic<bool> isInRange(true);
+    parallelFor(0, faceVertices.size(), [&](const EdgeId begin, const EdgeId end) {
+        if (!halfEdgesInRange(arrays, begin, end)) {
+            isInRange = false;
+        }
+    });
+    parallelFor(0, vertices.size(), [&](const VertexId begin, const VertexId end) {
+        if (!verticesInRange(arrays, begin, end)) {
+            isInRange = false;
+        }
+    });
+    if (!isInRange) {
+        std::cerr << "Malformed .hebin file, an index is out of range or missing, or other halves do not pair up"
+                  << std::endl;
+        return false;
+    }
+
+    if (const auto defects = validate(); !onlyPinchedVertices(defects)) {
+        std::cerr << "Malformed .hebin file:" << std::endl;
+        printDefects(defects, std::cerr);
+        return false;
+    } else if (!defects.empty()) {
+        std::cerr << "Read with pinched vertices:" << std::endl;
+        printDefects(defects, std::cerr);
+    }
+
+    computeFaceNormals();
+    computeCentreOfGravity();
+    computeFulledges();
 
     return true;
 }
 
+/**
+ * @brief Visits the half-edges leaving vertexId, walking its 1-ring like TriangleMesh::visitNeighbourhoodOf.
+ *        A vertex on a boundary has its 1-ring walked forwards until the boundary, then backwards
+ *        from its firstDirectedEdge
+ */
+template<typename Visitor>
+static void visitOutgoingEdges(const TriangleMesh& mesh, const VertexId vertexId, const Visitor& visitor) {
+    const EdgeId firstEdge = mesh.firstDirectedEdge[vertexId];
+    if (firstEdge == NO_VALUE) {
+        return;
+    }
+
+    EdgeId currentEdge = firstEdge;
+    do {
+        visitor(currentEdge);
+        const EdgeId otherEdge = mesh.otherHalf[currentEdge];
+        if (otherEdge == NO_VALUE) {
+            break;
+        }
+        currentEdge = TriangleMesh::nextIdInFace(otherEdge);
+    } while (currentEdge != firstEdge);
+
+    if (currentEdge == firstEdge && mesh.otherHalf[firstEdge] != NO_VALUE) {
+        return;
+    }
+
+    // the half-edge arriving at vertexId in a face is the other half of the one leaving it in the previous face
+    currentEdge = mesh.otherHalf[TriangleMesh::idToIndex(firstEdge)];
+    while (currentEdge != NO_VALUE) {
+        visitor(currentEdge);
+        currentEdge = mesh.otherHalf[TriangleMesh::idToIndex(currentEdge)];
+    }
+}
+
+/**
+ * @brief Sums the faces around vertexId in the order of its 1-ring, so that the sum is the same
+ *        whichever thread computes it
+ *
+ * @param faceVector of each face, its cross product for AREA weighting, its unit normal otherwise
+ *
+ * @return the normal of vertexId, unnormalised
+ */
+template<typename FaceVector>
+static Cartesian3 gatherNormal(const TriangleMesh& mesh, const VertexId vertexId, const NormalWeighting weighting,
+                               const FaceVector& faceVector) {
+    Cartesian3 normal(0.0f, 0.0f, 0.0f);
+
+    visitOutgoingEdges(mesh, vertexId, [&](const EdgeId edgeId) {
+        if (weighting != NormalWeighting::ANGLE) {
+            normal += faceVector(edgeId / 3);
+            return;
+        }
+
+        // edgeId leaves vertexId, the edge after it in the face arrives at the third vertex
+        const Cartesian3& corner = mesh.vertices[vertexId];
+        const Cartesian3 out = mesh.vertices[mesh.faceVertices[edgeId]] - corner;
+        const Cartesian3 in = mesh.vertices[mesh.faceVertices[TriangleMesh::nextIdInFace(edgeId)]] - corner;
+        normal += std::atan2(out.cross(in).length(), out.dot(in)) * faceVector(edgeId / 3);
+    });
+
+    return normal;
+}
+
 /*
  * Based on: https://iquilezles.org/articles/normals/
+ *
+ * Each vertex gathers the faces of its 1-ring instead of each face scattering into its 3 vertices,
+ * so that vertices are independent and sum in the same order whatever the thread count
  */
-void TriangleMesh::computeNormals() {
-    normals.assign(vertices.size(), {0.0f, 0.0f, 0.0f});
+void TriangleMesh::computeNormals(const NormalWeighting weighting) {
+    const FaceIndex faceCount = faceVertices.size() / 3;
+    faceNormals.resize(faceCount);
+    normalWeighting = weighting;
+
+    // area weighting sums the cross products, whose length is twice the face area, before they are normalised
+    const bool isAreaWeighted = weighting == NormalWeighting::AREA;
+    parallelFor(0, faceCount, [&](const FaceIndex begin, const FaceIndex end) {
+        for (FaceIndex face = begin; face < end; face++) {
+            faceNormals[face] = isAreaWeighted ? faceCross(face) : faceCross(face).unit();
+        }
+    });
+
+    normals.resize(vertices.size());
+    const auto faceVector = [this](const FaceIndex face) -> const Cartesian3& {
+        return faceNormals[face];
+    };
+    parallelFor(0, normals.size(), [&](const VertexId begin, const VertexId end) {
+        for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+            normals[vertexId] = gatherNormal(*this, vertexId, weighting, faceVector).unit();
+        }
+    });
+
+    if (isAreaWeighted) {
+        parallelFor(0, faceCount, [&](const FaceIndex begin, const FaceIndex end) {
+            for (FaceIndex face = begin; face < end; face++) {
+                faceNormals[face] = faceNormals[face].unit();
+            }
+        });
+    }
+}
 
-    for (FaceIndex face = 0; face < faceVertices.size(); face += 3) {
-        const VertexId pId = faceVertices[face];
-        const VertexId qId = faceVertices[face + 1];
-        const VertexId rId = faceVertices[face + 2];
-        const auto& p = vertices[pId];
-        const auto& q = vertices[qId];
-        const auto& r = vertices[rId];
+void TriangleMesh::computeFaceNormals() {
+    faceNormals.resize(faceVertices.size() / 3);
 
-        // Accumulate cross product
-        Cartesian3 pq = q - p;
-        Cartesian3 pr = r - p;
+    parallelFor(0, faceNormals.size(), [&](const FaceIndex begin, const FaceIndex end) {
+        for (FaceIndex face = begin; face < end; face++) {
+            faceNormals[face] = faceCross(face).unit();
+        }
+    });
+}
 
-        const Cartesian3 cross = pq.cross(pr);
+void TriangleMesh::computeFulledges() {
+    fulledges.resize(faceVertices.size());
+    numberFulledges(view(), 0, faceVertices.size(), 0, fulledges.data());
+
+    computeFulledgeHalfEdges();
+}
 
-        normals[pId] += cross;
-        normals[qId] += cross;
-        normals[rId] += cross;
+/**
+ * @brief Inverts fulledges, each fulledge being reached from the lower of its half-edges.
+ *        Half-edges on a boundary have no other half, & are a fulledge of their own
+ */
+void TriangleMesh::computeFulledgeHalfEdges() {
+    unsigned int fulledgeCount = 0;
+    for (EdgeId edgeId = 0; edgeId < otherHalf.size(); edgeId++) {
+        if (edgeId < otherHalf[edgeId]) {
+            fulledgeCount++;
+        }
     }
 
-    // Normalise the accumulation
-    for (auto& normal : normals) {
-        normal = normal.unit();
+    fulledgeHalfEdges.resize(fulledgeCount);
+    for (EdgeId edgeId = 0; edgeId < otherHalf.size(); edgeId++) {
+        if (edgeId < otherHalf[edgeId]) {
+            fulledgeHalfEdges[fulledges[edgeId]] = edgeId;
+        }
     }
 }
 
+/**
+ * @brief Checks, in order:
+ *      - that the arrays agree in size & that every index is in range, the other checks relying on it
+ *      - faces for repeated vertices & zero area
+ *      - the half-edges between each pair of vertices, grouped by the vertex they leave: a half-edge
+ *        should have exactly one running the other way, which otherHalf should point to
+ *      - that walking the 1-ring of each vertex from its first directed edge visits every half-edge
+ *        leaving it, & returns to the first one unless it stopped at a boundary both ways
+ *
+ * Each defect is reported once, by the lowest half-edge involved
+ */
+std::vector<MeshDefect> TriangleMesh::validate() const {
+    std::vector<MeshDefect> defects;
+    const auto report = [&](const MeshDefect::Kind kind, const unsigned int element, const std::string& description) {
+        defects.push_back({kind, element, description});
+    };
+
+    const unsigned int halfEdgeCount = faceVertices.size();
+    if (halfEdgeCount % 3 != 0 || otherHalf.size() != halfEdgeCount || firstDirectedEdge.size() != vertices.size()) {
+        report(MeshDefect::OUT_OF_RANGE_INDEX, NO_VALUE,
+               std::to_string(halfEdgeCount) + " face vertices, " + std::to_string(otherHalf.size()) +
+               " other halves, " + std::to_string(vertices.size()) + " vertices & " +
+               std::to_string(firstDirectedEdge.size()) + " first directed edges");
+        return defects;
+    }
+
+    for (EdgeId edgeId = 0; edgeId < halfEdgeCount; edgeId++) {
+        if (faceVertices[edgeId] >= vertices.size()) {
+            report(MeshDefect::OUT_OF_RANGE_INDEX, edgeId,
+                   "face vertex " + std::to_string(edgeId) + " is vertex " + std::to_string(faceVertices[edgeId]));
+        }
+        if (otherHalf[edgeId] >= halfEdgeCount && otherHalf[edgeId] != NO_VALUE) {
+            report(MeshDefect::OUT_OF_RANGE_INDEX, edgeId,
+                   "other half of " + std::to_string(edgeId) + " is half-edge " + std::to_string(otherHalf[edgeId]));
+        }
+    }
+    for (VertexId vertexId = 0; vertexId < vertices.size(); vertexId++) {
+        if (firstDirectedEdge[vertexId] >= halfEdgeCount) {
+            report(MeshDefect::OUT_OF_RANGE_INDEX, vertexId,
+                   "first directed edge of vertex " + std::to_string(vertexId) + " is half-edge " +
+                   (firstDirectedEdge[vertexId] == NO_VALUE ? "none" : std::to_string(firstDirectedEdge[vertexId])));
+        }
+    }
+    if (!defects.empty()) {
+        return defects;
+    }
+
+    for (FaceIndex face = 0; face < halfEdgeCount / 3; face++) {
+        const VertexId* corners = &faceVertices[3 * face];
+        if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+            report(MeshDefect::DEGENERATE_FACE, face, "face " + std::to_string(face) + " repeats a vertex");
+        } else if (faceCross(face).length() == 0.0f) {
+            report(MeshDefect::DEGENERATE_FACE, face,
+                   "face " + std::to_string(face) + " has no area, at " + vertices[corners[0]].toString());
+        }
+    }
+
+    const OutgoingEdges outgoingEdges(faceVertices, vertices.size());
+    const auto describe = [&](const EdgeId edgeId) {
+        const auto [from, to] = vertexIndicesOf(edgeId);
+        return "half-edge " + std::to_string(edgeId) + " from " + vertices[from].toString() + " to " +
+               vertices[to].toString();
+    };
+
+    for (EdgeId edgeId = 0; edgeId < halfEdgeCount; edgeId++) {
+        const auto [from, to] = vertexIndicesOf(edgeId);
+        if (from == to) {
+            continue;
+        }
+
+        const auto [sameCount, lowestSame] = outgoingEdges.between(from, to);
+        const auto [oppositeCount, lowestOpposite] = outgoingEdges.between(to, from);
+        // a pair of vertices is reported by its lowest half-edge only
+        const bool isLowest = edgeId == lowestSame && edgeId < lowestOpposite;
+
+        if (sameCount + oppositeCount > 2) {
+            if (isLowest) {
+                report(MeshDefect::NON_MANIFOLD_EDGE, edgeId,
+                       describe(edgeId) + " is one of " + std::to_string(sameCount + oppositeCount) + " between them");
+            }
+        } else if (sameCount == 2) {
+            if (isLowest) {
+                report(MeshDefect::INCONSISTENT_WINDING, edgeId,
+                       describe(edgeId) + " runs the same way as another, their faces wind oppositely");
+            }
+        } else if (oppositeCount == 0) {
+            report(MeshDefect::UNPAIRED_EDGE, edgeId, describe(edgeId) + " has no other half");
+        } else if (otherHalf[edgeId] != lowestOpposite) {
+            report(MeshDefect::MISMATCHED_OTHER_HALF, edgeId,
+                   describe(edgeId) + " has other half " +
+                   (otherHalf[edgeId] == NO_VALUE ? "none" : std::to_string(otherHalf[edgeId])) + " instead of " +
+                   std::to_string(lowestOpposite));
+        }
+    }
+
+    for (VertexId vertexId = 0; vertexId < vertices.size(); vertexId++) {
+        const EdgeId firstEdge = firstDirectedEdge[vertexId];
+        const unsigned int valence = outgoingEdges.valence(vertexId);
+        if (outgoingEdges.tail(firstEdge) != vertexId) {
+            report(MeshDefect::MISPLACED_FIRST_EDGE, vertexId,
+                   "first directed edge of vertex " + std::to_string(vertexId) + " does not leave it");
+            continue;
+        }
+
+        // like visitOutgoingEdges, giving up on walks that leave the vertex or outlast its valence
+        unsigned int visited = 0;
+        EdgeId currentEdge = firstEdge;
+        bool isBoundary = false;
+        do {
+            visited++;
+            const EdgeId otherEdge = otherHalf[currentEdge];
+            if (otherEdge == NO_VALUE) {
+                isBoundary = true;
+                break;
+            }
+            currentEdge = nextIdInFace(otherEdge);
+        } while (currentEdge != firstEdge && outgoingEdges.tail(currentEdge) == vertexId && visited <= valence);
+
+        if (isBoundary) {
+            currentEdge = otherHalf[idToIndex(firstEdge)];
+            while (currentEdge != NO_VALUE && outgoingEdges.tail(currentEdge) == vertexId && visited <= valence) {
+                visited++;
+                currentEdge = otherHalf[idToIndex(currentEdge)];
+            }
+        }
+
+        if (visited != valence || (!isBoundary && currentEdge != firstEdge)) {
+            report(MeshDefect::NON_MANIFOLD_VERTEX, vertexId,
+                   "1-ring walk of vertex " + std::to_string(vertexId) + " at " + vertices[vertexId].toString() +
+                   " visits " + std::to_string(visited) + " of its " + std::to_string(valence) + " half-edges");
+        }
+    }
+
+    return defects;
+}
+
+bool TriangleMesh::onlyPinchedVertices(const std::vector<MeshDefect>& defects) {
+    return std::all_of(defects.begin(), defects.end(), [](const MeshDefect& defect) {
+        return defect.kind == MeshDefect::NON_MANIFOLD_VERTEX;
+    });
+}
+
+void TriangleMesh::printDefects(const std::vector<MeshDefect>& defects, std::ostream& stream) {
+    static const std::map<MeshDefect::Kind, std::string> kindNames = {
+        {MeshDefect::OUT_OF_RANGE_INDEX, "out of range index"},
+        {MeshDefect::DEGENERATE_FACE, "degenerate face"},
+        {MeshDefect::UNPAIRED_EDGE, "unpaired edge"},
+        {MeshDefect::NON_MANIFOLD_EDGE, "non-manifold edge"},
+        {MeshDefect::INCONSISTENT_WINDING, "inconsistent winding"},
+        {MeshDefect::MISMATCHED_OTHER_HALF, "mismatched other half"},
+        {MeshDefect::MISPLACED_FIRST_EDGE, "misplaced first edge"},
+        {MeshDefect::NON_MANIFOLD_VERTEX, "non-manifold vertex"}
+    };
+
+    std::map<MeshDefect::Kind, unsigned int> kindCounts;
+    for (const MeshDefect& defect : defects) {
+        if (++kindCounts[defect.kind] <= PRINTED_DEFECTS_PER_KIND) {
+            stream << "  " << kindNames.at(defect.kind) << ": " << defect.description << '\n';
+        }
+    }
+    for (const auto& [kind, count] : kindCounts) {
+        if (count > PRINTED_DEFECTS_PER_KIND) {
+            stream << "  ... " << count - PRINTED_DEFECTS_PER_KIND << " more of kind " << kindNames.at(kind) << '\n';
+        }
+    }
+    stream << defects.size() << " defects" << std::endl;
+}
+
+Cartesian3 TriangleMesh::faceCross(const FaceIndex face) const {
+    const auto& p = vertices[faceVertices[3 * face]];
+    const auto& q = vertices[faceVertices[3 * face + 1]];
+    const auto& r = vertices[faceVertices[3 * face + 2]];
+
+    // spelled out, as the out of line Cartesian3 operators dominate the 1-ring gathers of computeNormals
+    const float ux = q.x - p.x, uy = q.y - p.y, uz = q.z - p.z;
+    const float vx = r.x - p.x, vy = r.y - p.y, vz = r.z - p.z;
+    return Cartesian3(uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx);
+}
+
 void TriangleMesh::computeCentreOfGravity() {
-    // note that very large files may have numerical problems with this
+    // summed in double, as very large files lose the contribution of later vertices to a float sum
+    vertexSum = {0.0, 0.0, 0.0};
     centreOfGravity = Cartesian3(0.0, 0.0, 0.0);
+    movedVertices.clear();
+    farthestVertex = NO_VALUE;
 
     // if there are no vertices, leave centre at (0.0, 0.0, 0.0)
     if (vertices.empty()) {
@@ -256,180 +698,693 @@ void TriangleMesh::computeCentreOfGravity() {
 
     // sum up all vertex positions
     for (const auto& vertex : vertices) {
-        centreOfGravity = centreOfGravity + vertex;
+        vertexSum[0] += vertex.x;
+        vertexSum[1] += vertex.y;
+        vertexSum[2] += vertex.z;
     }
 
     // and divide through by the number to get the average position
     // also known as the barycentre
-    centreOfGravity = centreOfGravity / vertices.size();
+    centreOfGravity = Cartesian3(vertexSum[0] / vertices.size(),
+                                 vertexSum[1] / vertices.size(),
+                                 vertexSum[2] / vertices.size());
 
     // start with 0 radius
     objectSize = 0.0;
 
     // now compute the largest distance from the origin to a vertex
-    for (const auto& vertex : vertices) {
+    for (VertexId vertexId = 0; vertexId < vertices.size(); vertexId++) {
         // now test for maximality
-        if (const float distance = (vertex - centreOfGravity).length();
+        if (const float distance = (vertices[vertexId] - centreOfGravity).length();
             distance > objectSize) {
             objectSize = distance;
+            farthestVertex = vertexId;
         }
     }
 }
 
-unsigned int TriangleMesh::idToIndex(const EdgeId edgeId) {
-    return 3 * (edgeId / 3) + (3 + edgeId - 1) % 3;
-}
+void TriangleMesh::moveVertex(const VertexId vertexId, const Cartesian3& position) {
+    const Cartesian3& previous = vertices[vertexId];
+    vertexSum[0] += static_cast<double>(position.x) - previous.x;
+    vertexSum[1] += static_cast<double>(position.y) - previous.y;
+    vertexSum[2] += static_cast<double>(position.z) - previous.z;
 
-EdgeId TriangleMesh::nextIdInFace(const EdgeId edgeId) {
-    return 3 * (edgeId / 3) + (edgeId + 1) % 3;
+    vertices[vertexId] = position;
+    movedVertices.push_back(vertexId);
 }
 
-std::pair<VertexId, VertexId> TriangleMesh::vertexIndicesOf(const EdgeId edgeId) const {
-    const unsigned int fromIndex = idToIndex(edgeId);
-    const unsigned int toIndex = idToIndex(nextIdInFace(edgeId));
+/**
+ * @brief Recomputes the normals of the faces around the moved vertices, then the vertex normals gathering
+ *        any of those faces, i.e. the moved vertices & their neighbours
+ *
+ * The farthest vertex from the centre may have moved inwards, which only a full pass can tell,
+ * so objectSize is kept as an upper bound: a vertex that did not move is at most as much farther
+ * from the centre as the centre moved. No vertex is farther than the true size, so the moved vertices & the farthest
+ * one of the last full pass bound it from below, & once the bound is OBJECT_SIZE_SLACK times that, a full pass is made
+ */
+void TriangleMesh::updateMovedVertices() {
+    if (movedVertices.empty()) {
+        return;
+    }
 
-    return {faceVertices[fromIndex], faceVertices[toIndex]};
+    std::sort(movedVertices.begin(), movedVertices.end());
+    movedVertices.erase(std::unique(movedVertices.begin(), movedVertices.end()), movedVertices.end());
+    // a vertex moved, then freed by a later edit, has no 1-ring left & its position no longer counts
+    std::vector<bool> isFree(vertices.size(), false);
+    for (const VertexId vertexId : freeVertices) {
+        isFree[vertexId] = true;
+    }
+    movedVertices.erase(std::remove_if(movedVertices.begin(), movedVertices.end(), [&](const VertexId vertexId) {
+        return isFree[vertexId];
+    }), movedVertices.end());
+
+    std::vector<FaceIndex> movedFaces;
+    for (const VertexId vertexId : movedVertices) {
+        visitOutgoingEdges(*this, vertexId, [&](const EdgeId edgeId) {
+            movedFaces.push_back(edgeId / 3);
+        });
+    }
+    std::sort(movedFaces.begin(), movedFaces.end());
+    movedFaces.erase(std::unique(movedFaces.begin(), movedFaces.end()), movedFaces.end());
+
+    std::vector<VertexId> ringVertices;
+    ringVertices.reserve(3 * movedFaces.size());
+    for (const FaceIndex face : movedFaces) {
+        ringVertices.insert(ringVertices.end(), &faceVertices[3 * face], &faceVertices[3 * face] + 3);
+    }
+    std::sort(ringVertices.begin(), ringVertices.end());
+    ringVertices.erase(std::unique(ringVertices.begin(), ringVertices.end()), ringVertices.end());
+
+    parallelFor(0, movedFaces.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; i++) {
+            faceNormals[movedFaces[i]] = faceCross(movedFaces[i]).unit();
+        }
+    });
+    // faceNormals are unit by now, area weighting recomputes the cross products of the few faces it needs
+    const auto faceVector = [this](const FaceIndex face) {
+        return normalWeighting == NormalWeighting::AREA ? faceCross(face) : faceNormals[face];
+    };
+    parallelFor(0, ringVertices.size(), [&](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; i++) {
+            normals[ringVertices[i]] = gatherNormal(*this, ringVertices[i], normalWeighting, faceVector).unit();
+        }
+    });
+
+    const Cartesian3 previousCentre = centreOfGravity;
+    const double vertexCount = vertices.size() - freeVertices.size();
+    centreOfGravity = Cartesian3(vertexSum[0] / vertexCount,
+                                 vertexSum[1] / vertexCount,
+                                 vertexSum[2] / vertexCount);
+
+    objectSize += (centreOfGravity - previousCentre).length();
+    float lowerBound =
+        farthestVertex < vertices.size() ? (vertices[farthestVertex] - centreOfGravity).length() : 0.0f;
+    for (const VertexId vertexId : movedVertices) {
+        lowerBound = std::max(lowerBound, (vertices[vertexId] - centreOfGravity).length());
+    }
+    objectSize = std::max(objectSize, lowerBound);
+
+    if (objectSize > OBJECT_SIZE_SLACK * lowerBound) {
+        objectSize = 0.0f;
+        farthestVertex = NO_VALUE;
+        for (VertexId vertexId = 0; vertexId < vertices.size(); vertexId++) {
+            if (const float distance = (vertices[vertexId] - centreOfGravity).length();
+                !isFree[vertexId] && distance > objectSize) {
+                objectSize = distance;
+                farthestVertex = vertexId;
+            }
+        }
+    }
+
+    movedVertices.clear();
 }
 
 /**
- * Returns a Loop Subdivision of the TriangleMesh.
- * Assumes that the surface is 2-manifold and the edges are in the format edge[to].
+ * @return whether the half-edges leaving the tail of first lead back to first, i.e. the tail is off any boundary.
+ *         The vertex each one arrives at is appended to neighbours
  */
-TriangleMesh TriangleMesh::subdivide() const {
-    TriangleMesh subdivision;
+static bool closedRingOf(const TriangleMesh& mesh, const EdgeId first, std::vector<VertexId>& neighbours) {
+    EdgeId currentEdge = first;
+    do {
+        neighbours.push_back(mesh.faceVertices[currentEdge]);
+        const EdgeId otherEdge = mesh.otherHalf[currentEdge];
+        if (otherEdge == NO_VALUE) {
+            return false;
+        }
+        currentEdge = TriangleMesh::nextIdInFace(otherEdge);
+    } while (currentEdge != first);
+
+    return true;
+}
 
-    // copy all old vertices to retain their indices
-    subdivision.vertices.insert(subdivision.vertices.end(), vertices.begin(), vertices.end());
+// half-edges leaving vertexId, one less than its edges on a boundary
+static unsigned int valenceOf(const TriangleMesh& mesh, const VertexId vertexId) {
+    unsigned int valence = 0;
+    visitOutgoingEdges(mesh, vertexId, [&](EdgeId) {
+        valence++;
+    });
+    return valence;
+}
+
+// makes first & second each other's otherHalf, second may be NO_VALUE on a boundary
+static void pairHalves(std::vector<EdgeId>& otherHalf, const EdgeId first, const EdgeId second) {
+    otherHalf[first] = second;
+    if (second != NO_VALUE) {
+        otherHalf[second] = first;
+    }
+}
 
-    // edgeId -> fulledgeId
-    std::vector<unsigned int> fulledges(faceVertices.size(), NO_VALUE);
-    // fulledgeId -> vertexId
-    std::vector<VertexId> fulledgeToEdgeVertex;
-    // subdivisionVertexId -> <halfEdge, otherHalf>
-    std::unordered_map<VertexId, std::pair<EdgeId, EdgeId>> edgeVertexToHalves;
+bool TriangleMesh::canFlipEdge(const EdgeId edgeId) const {
+    const EdgeId opposite = otherHalf[edgeId];
+    if (opposite == NO_VALUE) {
+        return false;
+    }
 
-    for (EdgeId edgeId = 0; edgeId < faceVertices.size(); edgeId++) {
-        if (fulledges[edgeId] == NO_VALUE) {
-            FaceIndex nextFulledgeIndex = fulledgeToEdgeVertex.size();
-            // Assign fulledge to both half-edges
-            fulledges[edgeId] = nextFulledgeIndex;
-            fulledges[otherHalf[edgeId]] = nextFulledgeIndex;
-            // avoid overlapping with existing vertices and associates vertex index to fulledge
-            VertexId subdivisionVertexId = vertices.size() + nextFulledgeIndex;
-            fulledgeToEdgeVertex.push_back(subdivisionVertexId);
-            edgeVertexToHalves[subdivisionVertexId] = {edgeId, otherHalf[edgeId]};
-        }
-    }
-
-    // Compute subdivided faces
-    std::vector<FaceIndex> centralFaces;
-    std::vector<FaceIndex> adjacentFaces;
-    for (FaceIndex faceIndex = 0; faceIndex < faceVertices.size(); faceIndex += 3) {
-        // Create vertex indices of central subdivided face
-        VertexId vc0 = fulledgeToEdgeVertex[fulledges[faceIndex]];
-        VertexId vc1 = fulledgeToEdgeVertex[fulledges[faceIndex + 1]];
-        VertexId vc2 = fulledgeToEdgeVertex[fulledges[faceIndex + 2]];
-
-        centralFaces.insert(centralFaces.end(), {vc0, vc1, vc2});
-
-        // Create vertex indices of adjacent subdivided faces
-        VertexId v0 = faceVertices[faceIndex];
-        adjacentFaces.insert(adjacentFaces.end(), {v0, vc1, vc0});
-
-        VertexId v1 = faceVertices[faceIndex + 1];
-        adjacentFaces.insert(adjacentFaces.end(), {v1, vc2, vc1});
-
-        VertexId v2 = faceVertices[faceIndex + 2];
-        adjacentFaces.insert(adjacentFaces.end(), {v2, vc0, vc2});
-    }
-    // subdivision faces = central faces + adjacent faces
-    // Guarantees that central faces come first, then adjacent faces
-    subdivision.faceVertices.reserve(centralFaces.size() + adjacentFaces.size());
-    subdivision.faceVertices.insert(subdivision.faceVertices.end(), centralFaces.begin(), centralFaces.end());
-    subdivision.faceVertices.insert(subdivision.faceVertices.end(), adjacentFaces.begin(), adjacentFaces.end());
-
-    // Compute subdivision otherHalf & firstDirectedEdge
-    subdivision.otherHalf.resize(subdivision.faceVertices.size(), NO_VALUE);
-    // #subdivision.vertices = #vertices + #fulledgeVertices
-    subdivision.firstDirectedEdge.resize(vertices.size() + fulledgeToEdgeVertex.size(), NO_VALUE);
-    for (EdgeId edgeId = 0; edgeId < subdivision.faceVertices.size(); edgeId++) {
-        // Skip already assigned halfEdges
-        if (subdivision.otherHalf[edgeId] != NO_VALUE) {
-            continue;
+    const VertexId leftApex = faceVertices[nextIdInFace(edgeId)];
+    const VertexId rightApex = faceVertices[nextIdInFace(opposite)];
+    if (leftApex == rightApex ||
+        valenceOf(*this, faceVertices[idToIndex(edgeId)]) <= 3 ||
+        valenceOf(*this, faceVertices[edgeId]) <= 3) {
+        return false;
+    }
+
+    // a boundary edge between the apexes is only reached from the apex it leaves
+    bool isJoined = false;
+    visitOutgoingEdges(*this, leftApex, [&](const EdgeId outgoing) {
+        isJoined |= faceVertices[outgoing] == rightApex;
+    });
+    visitOutgoingEdges(*this, rightApex, [&](const EdgeId outgoing) {
+        isJoined |= faceVertices[outgoing] == leftApex;
+    });
+    return !isJoined;
+}
+
+/**
+ * @brief Rewrites the corners of both faces in place, so that no face is freed or allocated
+ *        and only the 4 other halves around them are repaired
+ */
+void TriangleMesh::flipEdge(const EdgeId edgeId) {
+    const EdgeId next = nextIdInFace(edgeId);
+    const EdgeId previous = nextIdInFace(next);
+    const EdgeId opposite = otherHalf[edgeId];
+    const EdgeId oppositeNext = nextIdInFace(opposite);
+    const EdgeId oppositePrevious = nextIdInFace(oppositeNext);
+
+    const VertexId tail = faceVertices[previous];
+    const VertexId head = faceVertices[edgeId];
+    const VertexId leftApex = faceVertices[next];
+    const VertexId rightApex = faceVertices[oppositeNext];
+
+    // leftApex -> head, tail -> leftApex, rightApex -> tail & head -> rightApex
+    const EdgeId leftIn = otherHalf[next];
+    const EdgeId leftOut = otherHalf[previous];
+    const EdgeId rightIn = otherHalf[oppositeNext];
+    const EdgeId rightOut = otherHalf[oppositePrevious];
+
+    // rightApex -> leftApex -> tail -> rightApex, then leftApex -> rightApex -> head -> leftApex
+    faceVertices[edgeId] = leftApex;
+    faceVertices[next] = tail;
+    faceVertices[previous] = rightApex;
+    faceVertices[opposite] = rightApex;
+    faceVertices[oppositeNext] = head;
+    faceVertices[oppositePrevious] = leftApex;
+
+    pairHalves(otherHalf, next, leftOut);
+    pairHalves(otherHalf, previous, rightIn);
+    pairHalves(otherHalf, oppositeNext, rightOut);
+    pairHalves(otherHalf, oppositePrevious, leftIn);
+
+    firstDirectedEdge[tail] = previous;
+    firstDirectedEdge[head] = oppositePrevious;
+    firstDirectedEdge[leftApex] = next;
+    firstDirectedEdge[rightApex] = oppositeNext;
+
+    // both faces are around either apex, the ends of edgeId are corners of them
+    movedVertices.push_back(leftApex);
+    movedVertices.push_back(rightApex);
+}
+
+/**
+ * @brief The faces of edgeId keep the half of them next to its tail, a new face beside each takes
+ *        the half next to its head
+ */
+VertexId TriangleMesh::splitEdge(const EdgeId edgeId, const Cartesian3& position) {
+    const EdgeId next = nextIdInFace(edgeId);
+    const EdgeId opposite = otherHalf[edgeId];
+    const VertexId head = faceVertices[edgeId];
+    const VertexId leftApex = faceVertices[next];
+    const EdgeId leftIn = otherHalf[next];
+
+    const VertexId middle = allocateVertex(position);
+    const FaceIndex left = allocateFace();
+
+    // edgeId: tail -> middle, next: middle -> leftApex, left: middle -> head -> leftApex -> middle
+    faceVertices[edgeId] = middle;
+    faceVertices[3 * left] = head;
+    faceVertices[3 * left + 1] = leftApex;
+    faceVertices[3 * left + 2] = middle;
+    pairHalves(otherHalf, 3 * left + 1, leftIn);
+    pairHalves(otherHalf, 3 * left + 2, next);
+    otherHalf[3 * left] = NO_VALUE;
+
+    if (firstDirectedEdge[head] == next) {
+        firstDirectedEdge[head] = 3 * left + 1;
+    }
+    firstDirectedEdge[middle] = next;
+
+    if (opposite != NO_VALUE) {
+        const EdgeId oppositePrevious = nextIdInFace(nextIdInFace(opposite));
+        const VertexId rightApex = faceVertices[nextIdInFace(opposite)];
+        const EdgeId rightOut = otherHalf[oppositePrevious];
+        const FaceIndex right = allocateFace();
+
+        // opposite: middle -> tail, oppositePrevious: rightApex -> middle, right: head -> middle -> rightApex -> head
+        faceVertices[oppositePrevious] = middle;
+        faceVertices[3 * right] = middle;
+        faceVertices[3 * right + 1] = rightApex;
+        faceVertices[3 * right + 2] = head;
+        pairHalves(otherHalf, 3 * right, 3 * left);
+        pairHalves(otherHalf, 3 * right + 1, oppositePrevious);
+        pairHalves(otherHalf, 3 * right + 2, rightOut);
+
+        if (firstDirectedEdge[head] == opposite) {
+            firstDirectedEdge[head] = 3 * right;
         }
+    }
+
+    movedVertices.push_back(middle);
+    return middle;
+}
 
-        // halfEdge = [from -> to]
-        const auto [from, to] = subdivision.vertexIndicesOf(edgeId);
+bool TriangleMesh::canCollapseEdge(const EdgeId edgeId) const {
+    const EdgeId opposite = otherHalf[edgeId];
+    if (opposite == NO_VALUE) {
+        return false;
+    }
+
+    std::vector<VertexId> tailNeighbours;
+    std::vector<VertexId> headNeighbours;
+    if (!closedRingOf(*this, edgeId, tailNeighbours) || !closedRingOf(*this, opposite, headNeighbours)) {
+        return false;
+    }
+
+    unsigned int sharedCount = 0;
+    for (const VertexId neighbour : headNeighbours) {
+        sharedCount += std::count(tailNeighbours.begin(), tailNeighbours.end(), neighbour);
+    }
 
-        // Set first directed edge, if not present
-        if (subdivision.firstDirectedEdge[from] == NO_VALUE) {
-            subdivision.firstDirectedEdge[from] = edgeId;
+    return sharedCount == 2 &&
+           valenceOf(*this, faceVertices[nextIdInFace(edgeId)]) > 3 &&
+           valenceOf(*this, faceVertices[nextIdInFace(opposite)]) > 3;
+}
+
+/**
+ * @brief Only the half-edges leaving the head are retargeted & the 4 other halves across the freed faces
+ *        paired up, the rest of the mesh keeps its ids
+ */
+void TriangleMesh::collapseEdge(const EdgeId edgeId, const Cartesian3& position) {
+    const EdgeId next = nextIdInFace(edgeId);
+    const EdgeId previous = nextIdInFace(next);
+    const EdgeId opposite = otherHalf[edgeId];
+    const EdgeId oppositeNext = nextIdInFace(opposite);
+    const EdgeId oppositePrevious = nextIdInFace(oppositeNext);
+
+    const VertexId tail = faceVertices[previous];
+    const VertexId head = faceVertices[edgeId];
+    const VertexId leftApex = faceVertices[next];
+    const VertexId rightApex = faceVertices[oppositeNext];
+
+    // leftApex -> head, tail -> leftApex, rightApex -> tail & head -> rightApex
+    const EdgeId leftIn = otherHalf[next];
+    const EdgeId leftOut = otherHalf[previous];
+    const EdgeId rightIn = otherHalf[oppositeNext];
+    const EdgeId rightOut = otherHalf[oppositePrevious];
+
+    EdgeId outgoing = next;
+    do {
+        if (outgoing / 3 != edgeId / 3 && outgoing / 3 != opposite / 3) {
+            faceVertices[idToIndex(outgoing)] = tail;
         }
+        outgoing = nextIdInFace(otherHalf[outgoing]);
+    } while (outgoing != next);
 
-        // Find otherHalfEdge = [to -> from]
-        for (EdgeId otherEdgeId = 0; otherEdgeId < subdivision.faceVertices.size(); otherEdgeId++) {
-            // Skip same edge
-            if (otherEdgeId == edgeId) continue;
+    pairHalves(otherHalf, leftIn, leftOut);
+    pairHalves(otherHalf, rightIn, rightOut);
 
-            const auto [otherFrom, otherTo] = subdivision.vertexIndicesOf(otherEdgeId);
+    firstDirectedEdge[tail] = leftOut;
+    firstDirectedEdge[leftApex] = leftIn;
+    firstDirectedEdge[rightApex] = rightIn;
 
-            if (from == otherTo && to == otherFrom) {
-                subdivision.otherHalf[edgeId] = otherEdgeId;
-                subdivision.otherHalf[otherEdgeId] = edgeId;
-                break;
+    freeFace(edgeId / 3);
+    freeFace(opposite / 3);
+    freeVertex(head);
+    moveVertex(tail, position);
+}
+
+/**
+ * @brief Ids only ever move down, so the arrays are compacted in place, in a single pass each
+ */
+void TriangleMesh::compact() {
+    if (!freeVertices.empty() || !freeFaces.empty()) {
+        std::vector<VertexId> newVertexIds(vertices.size(), 0);
+        for (const VertexId vertexId : freeVertices) {
+            newVertexIds[vertexId] = NO_VALUE;
+        }
+        VertexId vertexCount = 0;
+        for (VertexId& newId : newVertexIds) {
+            if (newId != NO_VALUE) {
+                newId = vertexCount++;
+            }
+        }
+
+        std::vector<FaceIndex> newFaces(faceVertices.size() / 3, 0);
+        for (const FaceIndex face : freeFaces) {
+            newFaces[face] = NO_VALUE;
+        }
+        FaceIndex faceCount = 0;
+        for (FaceIndex& newFace : newFaces) {
+            if (newFace != NO_VALUE) {
+                newFace = faceCount++;
+            }
+        }
+
+        const auto newEdgeId = [&newFaces](const EdgeId edgeId) -> EdgeId {
+            return edgeId == NO_VALUE ? NO_VALUE : 3 * newFaces[edgeId / 3] + edgeId % 3;
+        };
+
+        for (VertexId oldId = 0; oldId < newVertexIds.size(); oldId++) {
+            if (const VertexId newId = newVertexIds[oldId]; newId != NO_VALUE) {
+                vertices[newId] = vertices[oldId];
+                firstDirectedEdge[newId] = newEdgeId(firstDirectedEdge[oldId]);
+                if (oldId < normals.size()) {
+                    normals[newId] = normals[oldId];
+                }
+            }
+        }
+        vertices.resize(vertexCount);
+        firstDirectedEdge.resize(vertexCount);
+        normals.resize(std::min<size_t>(normals.size(), vertexCount));
+
+        for (FaceIndex oldId = 0; oldId < newFaces.size(); oldId++) {
+            if (const FaceIndex newId = newFaces[oldId]; newId != NO_VALUE) {
+                for (unsigned int slot = 0; slot < 3; slot++) {
+                    faceVertices[3 * newId + slot] = newVertexIds[faceVertices[3 * oldId + slot]];
+                    otherHalf[3 * newId + slot] = newEdgeId(otherHalf[3 * oldId + slot]);
+                }
+                if (oldId < faceNormals.size()) {
+                    faceNormals[newId] = faceNormals[oldId];
+                }
+            }
+        }
+        faceVertices.resize(3 * faceCount);
+        otherHalf.resize(3 * faceCount);
+        faceNormals.resize(std::min<size_t>(faceNormals.size(), faceCount));
+
+        std::vector<VertexId> stillMoved;
+        for (const VertexId vertexId : movedVertices) {
+            if (newVertexIds[vertexId] != NO_VALUE) {
+                stillMoved.push_back(newVertexIds[vertexId]);
             }
         }
+        movedVertices = std::move(stillMoved);
+        if (farthestVertex != NO_VALUE) {
+            farthestVertex = newVertexIds[farthestVertex];
+        }
+
+        freeVertices.clear();
+        freeFaces.clear();
+    }
+
+    computeFulledges();
+}
+
+FaceIndex TriangleMesh::allocateFace() {
+    if (!freeFaces.empty()) {
+        const FaceIndex face = freeFaces.back();
+        freeFaces.pop_back();
+        return face;
+    }
+
+    const FaceIndex face = faceVertices.size() / 3;
+    faceVertices.resize(faceVertices.size() + 3, NO_VALUE);
+    otherHalf.resize(otherHalf.size() + 3, NO_VALUE);
+    if (faceNormals.size() == face) {
+        faceNormals.emplace_back(0.0f, 0.0f, 0.0f);
     }
+    return face;
+}
 
-    // Compute new vertices spatial values (xyz)
-    for (VertexId edgeVertexId : fulledgeToEdgeVertex) {
-        const auto [halfEdge, otherHalf] = edgeVertexToHalves[edgeVertexId];
+VertexId TriangleMesh::allocateVertex(const Cartesian3& position) {
+    vertexSum[0] += position.x;
+    vertexSum[1] += position.y;
+    vertexSum[2] += position.z;
 
-        const auto [v2, v1] = vertexIndicesOf(halfEdge);
-        const VertexId v3 = faceVertices[nextIdInFace(halfEdge)];
-        const VertexId v4 = faceVertices[nextIdInFace(otherHalf)];
+    if (!freeVertices.empty()) {
+        const VertexId vertexId = freeVertices.back();
+        freeVertices.pop_back();
+        vertices[vertexId] = position;
+        return vertexId;
+    }
 
-        Cartesian3 edgeVertex = NEAR_NEIGHBOUR_WEIGHT * (vertices[v1] + vertices[v2]) +
-                                FAR_NEIGHBOUR_WEIGHT * (vertices[v3] + vertices[v4]);
+    const VertexId vertexId = vertices.size();
+    vertices.push_back(position);
+    firstDirectedEdge.push_back(NO_VALUE);
+    if (normals.size() == vertexId) {
+        normals.emplace_back(0.0f, 0.0f, 0.0f);
+    }
+    return vertexId;
+}
 
-        // Push new vertices at the end
-        subdivision.vertices.push_back(edgeVertex);
+void TriangleMesh::freeFace(const FaceIndex face) {
+    for (unsigned int slot = 0; slot < 3; slot++) {
+        faceVertices[3 * face + slot] = NO_VALUE;
+        otherHalf[3 * face + slot] = NO_VALUE;
     }
+    freeFaces.push_back(face);
+}
+
+void TriangleMesh::freeVertex(const VertexId vertexId) {
+    vertexSum[0] -= vertices[vertexId].x;
+    vertexSum[1] -= vertices[vertexId].y;
+    vertexSum[2] -= vertices[vertexId].z;
 
-    // Compute old vertices in spatial values (xyz)
-    for (VertexId oldVertexId = 0; oldVertexId < vertices.size(); oldVertexId++) {
-        // Reference this to make explicit that centroid calculation uses old neighbourhoods
-        subdivision.vertices[oldVertexId] = this->centroidLerp(oldVertexId);
+    firstDirectedEdge[vertexId] = NO_VALUE;
+    freeVertices.push_back(vertexId);
+    if (vertexId == farthestVertex) {
+        farthestVertex = NO_VALUE;
     }
+}
+
+unsigned int TriangleMesh::idToIndex(const EdgeId edgeId) {
+    return 3 * (edgeId / 3) + (3 + edgeId - 1) % 3;
+}
+
+EdgeId TriangleMesh::nextIdInFace(const EdgeId edgeId) {
+    return 3 * (edgeId / 3) + (edgeId + 1) % 3;
+}
+
+std::pair<VertexId, VertexId> TriangleMesh::vertexIndicesOf(const EdgeId edgeId) const {
+    const unsigned int fromIndex = idToIndex(edgeId);
+    const unsigned int toIndex = idToIndex(nextIdInFace(edgeId));
 
-    subdivision.computeCentreOfGravity();
-    subdivision.computeNormals();
-    return subdivision;
+    return {faceVertices[fromIndex], faceVertices[toIndex]};
+}
+
+bool halfEdgesInRange(const HalfedgeView& view, const EdgeId begin, const EdgeId end) {
+    for (EdgeId edgeId = begin; edgeId < end; edgeId++) {
+        const EdgeId otherEdge = view.otherHalf[edgeId];
+        if (view.faceVertices[edgeId] >= view.vertexCount || otherEdge >= view.halfEdgeCount || otherEdge == edgeId ||
+            view.otherHalf[otherEdge] != edgeId) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool verticesInRange(const HalfedgeView& view, const VertexId begin, const VertexId end) {
+    for (VertexId vertexId = begin; vertexId < end; vertexId++) {
+        const EdgeId firstEdge = view.firstDirectedEdge[vertexId];
+        if (firstEdge >= view.halfEdgeCount || view.faceVertices[TriangleMesh::idToIndex(firstEdge)] != vertexId) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HalfedgeView TriangleMesh::view() const {
+    return {
+        vertices.data(),
+        faceVertices.data(),
+        otherHalf.data(),
+        firstDirectedEdge.data(),
+        static_cast<unsigned int>(vertices.size()),
+        static_cast<unsigned int>(faceVertices.size())
+    };
+}
+
+size_t TriangleMesh::memoryFootprint() const {
+    return vertices.capacity() * sizeof(Cartesian3) +
+           normals.capacity() * sizeof(Cartesian3) +
+           faceNormals.capacity() * sizeof(Cartesian3) +
+           faceVertices.capacity() * sizeof(VertexId) +
+           firstDirectedEdge.capacity() * sizeof(EdgeId) +
+           otherHalf.capacity() * sizeof(EdgeId) +
+           fulledges.capacity() * sizeof(unsigned int) +
+           fulledgeHalfEdges.capacity() * sizeof(EdgeId);
+}
+
+/**
+ * Returns a levels-deep Loop Subdivision of the TriangleMesh.
+ * Assumes that the surface is 2-manifold and the edges are in the format edge[to].
+ * Runs in linear time, see LoopSubdivision.h for the layout of the result.
+ */
+TriangleMesh TriangleMesh::subdivide(const unsigned int levels) const {
+    if (levels == 0) {
+        return *this;
+    }
+
+    auto subdivisions = subdivideLevels(levels, [levels](const unsigned int level) {
+        return level == levels;
+    });
+
+    return std::move(subdivisions.at(levels));
 }
 
 /**
- * @param vertexId of the vertex
+ * @brief Pipelines several levels of Loop Subdivision
+ *
+ * Connectivity of level k + 1 only depends on the connectivity of level k, so a topology task
+ * runs ahead computing faceVertices, otherHalf & firstDirectedEdge of each level, while the calling
+ * thread computes the vertices of the level it has the connectivity for. Levels that are not
+ * materialised skip normals & centre of gravity, and are freed as soon as the next level is done.
  *
- * @return the (x, y, z) resulting of lerping b
+ * @param levels amount of subdivision levels
+ * @param materialise whether a level, in [1, levels], is to be returned
+ *
+ * @return the materialised levels, keyed by level
  */
-Cartesian3 TriangleMesh::centroidLerp(const VertexId vertexId) const {
-    Cartesian3 neighbourhoudSum;
-    unsigned int n = 0;
+std::map<unsigned int, TriangleMesh> TriangleMesh::subdivideLevels(
+    const unsigned int levels,
+    const std::function<bool(unsigned int)>& materialise) const {
+    // subdivisions[k] is level k, subdivisions[0] stays empty as level 0 is this mesh
+    std::vector<TriangleMesh> subdivisions(levels + 1);
+    const auto levelMesh = [&](const unsigned int level) -> const TriangleMesh& {
+        return level == 0 ? *this : subdivisions[level];
+    };
+
+    // levelFulledges[k] numbers the fulledges of level k, needed by the connectivity & vertices of level k + 1.
+    // This mesh carries its own numbering, which later levels take over once they are done with it
+    std::vector<std::vector<unsigned int>> levelFulledges(levels);
+    const bool numbered = fulledges.size() == faceVertices.size();
+    const auto parentFulledges = [&](const unsigned int level) -> const unsigned int* {
+        return level == 1 && numbered ? fulledges.data() : levelFulledges[level - 1].data();
+    };
+    std::vector<std::promise<void>> fulledgesReady(levels);
+    std::vector<std::promise<void>> topologyReady(levels + 1);
+    std::vector<std::future<void>> fulledgesFutures;
+    std::vector<std::future<void>> topologyFutures;
+    for (unsigned int level = 0; level <= levels; level++) {
+        if (level < levels) {
+            fulledgesFutures.push_back(fulledgesReady[level].get_future());
+        }
+        topologyFutures.push_back(topologyReady[level].get_future());
+    }
 
-    visitNeighbourhoodOf(vertexId, [&](EdgeId, VertexId, const VertexId neighbour) {
-        neighbourhoudSum = neighbourhoudSum + vertices[neighbour];
-        n++;
+    auto topology = std::async(std::launch::async, [&]() {
+        unsigned int level = 1;
+        try {
+            for (; level <= levels; level++) {
+                const TriangleMesh& parent = levelMesh(level - 1);
+                TriangleMesh& child = subdivisions[level];
+
+                // vertices are being written by the calling thread, so the view omits them
+                const HalfedgeView parentTopology{
+                    nullptr,
+                    parent.faceVertices.data(),
+                    parent.otherHalf.data(),
+                    parent.firstDirectedEdge.data(),
+                    static_cast<unsigned int>(parent.firstDirectedEdge.size()),
+                    static_cast<unsigned int>(parent.faceVertices.size())
+                };
+                const unsigned int halfEdgeCount = parent.faceVertices.size();
+
+                unsigned int fulledgeCount = fulledgeHalfEdges.size();
+                if (level > 1 || !numbered) {
+                    levelFulledges[level - 1].assign(halfEdgeCount, NO_VALUE);
+                    fulledgeCount = numberFulledges(parentTopology, 0, halfEdgeCount, 0,
+                                                    levelFulledges[level - 1].data());
+                }
+                fulledgesReady[level - 1].set_value();
+
+                child.faceVertices.resize(4 * halfEdgeCount);
+                child.otherHalf.resize(4 * halfEdgeCount, NO_VALUE);
+                child.firstDirectedEdge.resize(parentTopology.vertexCount + fulledgeCount, NO_VALUE);
+
+                subdivideFaces(parentTopology, parentFulledges(level), 0, halfEdgeCount / 3,
+                               child.faceVertices.data(), child.otherHalf.data());
+                subdivideEdges(parentTopology, parentFulledges(level), 0, halfEdgeCount,
+                               child.firstDirectedEdge.data(), nullptr);
+                subdivideVertices(parentTopology, 0, parentTopology.vertexCount,
+                                  child.firstDirectedEdge.data(), nullptr);
+                topologyReady[level].set_value();
+            }
+        } catch (...) {
+            // unblock the calling thread, which rethrows
+            for (; level <= levels; level++) {
+                for (std::promise<void>* ready : {&fulledgesReady[level - 1], &topologyReady[level]}) {
+                    try {
+                        ready->set_exception(std::current_exception());
+                    } catch (const std::future_error&) {
+                        // already satisfied
+                    }
+                }
+            }
+        }
     });
 
-    float alpha;
+    std::map<unsigned int, TriangleMesh> materialised;
+
+    for (unsigned int level = 1; level <= levels; level++) {
+        const TriangleMesh& parent = levelMesh(level - 1);
+        TriangleMesh& child = subdivisions[level];
+
+        fulledgesFutures[level - 1].get();
+        const HalfedgeView parentView = parent.view();
+
+        child.vertices.resize(parent.vertices.size() + parent.faceVertices.size() / 2);
+        subdivideEdges(parentView, parentFulledges(level), 0, parent.faceVertices.size(), nullptr, child.vertices.data());
+        subdivideVertices(parentView, 0, parent.vertices.size(), nullptr, child.vertices.data());
+
+        // the topology task has moved on to level + 1, level - 1 is no longer needed by anyone
+        topologyFutures[level].get();
+        if (level > 1 && materialise(level - 1)) {
+            subdivisions[level - 1].fulledges = std::move(levelFulledges[level - 1]);
+            subdivisions[level - 1].computeFulledgeHalfEdges();
+        } else if (level > 1) {
+            subdivisions[level - 1] = TriangleMesh();
+        }
+        std::vector<unsigned int>().swap(levelFulledges[level - 1]);
+
+        if (materialise(level)) {
+            child.computeCentreOfGravity();
+            child.computeNormals();
+        }
 
-    if (n == 3) {
-        alpha = N_3_ALPHA;
-    } else {
-        alpha = (0.625f - std::pow(0.375f + 0.25f * std::cos(2.0f * M_PI / n), 2.0f)) / n;
+        // no later level numbers the fulledges of the deepest one
+        if (level == levels && materialise(level)) {
+            child.computeFulledges();
+        }
     }
 
-    return (1.0f - n * alpha) * vertices[vertexId] + alpha * neighbourhoudSum;
+    topology.get();
+
+    for (unsigned int level = 1; level <= levels; level++) {
+        if (materialise(level)) {
+            materialised.emplace(level, std::move(subdivisions[level]));
+        }
+    }
+
+    return materialised;
 }
 
 /** @brief visits the 1-ring neighbourhood of a vertexId, starting from FDE[vertexId]
@@ -514,3 +1469,23 @@ void TriangleMesh::writeToObjFile(std::ostream& objStream) const {
                 << std::endl;
     }
 }
+
+bool TriangleMesh::writeToBinaryFile(std::ostream& binaryStream) const {
+    // the header only counts vertices, readers take a normal per vertex
+    if (normals.size() != vertices.size()) {
+        std::cerr << "Cannot write " << normals.size() << " normals for " << vertices.size()
+                << " vertices, compute the normals first" << std::endl;
+        return false;
+    }
+
+    const BinaryMeshHeader header(vertices.size(), faceVertices.size());
+
+    binaryStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    binaryStream.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Cartesian3));
+    binaryStream.write(reinterpret_cast<const char*>(normals.data()), normals.size() * sizeof(Cartesian3));
+    binaryStream.write(reinterpret_cast<const char*>(faceVertices.data()), faceVertices.size() * sizeof(VertexId));
+    binaryStream.write(reinterpret_cast<const char*>(otherHalf.data()), otherHalf.size() * sizeof(EdgeId));
+    binaryStream.write(reinterpret_cast<const char*>(firstDirectedEdge.data()),
+                       firstDirectedEdge.size() * sizeof(EdgeId));
+    return true;
+}
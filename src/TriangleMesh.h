@@ -1,10 +1,14 @@
 #ifndef TRIANGLE_MESH
 #define TRIANGLE_MESH
 
+#include <array>
 #include <functional>
 #include <vector>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <optional>
+#include <string>
 
 #include "Cartesian3.h"
 
@@ -12,6 +16,67 @@ typedef unsigned int VertexId;
 typedef unsigned int EdgeId;
 typedef unsigned int FaceIndex;
 
+// marks unassigned entries of otherHalf & firstDirectedEdge
+constexpr unsigned int NO_VALUE = std::numeric_limits<unsigned int>::max();
+
+// how the faces around a vertex contribute to its normal
+enum class NormalWeighting {
+    // by face area, favouring large faces
+    AREA,
+    // by the angle of the face at the vertex, independent of how the faces around it are split
+    ANGLE,
+    // every face alike
+    UNIFORM
+};
+
+// a problem of the half-edge arrays found by TriangleMesh::validate
+struct MeshDefect {
+    enum Kind {
+        // an array has the wrong size, or holds an index past the end of the array it indexes
+        OUT_OF_RANGE_INDEX,
+        // a face repeating a vertex, or with no area
+        DEGENERATE_FACE,
+        // a half-edge with none running the other way, i.e. on a boundary
+        UNPAIRED_EDGE,
+        // more than 2 half-edges between the same 2 vertices
+        NON_MANIFOLD_EDGE,
+        // 2 half-edges between the same 2 vertices running the same way, as their faces wind oppositely
+        INCONSISTENT_WINDING,
+        // otherHalf disagrees with the half-edges faceVertices describe
+        MISMATCHED_OTHER_HALF,
+        // a vertex whose first directed edge leaves another vertex
+        MISPLACED_FIRST_EDGE,
+        // a vertex whose 1-ring walk does not come back to its first directed edge through all of its half-edges
+        NON_MANIFOLD_VERTEX
+    };
+
+    Kind kind;
+    // the face of DEGENERATE_FACE, the vertex of MISPLACED_FIRST_EDGE & NON_MANIFOLD_VERTEX,
+    // the entry of OUT_OF_RANGE_INDEX, a half-edge otherwise
+    unsigned int element;
+    std::string description;
+};
+
+/**
+ * Non-owning view over the arrays of a half-edge structure, so that the same
+ * kernels run over TriangleMesh vectors and memory-mapped files alike.
+ */
+struct HalfedgeView {
+    const Cartesian3* vertices;
+    const VertexId* faceVertices;
+    const EdgeId* otherHalf;
+    const EdgeId* firstDirectedEdge;
+    unsigned int vertexCount;
+    unsigned int halfEdgeCount;
+};
+
+// whether the half-edges [begin, end) of view index vertices & half-edges that exist, otherHalf pairing every one
+// of them both ways, so that 1-ring walks come back around. Files are checked block by block with it before use
+bool halfEdgesInRange(const HalfedgeView& view, EdgeId begin, EdgeId end);
+
+// whether the first directed edge of each vertex [begin, end) of view exists & leaves it
+bool verticesInRange(const HalfedgeView& view, VertexId begin, VertexId end);
+
 /**
  * Describes a mesh with triangular faces. The half-edge data structure
  * serves as backing mechanism.
@@ -23,9 +88,15 @@ class TriangleMesh {
 public:
     std::vector<Cartesian3> vertices;
     std::vector<Cartesian3> normals;
+    // unit normal of every face, for flat shading
+    std::vector<Cartesian3> faceNormals;
     std::vector<VertexId> faceVertices;
     std::vector<EdgeId> firstDirectedEdge;
     std::vector<EdgeId> otherHalf;
+    // fulledge of every half-edge, numbered in the order of the lower half-edge of each pair
+    std::vector<unsigned int> fulledges;
+    // lower half-edge of every fulledge, the higher one being its otherHalf
+    std::vector<EdgeId> fulledgeHalfEdges;
 
     Cartesian3 centreOfGravity;
 
@@ -34,23 +105,88 @@ public:
 
     TriangleMesh();
 
-    // create 1-level subdivision
-    TriangleMesh subdivide() const;
+    // create levels-deep subdivision, only the deepest level is materialised
+    TriangleMesh subdivide(unsigned int levels = 1) const;
+
+    // create levels [1, levels] of subdivision, keyed by level, keeping only those for which
+    // materialise(level) holds. Topology of deeper levels is computed ahead of geometry
+    std::map<unsigned int, TriangleMesh> subdivideLevels(unsigned int levels,
+                                                         const std::function<bool(unsigned int)>& materialise) const;
 
     bool readHalfedgeFile(std::istream& halfedgeFile);
 
     bool readTriFile(std::istream& triFile);
 
+    bool readBinaryFile(std::istream& binaryFile);
+
     void writeToHalfedgeFile(std::ostream& halfedgeStream) const;
 
     void writeToObjFile(std::ostream& objStream) const;
 
-private:
+    // false, writing nothing, unless there is a normal per vertex
+    bool writeToBinaryFile(std::ostream& binaryStream) const;
+
+    HalfedgeView view() const;
+
+    // bytes held by the arrays of the mesh
+    size_t memoryFootprint() const;
+
     void computeCentreOfGravity();
 
-    void computeNormals();
+    // computes faceNormals as well. Every vertex gathers from its own 1-ring, in parallel,
+    // so the result does not depend on the thread count
+    void computeNormals(NormalWeighting weighting = NormalWeighting::AREA);
+
+    void computeFaceNormals();
+
+    // sets the position of vertexId, leaving the normals around it, centreOfGravity & objectSize out of date
+    // until updateMovedVertices. Renderers & hierarchies built over the mesh need invalidating or refitting
+    void moveVertex(VertexId vertexId, const Cartesian3& position);
+
+    // brings the normals around the vertices moved since the last call & centreOfGravity up to date,
+    // in time proportional to the moved vertices & their 1-rings. objectSize is kept an upper bound,
+    // recomputed in full, as by computeCentreOfGravity, once it may be off by more than a fixed factor
+    void updateMovedVertices();
+
+    // numbers the fulledges from otherHalf, in linear time
+    void computeFulledges();
+
+    // Local edits, in time proportional to the valence of the vertices involved. Freed faces & vertices
+    // are reused by later edits and dropped by compact, whole-mesh passes must wait until then.
+    // Vertices whose 1-ring changed count as moved, see updateMovedVertices. fulledges wait for compact
 
-    std::optional<EdgeId> findHalfEdgeFor(VertexId from, VertexId to) const;
+    // whether flipEdge keeps the mesh a 2-manifold: edgeId has 2 faces, the vertices opposite it
+    // are not joined yet & its ends keep 3 edges at least
+    bool canFlipEdge(EdgeId edgeId) const;
+
+    // replaces edgeId & its otherHalf by the edge joining the vertices opposite it, in the same 2 faces
+    void flipEdge(EdgeId edgeId);
+
+    // inserts a vertex at position along edgeId, splitting the faces on either side in 2, returns the vertex.
+    // edgeId keeps running from its tail, to the new vertex
+    VertexId splitEdge(EdgeId edgeId, const Cartesian3& position);
+
+    // whether collapseEdge keeps the mesh a 2-manifold: the ends of edgeId are off any boundary, only share
+    // the 2 neighbours opposite edgeId (the link condition) & these keep 3 edges at least
+    bool canCollapseEdge(EdgeId edgeId) const;
+
+    // merges the head of edgeId into its tail, moved to position, freeing the head & both faces of edgeId.
+    // Across each freed face, the other halves of its 2 edges besides edgeId become each other's otherHalf
+    void collapseEdge(EdgeId edgeId, const Cartesian3& position);
+
+    // renumbers the vertices & faces left by the edits in their previous order & recomputes fulledges
+    void compact();
+
+    // every problem of the half-edge arrays, in time linear in the half-edges for meshes of bounded valence.
+    // Empty for a closed, consistently wound 2-manifold
+    std::vector<MeshDefect> validate() const;
+
+    // whether defects are only of vertices pinching fans of faces together, e.g. 2 cones tip to tip. Every edge
+    // pairs up, so the mesh is still read, though 1-ring walks of those vertices only go around one fan
+    static bool onlyPinchedVertices(const std::vector<MeshDefect>& defects);
+
+    // a line per defect, up to a few of each kind, then how many of each kind were left out
+    static void printDefects(const std::vector<MeshDefect>& defects, std::ostream& stream);
 
     // Transforms edgeId to the index for the edge [x -> edge[to]]
     static unsigned int idToIndex(EdgeId edgeId);
@@ -58,29 +194,40 @@ private:
     // Computes the next halfEdge id within the face of edgeId
     static EdgeId nextIdInFace(EdgeId edgeId);
 
+private:
+    // weighting of the last computeNormals, kept by the normals updated around moved vertices
+    NormalWeighting normalWeighting;
+    // of every vertex, in double so that moved vertices can be taken out & put back without drifting
+    std::array<double, 3> vertexSum;
+    // since the last updateMovedVertices, possibly more than once each
+    std::vector<VertexId> movedVertices;
+    // farthest from the centre as of the last full pass, whose distance now bounds objectSize from below
+    VertexId farthestVertex;
+    // freed by edits since the last compact
+    std::vector<FaceIndex> freeFaces;
+    std::vector<VertexId> freeVertices;
+
+    // cross product of the edges of face leaving its first vertex, twice its area in length
+    Cartesian3 faceCross(FaceIndex face) const;
+
+    // a free face, or a new one at the end of the arrays
+    FaceIndex allocateFace();
+
+    // a free vertex, or a new one at the end of the arrays, at position
+    VertexId allocateVertex(const Cartesian3& position);
+
+    void freeFace(FaceIndex face);
+
+    void freeVertex(VertexId vertexId);
+
+    // fills fulledgeHalfEdges from fulledges
+    void computeFulledgeHalfEdges();
+
     // Returns <edge[from], edge[to]>
     std::pair<VertexId, VertexId> vertexIndicesOf(EdgeId edgeId) const;
 
     void visitNeighbourhoodOf(VertexId vertexId,
                               const std::function<void(EdgeId, VertexId, VertexId)>& visitor) const;
-
-    Cartesian3 centroidLerp(VertexId vertexId) const;
-};
-
-class OtherHalfNotFound : public std::runtime_error {
-public:
-    OtherHalfNotFound(const EdgeId edgeId, const Cartesian3& from, const Cartesian3& to)
-        : std::runtime_error(
-            "OtherHalfNotFound:\n"
-            "\tFailed to find half-edge\n"
-            "\tedgeId = " + std::to_string(edgeId) + "\n"
-            "\tfrom = " + from.toString() + "\n"
-            "\tto = " + to.toString() + "\n"
-            "This happens when a mesh is malformed. A mesh can be malformed due, but not limited, to:\n"
-            "* The edge is disconnected -> Check whether the face of the reported edge is connected to another face in the .tri file\n"
-            "* Windedness of the faces is inconsistent -> Check whether the adjacent faces have consistent windedness .tri file\n"
-            "* Floating point precision issues -> Check whether from & to match values present in the .tri file") {
-    }
 };
 
 #endif
@@ -0,0 +1,210 @@
+#include "VertexMarkerRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QOpenGLContext>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include "SphereVertices.h"
+
+// meridians of each level of detail, with half as many bands
+constexpr std::array<unsigned int, 4> SPHERE_SEGMENTS = {6, 12, 24, 48};
+// largest gap in pixels allowed between a marker & a true sphere
+constexpr float MAXIMUM_MARKER_ERROR = 0.5f;
+
+constexpr int SPHERE_ATTRIBUTE = 0;
+constexpr int CENTRE_ATTRIBUTE = 1;
+
+// the fixed-function matrices & colour keep applying, markers are unlit like before
+constexpr auto MARKER_VERTEX_SHADER = R"(
+#version 150 compatibility
+in vec3 spherePosition;
+in vec3 centre;
+uniform float radius;
+
+void main() {
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(centre + radius * spherePosition, 1.0);
+    gl_FrontColor = gl_Color;
+}
+)";
+
+constexpr auto MARKER_FRAGMENT_SHADER = R"(
+#version 150 compatibility
+
+void main() {
+    gl_FragColor = gl_Color;
+}
+)";
+
+VertexMarkerRenderer::VertexMarkerRenderer()
+    : sphereVertexBuffer(QOpenGLBuffer::VertexBuffer),
+      sphereIndexBuffer(QOpenGLBuffer::IndexBuffer),
+      levelsOfDetail(),
+      centreBuffers(),
+      instancingAvailable(false) {
+    static_assert(SPHERE_SEGMENTS.size() == LEVEL_OF_DETAIL_COUNT);
+}
+
+/**
+ * @brief Compiles the instancing shader & uploads every sphere level of detail
+ */
+void VertexMarkerRenderer::initialise() {
+    const QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (context == nullptr || context->isOpenGLES() || context->format().version() < qMakePair(3, 3)) {
+        return;
+    }
+
+    functions.initializeOpenGLFunctions();
+
+    program.addShaderFromSourceCode(QOpenGLShader::Vertex, MARKER_VERTEX_SHADER);
+    program.addShaderFromSourceCode(QOpenGLShader::Fragment, MARKER_FRAGMENT_SHADER);
+    program.bindAttributeLocation("spherePosition", SPHERE_ATTRIBUTE);
+    program.bindAttributeLocation("centre", CENTRE_ATTRIBUTE);
+    if (!program.link() ||
+        !sphereVertexBuffer.create() || !sphereIndexBuffer.create()) {
+        return;
+    }
+    for (auto& [mesh, centreBuffer] : centreBuffers) {
+        if (!centreBuffer.create()) {
+            return;
+        }
+        centreBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    }
+
+    std::vector<Cartesian3> vertices;
+    std::vector<unsigned short> indices;
+    for (unsigned int level = 0; level < LEVEL_OF_DETAIL_COUNT; level++) {
+        std::vector<Cartesian3> levelVertices;
+        std::vector<unsigned short> levelIndices;
+        triangulateSphere(SPHERE_SEGMENTS[level], SPHERE_SEGMENTS[level] / 2, levelVertices, levelIndices);
+
+        levelsOfDetail[level] = {SPHERE_SEGMENTS[level], static_cast<unsigned int>(indices.size()),
+                                 static_cast<unsigned int>(levelIndices.size())};
+
+        // indices are absolute, as instanced draws take no base vertex
+        for (const unsigned short index : levelIndices) {
+            indices.push_back(vertices.size() + index);
+        }
+        vertices.insert(vertices.end(), levelVertices.begin(), levelVertices.end());
+    }
+
+    sphereVertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    sphereVertexBuffer.bind();
+    sphereVertexBuffer.allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof(Cartesian3)));
+    sphereVertexBuffer.release();
+
+    sphereIndexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    sphereIndexBuffer.bind();
+    sphereIndexBuffer.allocate(indices.data(), static_cast<int>(indices.size() * sizeof(unsigned short)));
+    sphereIndexBuffer.release();
+
+    instancingAvailable = true;
+}
+
+void VertexMarkerRenderer::invalidate() {
+    for (auto& [mesh, centreBuffer] : centreBuffers) {
+        mesh = nullptr;
+    }
+}
+
+void VertexMarkerRenderer::render(const TriangleMesh& mesh, const float radius, const float pixelRadius) {
+    if (!instancingAvailable) {
+        renderImmediate(mesh, radius);
+        return;
+    }
+
+    QOpenGLBuffer& centreBuffer = centreBufferFor(mesh);
+    const SphereLevelOfDetail& levelOfDetail = levelOfDetailFor(pixelRadius);
+
+    program.bind();
+    program.setUniformValue("radius", radius);
+
+    sphereVertexBuffer.bind();
+    program.enableAttributeArray(SPHERE_ATTRIBUTE);
+    program.setAttributeBuffer(SPHERE_ATTRIBUTE, GL_FLOAT, 0, 3);
+
+    centreBuffer.bind();
+    program.enableAttributeArray(CENTRE_ATTRIBUTE);
+    program.setAttributeBuffer(CENTRE_ATTRIBUTE, GL_FLOAT, 0, 3);
+    functions.glVertexAttribDivisor(CENTRE_ATTRIBUTE, 1);
+
+    sphereIndexBuffer.bind();
+    functions.glDrawElementsInstanced(
+        GL_TRIANGLES,
+        static_cast<GLsizei>(levelOfDetail.indexCount),
+        GL_UNSIGNED_SHORT,
+        reinterpret_cast<const void*>(levelOfDetail.firstIndex * sizeof(unsigned short)),
+        static_cast<GLsizei>(mesh.vertices.size())
+    );
+    sphereIndexBuffer.release();
+
+    functions.glVertexAttribDivisor(CENTRE_ATTRIBUTE, 0);
+    program.disableAttributeArray(CENTRE_ATTRIBUTE);
+    program.disableAttributeArray(SPHERE_ATTRIBUTE);
+    centreBuffer.release();
+    program.release();
+}
+
+void VertexMarkerRenderer::destroy() {
+    sphereVertexBuffer.destroy();
+    sphereIndexBuffer.destroy();
+    for (auto& [mesh, centreBuffer] : centreBuffers) {
+        centreBuffer.destroy();
+    }
+    program.removeAllShaders();
+    invalidate();
+    instancingAvailable = false;
+}
+
+bool VertexMarkerRenderer::isInstanced() const {
+    return instancingAvailable;
+}
+
+/**
+ * @brief Coarsest sphere whose chords stay within MAXIMUM_MARKER_ERROR pixels of the true sphere
+ */
+const VertexMarkerRenderer::SphereLevelOfDetail& VertexMarkerRenderer::levelOfDetailFor(const float pixelRadius) const {
+    for (const auto& levelOfDetail : levelsOfDetail) {
+        if (pixelRadius * (1.0f - std::cos(M_PI / levelOfDetail.segments)) <= MAXIMUM_MARKER_ERROR) {
+            return levelOfDetail;
+        }
+    }
+    return levelsOfDetail.back();
+}
+
+QOpenGLBuffer& VertexMarkerRenderer::centreBufferFor(const TriangleMesh& mesh) {
+    auto cached = std::find_if(centreBuffers.begin(), centreBuffers.end(), [&mesh](const auto& centreBuffer) {
+        return centreBuffer.first == &mesh;
+    });
+
+    if (cached == centreBuffers.end()) {
+        // reuse the buffer of the least recently drawn mesh
+        cached = std::prev(centreBuffers.end());
+        cached->first = &mesh;
+        cached->second.bind();
+        cached->second.allocate(mesh.vertices.data(), static_cast<int>(mesh.vertices.size() * sizeof(Cartesian3)));
+        cached->second.release();
+    }
+
+    std::rotate(centreBuffers.begin(), cached, std::next(cached));
+    return centreBuffers.front().second;
+}
+
+void VertexMarkerRenderer::renderImmediate(const TriangleMesh& mesh, const float radius) {
+    // loop through the vertices
+    for (const auto& vertex : mesh.vertices) {
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glTranslatef(vertex.x, vertex.y, vertex.z);
+        glScalef(radius, radius, radius);
+        renderTriangulatedSphere();
+        glPopMatrix();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef VERTEX_MARKER_RENDERER_H
+#define VERTEX_MARKER_RENDERER_H
+
+#include <array>
+#include <utility>
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+
+#include "TriangleMesh.h"
+
+/**
+ * Draws a sphere around every vertex of a TriangleMesh with one instanced draw call.
+ *
+ * A handful of sphere tessellations are cached, the coarsest one that still looks round
+ * at the on-screen size of the markers is drawn. The vertices of the mesh are uploaded once per mesh
+ * and serve as per-instance centres. Without GL 3.3 instancing, markers fall back to one
+ * immediate-mode sphere per vertex.
+ *
+ * Every call must be made with the GL context current.
+ */
+class VertexMarkerRenderer {
+    static constexpr unsigned int LEVEL_OF_DETAIL_COUNT = 4;
+
+    struct SphereLevelOfDetail {
+        unsigned int segments;
+        // range of sphereIndexBuffer
+        unsigned int firstIndex;
+        unsigned int indexCount;
+    };
+
+    QOpenGLExtraFunctions functions;
+    QOpenGLShaderProgram program;
+
+    // every level of detail, one after the other
+    QOpenGLBuffer sphereVertexBuffer;
+    QOpenGLBuffer sphereIndexBuffer;
+    std::array<SphereLevelOfDetail, LEVEL_OF_DETAIL_COUNT> levelsOfDetail;
+
+    // centres of the last meshes drawn, most recent first, as in MeshRenderer
+    static constexpr unsigned int CACHED_MESH_COUNT = 2;
+    std::array<std::pair<const TriangleMesh*, QOpenGLBuffer>, CACHED_MESH_COUNT> centreBuffers;
+
+    bool instancingAvailable;
+
+public:
+    VertexMarkerRenderer();
+
+    VertexMarkerRenderer(const VertexMarkerRenderer&) = delete;
+
+    VertexMarkerRenderer& operator=(const VertexMarkerRenderer&) = delete;
+
+    void initialise();
+
+    // to be called when the mesh held by the buffers was edited in place
+    void invalidate();
+
+    // radius in the current modelview coordinates, pixelRadius its size on screen
+    void render(const TriangleMesh& mesh, float radius, float pixelRadius);
+
+    void destroy();
+
+    bool isInstanced() const;
+
+private:
+    const SphereLevelOfDetail& levelOfDetailFor(float pixelRadius) const;
+
+    // uploads the vertices of mesh unless cached
+    QOpenGLBuffer& centreBufferFor(const TriangleMesh& mesh);
+
+    static void renderImmediate(const TriangleMesh& mesh, float radius);
+};
+
+#endif
@@ -1,56 +1,87 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
-#include <filesystem>
 
+#include "FrameRecorder.h"
+#include "HeadlessPipeline.h"
+#include "MeshFile.h"
 #include "RenderWindow.h"
 #include "TriangleMesh.h"
 #include "RenderParameters.h"
 #include "RenderController.h"
 
-bool isHalfedgeFile(const std::string& rawMeshPath);
+void printUsage(const std::string& program) {
+    std::cout << "Usage: " << program << " <mesh file> [options...]\n"
+            << "Options:\n"
+            << "  --subdivisions <levels>                 Start at the given subdivision level\n"
+            << "  --render-path <retained|immediate>      Draw from buffer objects (default) or in immediate mode\n"
+            << "  --record-frames <.csv>                  Time a scripted rotation, write it to CSV & quit\n"
+            << std::flush;
+}
 
-bool isTriFile(const std::string& rawMeshPath);
+int main(int argc, char** argv) {
+    // Headless mode opens no window
+    if (argc >= 2 && std::string(argv[1]) == "--headless") {
+        if (argc < 3) {
+            HeadlessPipeline::printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
 
-std::string extractMeshName(const std::string& rawMeshPath);
+        HeadlessPipeline pipeline(argv[2]);
+        return pipeline.run(std::vector<std::string>(argv + 3, argv + argc));
+    }
 
-int main(int argc, char** argv) {
     QApplication application(argc, argv);
 
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <mesh file>" << std::endl;
+    if (argc < 2) {
+        printUsage(argv[0]);
+        HeadlessPipeline::printUsage(argv[0]);
         return 0;
     }
 
-    TriangleMesh mesh;
+    RenderParameters renderParameters;
+    std::string recordingPath;
 
-    std::ifstream meshFile(argv[1]);
+    for (int i = 2; i < argc; i++) {
+        const std::string option = argv[i];
+        const bool hasValue = i + 1 < argc;
 
-    // File is assumed to be .halfedge or .tri
-    if (!meshFile.good() ||
-        (isHalfedgeFile(argv[1]) && !mesh.readHalfedgeFile(meshFile)) ||
-        (isTriFile(argv[1]) && !mesh.readTriFile(meshFile))) {
+        if (option == "--subdivisions" && hasValue) {
+            renderParameters.subdivisionNumber =
+                std::min<unsigned int>(std::strtoul(argv[++i], nullptr, 10), MAXIMUM_SUBDIVISION_NUMBER);
+        } else if (option == "--render-path" && hasValue && std::string(argv[i + 1]) == "immediate") {
+            renderParameters.forceImmediateMode = true;
+            i++;
+        } else if (option == "--render-path" && hasValue && std::string(argv[i + 1]) == "retained") {
+            i++;
+        } else if (option == "--record-frames" && hasValue) {
+            recordingPath = argv[++i];
+        } else {
+            std::cout << "Unknown option: " << option << std::endl;
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    TriangleMesh mesh;
+
+    // File is assumed to be .halfedge, .tri, .hebin or .hec
+    if (!readMeshFile(argv[1], mesh)) {
         std::cout << "Read failed for object " << argv[1] << std::endl;
         return 0;
     }
 
-    RenderParameters renderParameters;
-
     RenderWindow renderWindow(&mesh, &renderParameters, argv[1]);
     RenderController renderController(&renderParameters, &renderWindow, extractMeshName(argv[1]));
+
+    // after the controller, which copies the rotation of the arcball
+    FrameRecorder frameRecorder(&renderParameters, &renderWindow, recordingPath);
+    if (!recordingPath.empty() && !frameRecorder.start()) {
+        return EXIT_FAILURE;
+    }
+
     renderWindow.resize(1200, 675);
     renderWindow.show();
 
     return application.exec();
 }
-
-bool isHalfedgeFile(const std::string& rawMeshPath) {
-    return std::filesystem::path(rawMeshPath).extension() == ".halfedge";
-}
-
-bool isTriFile(const std::string& rawMeshPath) {
-    return std::filesystem::path(rawMeshPath).extension() == ".tri";
-}
-
-std::string extractMeshName(const std::string& rawMeshPath) {
-    return std::filesystem::path(rawMeshPath).stem();
-}